@@ -0,0 +1,195 @@
+#ifndef BANDSCHEDULER_H
+#define BANDSCHEDULER_H
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "BufferPool.h"
+#include "MatrixView.h"
+#include "MemoryHelper.h"
+#include "ThreadPool.h"
+
+// splits a neighbourhood operation in horizontal bands of rows, which are processed on the ThreadPool
+// every band gets its source rows including the halo rows above and below, so the bands are independent of each other
+// and the result does not depend on the number of threads
+class BandScheduler
+{
+public:
+  // kernel(sourceBand, destinationBand) has to write only the rows offsetTop ... height - offsetBottom - 1 of destinationBand
+  // source and destination must have the same size and must not overlap
+  // qtyThreads = 0 -> all threads of ThreadPool::getInstance(), qtyThreads = 1 -> kernel is called once with the full views
+  template<typename T, typename Kernel>
+  static void run(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int offsetTop, unsigned int offsetBottom, unsigned int qtyThreads, const Kernel& kernel);
+
+  // same as run, but the view is processed in place without a copy of the whole view
+  // every band saves the halo rows which are written by its neighbours, then the kernel is called for chunks of rows
+  // which are copied into a rolling buffer -> the extra memory is a few rows per band instead of a copy of the view
+  template<typename T, typename Kernel>
+  static void runInPlace(const MatrixView<T>& view, unsigned int offsetTop, unsigned int offsetBottom, unsigned int qtyThreads, const Kernel& kernel);
+
+private:
+  static unsigned int getQtyBands(unsigned int qtyRows, unsigned int qtyThreads);
+  static unsigned int getFirstRowOfBand(unsigned int band, unsigned int qtyBands, unsigned int qtyRows, unsigned int offsetTop);
+
+  static const unsigned int MinimumBandHeight = 16;
+  static const unsigned int QtyBandsPerThread = 4; // more bands than threads balance the load
+  static const size_t MinimumChunkSize = 1 << 18; // bytes of the rolling buffer, big chunks keep the overhead per kernel call low
+  static const unsigned int QtyChunkRowsPerHaloRow = 4; // the halo rows of every chunk are processed twice, this limits the overhead to 25 %
+};
+
+inline unsigned int BandScheduler::getQtyBands(unsigned int qtyRows, unsigned int qtyThreads)
+{
+  ThreadPool& threadPool = ThreadPool::getInstance();
+
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int qtyBands = qtyRows / MinimumBandHeight;
+
+  if (qtyBands > qtyThreads * QtyBandsPerThread)
+  {
+    qtyBands = qtyThreads * QtyBandsPerThread;
+  }
+
+  if (qtyThreads <= 1 || qtyBands < 1)
+  {
+    qtyBands = 1;
+  }
+
+  return qtyBands;
+}
+
+inline unsigned int BandScheduler::getFirstRowOfBand(unsigned int band, unsigned int qtyBands, unsigned int qtyRows, unsigned int offsetTop)
+{
+  return offsetTop + static_cast<unsigned int>(static_cast<unsigned long long>(qtyRows) * band / qtyBands);
+}
+
+template<typename T, typename Kernel>
+void BandScheduler::run(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int offsetTop, unsigned int offsetBottom, unsigned int qtyThreads, const Kernel& kernel)
+{
+  unsigned int height = source.getHeight();
+  unsigned int qtyRows = height > offsetTop + offsetBottom ? height - offsetTop - offsetBottom : 0;
+  unsigned int qtyBands = getQtyBands(qtyRows, qtyThreads);
+
+  if (qtyBands <= 1)
+  {
+    kernel(source, destination);
+    return;
+  }
+
+  unsigned int width = source.getWidth();
+
+  ThreadPool::getInstance().run(qtyBands, [&](unsigned int band)
+  {
+    unsigned int firstRow = getFirstRowOfBand(band, qtyBands, qtyRows, offsetTop);
+    unsigned int lastRow = getFirstRowOfBand(band + 1, qtyBands, qtyRows, offsetTop);
+    unsigned int bandHeight = lastRow - firstRow + offsetTop + offsetBottom;
+
+    kernel(source.getSubView(0, firstRow - offsetTop, width, bandHeight), destination.getSubView(0, firstRow - offsetTop, width, bandHeight));
+  }, qtyThreads);
+}
+
+template<typename T, typename Kernel>
+void BandScheduler::runInPlace(const MatrixView<T>& view, unsigned int offsetTop, unsigned int offsetBottom, unsigned int qtyThreads, const Kernel& kernel)
+{
+  unsigned int width = view.getWidth();
+  unsigned int height = view.getHeight();
+  unsigned int haloHeight = offsetTop + offsetBottom;
+
+  if (view.isEmpty() || height <= haloHeight)
+  {
+    return;
+  }
+
+  unsigned int qtyRows = height - haloHeight;
+  unsigned int qtyBands = getQtyBands(qtyRows, qtyThreads);
+  unsigned int stride = MemoryHelper::roundUp(width * sizeof(T), CacheLineSize) / sizeof(T);
+  size_t rowSize = width * sizeof(T);
+
+  // rows firstRow - offsetTop ... firstRow - 1 and lastRow ... lastRow + offsetBottom - 1 of every band
+  size_t haloSize = static_cast<size_t>(stride) * haloHeight;
+  std::unique_ptr<T, void(*)(void*)> halos(static_cast<T*>(BufferPool::allocate(haloSize * qtyBands * sizeof(T))), BufferPool::release);
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+
+  threadPool.run(qtyBands, [&](unsigned int band)
+  {
+    unsigned int firstRow = getFirstRowOfBand(band, qtyBands, qtyRows, offsetTop);
+    unsigned int lastRow = getFirstRowOfBand(band + 1, qtyBands, qtyRows, offsetTop);
+    T* halo = halos.get() + haloSize * band;
+
+    for (unsigned int i = 0; i < offsetTop; i++)
+    {
+      memcpy(halo + static_cast<size_t>(i) * stride, view.getRow(firstRow - offsetTop + i), rowSize);
+    }
+
+    for (unsigned int i = 0; i < offsetBottom; i++)
+    {
+      memcpy(halo + static_cast<size_t>(offsetTop + i) * stride, view.getRow(lastRow + i), rowSize);
+    }
+  }, qtyThreads);
+
+  // all halos are saved before the first band writes
+  threadPool.run(qtyBands, [&](unsigned int band)
+  {
+    unsigned int firstRow = getFirstRowOfBand(band, qtyBands, qtyRows, offsetTop);
+    unsigned int lastRow = getFirstRowOfBand(band + 1, qtyBands, qtyRows, offsetTop);
+    const T* halo = halos.get() + haloSize * band;
+
+    // at least one row, a row may be bigger than MinimumChunkSize and the halo may be empty
+    unsigned int chunkHeight = std::max(static_cast<unsigned int>(MinimumChunkSize / (stride * sizeof(T))), QtyChunkRowsPerHaloRow * haloHeight);
+    chunkHeight = std::max(chunkHeight, 1u);
+    chunkHeight = std::min(chunkHeight, lastRow - firstRow);
+
+    std::unique_ptr<T, void(*)(void*)> buffer(static_cast<T*>(BufferPool::allocate(static_cast<size_t>(stride) * (chunkHeight + haloHeight) * sizeof(T))), BufferPool::release);
+
+    // copies row y of the view as it was before the operation
+    auto loadRow = [&](unsigned int y, unsigned int bufferRow)
+    {
+      const T* row;
+      if (y < firstRow)
+      {
+        row = halo + static_cast<size_t>(y + offsetTop - firstRow) * stride;
+      }
+      else if (y >= lastRow)
+      {
+        row = halo + static_cast<size_t>(offsetTop + y - lastRow) * stride;
+      }
+      else
+      {
+        row = view.getRow(y);
+      }
+      memcpy(buffer.get() + static_cast<size_t>(bufferRow) * stride, row, rowSize);
+    };
+
+    unsigned int previousChunkHeight = 0;
+
+    for (unsigned int y = firstRow; y < lastRow; y += previousChunkHeight)
+    {
+      unsigned int currentChunkHeight = std::min(chunkHeight, lastRow - y);
+
+      // the buffer holds the rows y - offsetTop ... y + currentChunkHeight + offsetBottom - 1
+      // the first haloHeight rows are the last rows of the previous chunk, they may already be overwritten in the view
+      unsigned int firstNewRow = 0;
+      if (y > firstRow)
+      {
+        memmove(buffer.get(), buffer.get() + static_cast<size_t>(previousChunkHeight) * stride, haloSize * sizeof(T));
+        firstNewRow = haloHeight;
+      }
+
+      for (unsigned int i = firstNewRow; i < currentChunkHeight + haloHeight; i++)
+      {
+        loadRow(y - offsetTop + i, i);
+      }
+
+      kernel(MatrixView<const T>(buffer.get(), width, currentChunkHeight + haloHeight, stride), view.getSubView(0, y - offsetTop, width, currentChunkHeight + haloHeight));
+
+      previousChunkHeight = currentChunkHeight;
+    }
+  }, qtyThreads);
+}
+
+#endif // BANDSCHEDULER_H
@@ -0,0 +1,51 @@
+#-------------------------------------------------
+#
+# headless batch processing of image folders
+# run: Batch --pipeline pipeline.txt --input folder --output folder [--report report.csv]
+#
+#-------------------------------------------------
+
+# QImage decodes and encodes the images, no widgets and no display are needed
+QT       += core gui
+
+QT       -= widgets
+
+TARGET = Batch
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    Pipeline.cpp \
+    BatchRunner.cpp \
+    ../Point.cpp \
+    ../Rectangle.cpp \
+    ../Circle.cpp \
+    ../FreemanCode.cpp \
+    ../PolyLine.cpp \
+    ../FilterGenerator.cpp \
+    ../StructuringElementGenerator.cpp \
+    ../RunLengthCode.cpp \
+    ../Edge.cpp \
+    ../Line.cpp \
+    ../MathHelper.cpp \
+    ../Converter.cpp \
+    ../MemoryHelper.cpp \
+    ../Convolution.cpp \
+    ../ThreadPool.cpp \
+    ../PolarTransformation.cpp \
+    ../MappedFile.cpp \
+    ../MatrixFile.cpp \
+    ../ImageFile.cpp \
+    ../Region.cpp \
+    ../BinaryImage.cpp \
+    ../Labeling.cpp \
+    ../EdgeProbe.cpp \
+    ../Rotation.cpp \
+    ../BufferPool.cpp
+
+HEADERS += Pipeline.h \
+    BatchRunner.h
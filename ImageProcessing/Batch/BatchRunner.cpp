@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "BatchRunner.h"
+#include "ImageFile.h"
+#include "ThreadPool.h"
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  double toSeconds(const Clock::time_point& start, const Clock::time_point& end)
+  {
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  // an image on its way through the stages
+  class Item
+  {
+  public:
+    size_t m_jobIndex;
+    std::unique_ptr<Matrix<unsigned char> > m_image;
+  };
+
+  // queue between two stages: push() waits while the queue is full, pop() waits while it is empty
+  // the queue is closed as soon as all producers have finished -> pop() returns false, when the queue is empty
+  class Queue
+  {
+  public:
+    Queue(size_t capacity, unsigned int qtyProducers) :
+      m_capacity(std::max(capacity, static_cast<size_t>(1))),
+      m_qtyProducers(qtyProducers)
+    {
+    }
+
+    void push(Item& item, double& waitSeconds)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      if (m_items.size() >= m_capacity)
+      {
+        Clock::time_point start = Clock::now();
+        m_notFull.wait(lock, [this]{return m_items.size() < m_capacity;});
+        waitSeconds += toSeconds(start, Clock::now());
+      }
+
+      m_items.push_back(std::move(item));
+      lock.unlock();
+      m_notEmpty.notify_one();
+    }
+
+    bool pop(Item& item, double& waitSeconds)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      if (m_items.empty() && m_qtyProducers > 0)
+      {
+        Clock::time_point start = Clock::now();
+        m_notEmpty.wait(lock, [this]{return !m_items.empty() || m_qtyProducers == 0;});
+        waitSeconds += toSeconds(start, Clock::now());
+      }
+
+      if (m_items.empty())
+      {
+        return false;
+      }
+
+      item = std::move(m_items.front());
+      m_items.pop_front();
+      lock.unlock();
+      m_notFull.notify_one();
+
+      return true;
+    }
+
+    void finishProducer()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_qtyProducers--;
+      }
+
+      m_notEmpty.notify_all();
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::deque<Item> m_items;
+    size_t m_capacity;
+    unsigned int m_qtyProducers;
+  };
+}
+
+BatchRunner::BatchRunner(const Pipeline& pipeline) :
+  m_pipeline(pipeline),
+  m_seconds(0)
+{
+  setQtyWorkers(0, 0, 0);
+
+  for (unsigned int stage = 0; stage < QtyStages; stage++)
+  {
+    m_stageTimings[stage] = StageTiming();
+    m_stageTimings[stage].m_qtyWorkers = m_qtyWorkers[stage];
+  }
+}
+
+void BatchRunner::setQtyWorkers(unsigned int qtyDecoders, unsigned int qtyProcessors, unsigned int qtyEncoders)
+{
+  // decoding and encoding are mostly waiting for the disk or are cheap compared to the pipeline
+  unsigned int qtyCores = std::max(std::thread::hardware_concurrency(), 1u);
+  unsigned int qtyDefaultCoders = std::max(qtyCores / 4, 1u);
+
+  m_qtyWorkers[Decode] = qtyDecoders > 0 ? qtyDecoders : qtyDefaultCoders;
+  m_qtyWorkers[Encode] = qtyEncoders > 0 ? qtyEncoders : qtyDefaultCoders;
+  m_qtyWorkers[Process] = qtyProcessors > 0 ? qtyProcessors : std::max(qtyCores - std::min(qtyCores, 2 * qtyDefaultCoders), 1u);
+}
+
+unsigned int BatchRunner::getQtyWorkers(Stage stage) const
+{
+  return m_qtyWorkers[stage];
+}
+
+unsigned int BatchRunner::run(std::vector<Job>& jobs, const std::function<void(const Job& job)>& finished)
+{
+  Clock::time_point start = Clock::now();
+
+  for (size_t i = 0; i < jobs.size(); i++)
+  {
+    Job& job = jobs[i];
+    job.m_isOk = false;
+    job.m_error.clear();
+    job.m_width = 0;
+    job.m_height = 0;
+    job.m_qtyLayers = 0;
+    std::fill(job.m_seconds, job.m_seconds + QtyStages, 0.0);
+  }
+
+  for (unsigned int stage = 0; stage < QtyStages; stage++)
+  {
+    m_stageTimings[stage] = StageTiming();
+    m_stageTimings[stage].m_qtyWorkers = m_qtyWorkers[stage];
+  }
+
+  unsigned int qtyDecoders = m_qtyWorkers[Decode];
+  unsigned int qtyProcessors = m_qtyWorkers[Process];
+  unsigned int qtyEncoders = m_qtyWorkers[Encode];
+  unsigned int qtyWorkers = qtyDecoders + qtyProcessors + qtyEncoders;
+
+  // two images per worker of the next stage keep it busy, if the previous stage is slower for a moment
+  Queue decoded(2 * qtyProcessors, qtyDecoders);
+  Queue processed(2 * qtyEncoders, qtyProcessors);
+
+  std::atomic<size_t> nextJob(0);
+  unsigned int qtyFailed = 0;
+  std::mutex mutex;
+
+  std::function<void(Job&, const char*)> finish = [&](Job& job, const char* error)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    job.m_isOk = error == 0;
+    if (!job.m_isOk)
+    {
+      job.m_error = error;
+      qtyFailed++;
+    }
+
+    if (finished)
+    {
+      finished(job);
+    }
+  };
+
+  // every worker is one task and the pool has one thread per task -> all workers run at the same time
+  // the Matrix operations inside of a task run single threaded, see ThreadPool
+  ThreadPool threadPool(qtyWorkers);
+
+  threadPool.run(qtyWorkers, [&](unsigned int worker)
+  {
+    Stage stage = worker < qtyDecoders ? Decode : worker < qtyDecoders + qtyProcessors ? Process : Encode;
+    unsigned long long qtyImages = 0;
+    double busySeconds = 0;
+    double waitSeconds = 0;
+    Item item;
+
+    if (stage == Decode)
+    {
+      size_t jobIndex;
+      while ((jobIndex = nextJob++) < jobs.size())
+      {
+        Job& job = jobs[jobIndex];
+        Clock::time_point begin = Clock::now();
+
+        item.m_jobIndex = jobIndex;
+        item.m_image.reset(new Matrix<unsigned char>(1, 1));
+        bool isRead = ImageFile::read(job.m_inputFileName, *item.m_image);
+
+        job.m_seconds[Decode] = toSeconds(begin, Clock::now());
+        busySeconds += job.m_seconds[Decode];
+        qtyImages++;
+
+        if (!isRead)
+        {
+          item.m_image.reset();
+          finish(job, "could not be read");
+          continue;
+        }
+
+        job.m_width = item.m_image->getWidth();
+        job.m_height = item.m_image->getHeight();
+        job.m_qtyLayers = item.m_image->getQtyLayers();
+
+        decoded.push(item, waitSeconds);
+      }
+
+      decoded.finishProducer();
+    }
+    else if (stage == Process)
+    {
+      while (decoded.pop(item, waitSeconds))
+      {
+        Job& job = jobs[item.m_jobIndex];
+        Clock::time_point begin = Clock::now();
+
+        m_pipeline.apply(*item.m_image, 1);
+
+        job.m_seconds[Process] = toSeconds(begin, Clock::now());
+        busySeconds += job.m_seconds[Process];
+        qtyImages++;
+
+        processed.push(item, waitSeconds);
+      }
+
+      processed.finishProducer();
+    }
+    else
+    {
+      while (processed.pop(item, waitSeconds))
+      {
+        Job& job = jobs[item.m_jobIndex];
+        Clock::time_point begin = Clock::now();
+
+        bool isWritten = job.m_outputFileName.empty() || ImageFile::write(job.m_outputFileName, *item.m_image);
+        item.m_image.reset();
+
+        job.m_seconds[Encode] = toSeconds(begin, Clock::now());
+        busySeconds += job.m_seconds[Encode];
+        qtyImages++;
+
+        finish(job, isWritten ? 0 : "could not be written");
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    m_stageTimings[stage].m_qtyImages += qtyImages;
+    m_stageTimings[stage].m_busySeconds += busySeconds;
+    m_stageTimings[stage].m_waitSeconds += waitSeconds;
+  }, qtyWorkers);
+
+  m_seconds = toSeconds(start, Clock::now());
+
+  return qtyFailed;
+}
+
+const BatchRunner::StageTiming& BatchRunner::getStageTiming(Stage stage) const
+{
+  return m_stageTimings[stage];
+}
+
+double BatchRunner::getSeconds() const
+{
+  return m_seconds;
+}
+
+const char* BatchRunner::getStageName(Stage stage)
+{
+  switch (stage)
+  {
+  case Decode:
+    return "decode";
+  case Process:
+    return "process";
+  case Encode:
+    return "encode";
+  default:
+    return "";
+  }
+}
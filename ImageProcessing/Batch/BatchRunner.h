@@ -0,0 +1,72 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Pipeline.h"
+
+// applies a Pipeline to many images: decode, process and encode are overlapping stages
+// every stage has its own workers, all workers run as tasks of one ThreadPool and the stages are connected by bounded queues
+// -> only a few images per worker are in memory at the same time, the number of images is unlimited
+// the workers of the process stage run the Pipeline single threaded, the images are processed in parallel instead
+class BatchRunner
+{
+public:
+  enum Stage
+  {
+    Decode,
+    Process,
+    Encode,
+    QtyStages
+  };
+
+  class Job
+  {
+  public:
+    std::string m_inputFileName;
+    std::string m_outputFileName; // empty -> the result is not written
+
+    // set by run()
+    bool m_isOk;
+    std::string m_error;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_qtyLayers;
+    double m_seconds[QtyStages];
+  };
+
+  class StageTiming
+  {
+  public:
+    unsigned int m_qtyWorkers;
+    unsigned long long m_qtyImages;
+    double m_busySeconds; // sum over all workers
+    double m_waitSeconds; // sum over all workers: waiting for an image of the previous stage or for space in the queue of the next stage
+  };
+
+  explicit BatchRunner(const Pipeline& pipeline);
+
+  // 0 -> 1 decoder and 1 encoder per 4 cores, the other cores process
+  void setQtyWorkers(unsigned int qtyDecoders, unsigned int qtyProcessors, unsigned int qtyEncoders);
+  unsigned int getQtyWorkers(Stage stage) const;
+
+  // finished is called once for every job as soon as it is done or has failed, never by two threads at the same time
+  // returns the number of failed jobs, must not be called from a task of a ThreadPool (the stages would run one after the other)
+  unsigned int run(std::vector<Job>& jobs, const std::function<void(const Job& job)>& finished = std::function<void(const Job&)>());
+
+  // of the last run
+  const StageTiming& getStageTiming(Stage stage) const;
+  double getSeconds() const;
+
+  static const char* getStageName(Stage stage);
+
+private:
+  const Pipeline& m_pipeline;
+  unsigned int m_qtyWorkers[QtyStages];
+  StageTiming m_stageTimings[QtyStages];
+  double m_seconds;
+};
+
+#endif // BATCHRUNNER_H
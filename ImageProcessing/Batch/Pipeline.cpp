@@ -0,0 +1,430 @@
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include "FilterGenerator.h"
+#include "Pipeline.h"
+#include "Rectangle.h"
+#include "StructuringElementGenerator.h"
+
+namespace
+{
+  typedef Matrix<unsigned char> Image;
+  typedef std::function<void(Image& image, unsigned int qtyThreads)> Apply;
+
+  // the operations of Matrix which work on one layer are applied to every layer
+  template<typename Function>
+  Apply forEachLayer(const Function& function)
+  {
+    return [function](Image& image, unsigned int qtyThreads)
+    {
+      for (unsigned int z = 0; z < image.getQtyLayers(); z++)
+      {
+        function(image, z, qtyThreads);
+      }
+    };
+  }
+
+  bool toDouble(const std::string& text, double& value)
+  {
+    char* end = 0;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == 0;
+  }
+
+  bool toUnsigned(const std::string& text, unsigned int& value)
+  {
+    double number;
+    if (!toDouble(text, number) || number < 0 || number > 4294967295.0 || number != static_cast<unsigned int>(number))
+    {
+      return false;
+    }
+
+    value = static_cast<unsigned int>(number);
+    return true;
+  }
+
+  bool toValue(const std::string& text, unsigned char& value)
+  {
+    unsigned int number;
+    if (!toUnsigned(text, number) || number > 255)
+    {
+      return false;
+    }
+
+    value = static_cast<unsigned char>(number);
+    return true;
+  }
+
+  // the structuring element is described by the tokens from first to the end of the line
+  bool parseStructuringElement(const std::vector<std::string>& tokens, size_t first, std::shared_ptr<const StructuringElement>& structuringElement, std::string& error)
+  {
+    size_t qtyParameters = tokens.size() > first ? tokens.size() - first - 1 : 0;
+    const std::string shape = tokens.size() > first ? tokens[first] : "";
+    unsigned int width = 0;
+    unsigned int height = 0;
+    double angle = 0;
+
+    if (shape == "rectangle" && (qtyParameters == 1 || qtyParameters == 2) && toUnsigned(tokens[first + 1], width) && width > 0
+        && (qtyParameters == 1 || (toUnsigned(tokens[first + 2], height) && height > 0)))
+    {
+      structuringElement.reset(new StructuringElement(StructuringElementGenerator::rectangle(width, height)));
+    }
+    else if (shape == "circle" && qtyParameters == 1 && toUnsigned(tokens[first + 1], width))
+    {
+      structuringElement.reset(new StructuringElement(StructuringElementGenerator::circle(width)));
+    }
+    else if (shape == "line" && qtyParameters == 2 && toUnsigned(tokens[first + 1], width) && toDouble(tokens[first + 2], angle))
+    {
+      structuringElement.reset(new StructuringElement(StructuringElementGenerator::line(width, static_cast<float>(angle))));
+    }
+    else if (shape == "neighborhood4" && qtyParameters == 0)
+    {
+      structuringElement.reset(new StructuringElement(StructuringElementGenerator::neighborhood4()));
+    }
+    else if (shape == "neighborhood8" && qtyParameters == 0)
+    {
+      structuringElement.reset(new StructuringElement(StructuringElementGenerator::neighborhood8()));
+    }
+    else
+    {
+      error = "invalid structuring element";
+      return false;
+    }
+
+    return true;
+  }
+
+  bool parseFilter(const std::vector<std::string>& tokens, Apply& apply, std::string& error)
+  {
+    if (tokens.size() < 2)
+    {
+      error = "filter needs a type";
+      return false;
+    }
+
+    const std::string& type = tokens[1];
+    size_t qtyParameters = tokens.size() - 2;
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    // the classic 3 x 3 filters and the small binomial filters are compiled kernels, see FixedKernel
+    if (type == "sobelHorizontal" && qtyParameters == 0)
+    {
+      apply = forEachLayer([](Image& image, unsigned int z, unsigned int qtyThreads) {image.filter<FilterGenerator::SobelHorizontal>(z, qtyThreads);});
+      return true;
+    }
+
+    if (type == "sobelVertical" && qtyParameters == 0)
+    {
+      apply = forEachLayer([](Image& image, unsigned int z, unsigned int qtyThreads) {image.filter<FilterGenerator::SobelVertical>(z, qtyThreads);});
+      return true;
+    }
+
+    if (type == "laplacian" && qtyParameters == 0)
+    {
+      apply = forEachLayer([](Image& image, unsigned int z, unsigned int qtyThreads) {image.filter<FilterGenerator::Laplacian>(z, qtyThreads);});
+      return true;
+    }
+
+    if ((type != "binomial" && type != "mean") || qtyParameters < 1 || qtyParameters > 2 || !toUnsigned(tokens[2], width) || width == 0
+        || (qtyParameters == 2 && (!toUnsigned(tokens[3], height) || height == 0)))
+    {
+      error = "invalid filter";
+      return false;
+    }
+
+    if (height == 0)
+    {
+      height = width;
+    }
+
+    if (type == "binomial" && width == 3 && height == 3)
+    {
+      apply = forEachLayer([](Image& image, unsigned int z, unsigned int qtyThreads) {image.filter<FilterGenerator::Binomial3>(z, qtyThreads);});
+      return true;
+    }
+
+    if (type == "binomial" && width == 5 && height == 5)
+    {
+      apply = forEachLayer([](Image& image, unsigned int z, unsigned int qtyThreads) {image.filter<FilterGenerator::Binomial5>(z, qtyThreads);});
+      return true;
+    }
+
+    std::shared_ptr<const Filter> filter(new Filter(type == "binomial" ? FilterGenerator::binomial(width, height) : FilterGenerator::mean(width, height)));
+    apply = forEachLayer([filter](Image& image, unsigned int z, unsigned int qtyThreads) {image.filter(filter.get(), z, qtyThreads);});
+    return true;
+  }
+}
+
+bool Pipeline::read(const std::string& fileName, std::string& error)
+{
+  std::ifstream stream(fileName.c_str());
+  if (!stream)
+  {
+    error = fileName + " could not be opened";
+    return false;
+  }
+
+  return parse(stream, error);
+}
+
+bool Pipeline::parse(std::istream& stream, std::string& error)
+{
+  std::vector<Operation> operations;
+  std::string line;
+
+  for (unsigned int lineNumber = 1; std::getline(stream, line); lineNumber++)
+  {
+    std::istringstream lineStream(line.substr(0, line.find('#')));
+    std::vector<std::string> tokens;
+    std::string token;
+
+    while (lineStream >> token)
+    {
+      tokens.push_back(token);
+    }
+
+    if (tokens.empty())
+    {
+      continue;
+    }
+
+    Operation operation;
+    if (!parseOperation(tokens, operation, error))
+    {
+      std::ostringstream message;
+      message << "line " << lineNumber << ": " << error;
+      error = message.str();
+      return false;
+    }
+
+    operations.push_back(operation);
+  }
+
+  m_operations.swap(operations);
+  return true;
+}
+
+const std::vector<Pipeline::Operation>& Pipeline::getOperations() const
+{
+  return m_operations;
+}
+
+void Pipeline::apply(Matrix<unsigned char>& image, unsigned int qtyThreads) const
+{
+  for (size_t i = 0; i < m_operations.size(); i++)
+  {
+    m_operations[i].m_apply(image, qtyThreads);
+  }
+}
+
+std::string Pipeline::getSyntax()
+{
+  return
+    "one operation per line, # starts a comment, <se> is a structuring element:\n"
+    "  rectangle <width> [<height>] | circle <radius> | line <length> <angle> | neighborhood4 | neighborhood8\n"
+    "filter sobelHorizontal | sobelVertical | laplacian | binomial <width> [<height>] | mean <width> [<height>]\n"
+    "filterMean <width> [<height>]\n"
+    "filterMedian <se>\n"
+    "filterQuantil <quantil> <se>\n"
+    "filterConservativeSmoothing <se>\n"
+    "erode <se> | dilate <se> | open <se> | close <se>\n"
+    "binarize <threshold>\n"
+    "invert\n"
+    "replace <currentValue> <newValue>\n"
+    "spread\n"
+    "autoContrast [<lowerQuantil> <upperQuantil>]\n"
+    "rotate <angle> [nearestNeighbour | bilinear] [<backgroundValue>]\n"
+    "rotateBy90DegreeClockwise | rotateBy90DegreeCounterClockwise | rotateBy180Degree\n"
+    "mirrorOnHorizontalAxis | mirrorOnVerticalAxis\n"
+    "crop <x> <y> <width> <height>\n";
+}
+
+bool Pipeline::parseOperation(const std::vector<std::string>& tokens, Operation& operation, std::string& error) const
+{
+  const std::string& name = tokens[0];
+  size_t qtyParameters = tokens.size() - 1;
+
+  std::ostringstream description;
+  for (size_t i = 0; i < tokens.size(); i++)
+  {
+    description << (i > 0 ? " " : "") << tokens[i];
+  }
+  operation.m_description = description.str();
+
+  std::shared_ptr<const StructuringElement> structuringElement;
+  unsigned int width = 0;
+  unsigned int height = 0;
+  double number1 = 0;
+  double number2 = 1;
+  unsigned char value1 = 0;
+  unsigned char value2 = 0;
+
+  if (name == "filter")
+  {
+    return parseFilter(tokens, operation.m_apply, error);
+  }
+
+  if (name == "filterMean")
+  {
+    if (qtyParameters < 1 || qtyParameters > 2 || !toUnsigned(tokens[1], width) || width == 0 || (qtyParameters == 2 && (!toUnsigned(tokens[2], height) || height == 0)))
+    {
+      error = "filterMean needs a width and an optional height";
+      return false;
+    }
+
+    operation.m_apply = forEachLayer([width, height](Image& image, unsigned int z, unsigned int qtyThreads) {image.filterMean(width, height, z, qtyThreads);});
+    return true;
+  }
+
+  if (name == "filterQuantil")
+  {
+    if (qtyParameters < 2 || !toDouble(tokens[1], number1) || number1 < 0 || number1 > 1 || !parseStructuringElement(tokens, 2, structuringElement, error))
+    {
+      error = "filterQuantil needs a quantil between 0 and 1 and a structuring element";
+      return false;
+    }
+
+    operation.m_apply = forEachLayer([structuringElement, number1](Image& image, unsigned int z, unsigned int qtyThreads) {image.filterQuantil(structuringElement.get(), number1, z, qtyThreads);});
+    return true;
+  }
+
+  if (name == "filterMedian" || name == "filterConservativeSmoothing" || name == "erode" || name == "dilate" || name == "open" || name == "close")
+  {
+    if (!parseStructuringElement(tokens, 1, structuringElement, error))
+    {
+      error = name + " needs a structuring element";
+      return false;
+    }
+
+    typedef void (Image::*Function)(const StructuringElement*, unsigned int, unsigned int);
+    Function function = name == "filterMedian" ? static_cast<Function>(&Image::filterMedian)
+      : name == "filterConservativeSmoothing" ? static_cast<Function>(&Image::filterConservativeSmoothing)
+      : name == "erode" ? static_cast<Function>(&Image::erode)
+      : name == "dilate" ? static_cast<Function>(&Image::dilate)
+      : name == "open" ? static_cast<Function>(&Image::open)
+      : static_cast<Function>(&Image::close);
+
+    operation.m_apply = forEachLayer([structuringElement, function](Image& image, unsigned int z, unsigned int qtyThreads) {(image.*function)(structuringElement.get(), z, qtyThreads);});
+    return true;
+  }
+
+  if (name == "binarize")
+  {
+    if (qtyParameters != 1 || !toValue(tokens[1], value1))
+    {
+      error = "binarize needs a threshold between 0 and 255";
+      return false;
+    }
+
+    operation.m_apply = [value1](Image& image, unsigned int) {image.binarize(value1);};
+    return true;
+  }
+
+  if (name == "replace")
+  {
+    if (qtyParameters != 2 || !toValue(tokens[1], value1) || !toValue(tokens[2], value2))
+    {
+      error = "replace needs two values between 0 and 255";
+      return false;
+    }
+
+    operation.m_apply = forEachLayer([value1, value2](Image& image, unsigned int z, unsigned int) {image.replace(value1, value2, z);});
+    return true;
+  }
+
+  if (name == "autoContrast")
+  {
+    if ((qtyParameters != 0 && qtyParameters != 2)
+        || (qtyParameters == 2 && (!toDouble(tokens[1], number1) || !toDouble(tokens[2], number2) || number1 < 0 || number2 > 1 || number1 >= number2)))
+    {
+      error = "autoContrast needs no parameter or two quantils 0 <= lower < upper <= 1";
+      return false;
+    }
+
+    operation.m_apply = forEachLayer([number1, number2](Image& image, unsigned int z, unsigned int) {image.autoContrast(number1, number2, z);});
+    return true;
+  }
+
+  if (name == "rotate")
+  {
+    PolarTransformation::Interpolation interpolation = PolarTransformation::Bilinear;
+
+    if (qtyParameters < 1 || qtyParameters > 3 || !toDouble(tokens[1], number1)
+        || (qtyParameters >= 2 && tokens[2] != "nearestNeighbour" && tokens[2] != "bilinear")
+        || (qtyParameters == 3 && !toValue(tokens[3], value1)))
+    {
+      error = "rotate needs an angle, an optional interpolation and an optional background value";
+      return false;
+    }
+
+    if (qtyParameters >= 2 && tokens[2] == "nearestNeighbour")
+    {
+      interpolation = PolarTransformation::NearestNeighbour;
+    }
+
+    float angle = static_cast<float>(number1);
+    operation.m_apply = [angle, interpolation, value1](Image& image, unsigned int qtyThreads) {image.rotate(angle, interpolation, value1, qtyThreads);};
+    return true;
+  }
+
+  if (name == "crop")
+  {
+    unsigned int x = 0;
+    unsigned int y = 0;
+
+    if (qtyParameters != 4 || !toUnsigned(tokens[1], x) || !toUnsigned(tokens[2], y) || !toUnsigned(tokens[3], width) || !toUnsigned(tokens[4], height) || width == 0 || height == 0)
+    {
+      error = "crop needs x, y, width and height";
+      return false;
+    }
+
+    Rectangle cropRegion(Point(static_cast<float>(x), static_cast<float>(y)), static_cast<float>(width), static_cast<float>(height));
+    operation.m_apply = [cropRegion](Image& image, unsigned int) {image = image.crop(cropRegion);};
+    return true;
+  }
+
+  if (qtyParameters > 0)
+  {
+    error = name + " is unknown or has too many parameters";
+    return false;
+  }
+
+  if (name == "invert")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.invert();};
+  }
+  else if (name == "spread")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.spread();};
+  }
+  else if (name == "rotateBy90DegreeClockwise")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.rotateBy90DegreeClockwise();};
+  }
+  else if (name == "rotateBy90DegreeCounterClockwise")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.rotateBy90DegreeCounterClockwise();};
+  }
+  else if (name == "rotateBy180Degree")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.rotateBy180Degree();};
+  }
+  else if (name == "mirrorOnHorizontalAxis")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.mirrorOnHorizontalAxis();};
+  }
+  else if (name == "mirrorOnVerticalAxis")
+  {
+    operation.m_apply = [](Image& image, unsigned int) {image.mirrorOnVerticalAxis();};
+  }
+  else
+  {
+    error = name + " is unknown";
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+
+// sequence of Matrix operations, which is applied to every image of a batch
+// the description has one operation per line, the parameters are separated by blanks, # starts a comment:
+//   filter binomial 5
+//   erode rectangle 3 3
+//   binarize 128
+// the operations are named like the functions of Matrix, see getSyntax()
+// a Pipeline is not changed by apply(), so one Pipeline can be applied to several images in parallel
+class Pipeline
+{
+public:
+  class Operation
+  {
+  public:
+    std::string m_description; // the line of the description without comment
+    std::function<void(Matrix<unsigned char>& image, unsigned int qtyThreads)> m_apply;
+  };
+
+  // error contains the line and the reason, if the description is not valid
+  bool read(const std::string& fileName, std::string& error);
+  bool parse(std::istream& stream, std::string& error);
+
+  const std::vector<Operation>& getOperations() const;
+
+  // qtyThreads is passed to the operations of Matrix: 0 -> all threads of ThreadPool::getInstance(), 1 -> single threaded
+  void apply(Matrix<unsigned char>& image, unsigned int qtyThreads = 0) const;
+
+  static std::string getSyntax();
+
+private:
+  bool parseOperation(const std::vector<std::string>& tokens, Operation& operation, std::string& error) const;
+
+  std::vector<Operation> m_operations;
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QString>
+
+#include "BatchRunner.h"
+#include "ImageFile.h"
+#include "Pipeline.h"
+
+// headless batch processing of a folder of images
+// usage: Batch --pipeline pipeline.txt --input folder [--output folder] [--format .png] [--recursive]
+//              [--decoders 0] [--processors 0] [--encoders 0] [--report report.csv]
+// every image of the input folder is decoded, processed by the pipeline and encoded into the output folder with the same relative path
+// without --output the images are only processed (e.g. to measure the pipeline), the stage timing is written to stdout
+// the exit code is 1 if an image could not be read or written, 2 if the arguments or the pipeline are not valid
+
+namespace
+{
+  // relative to the input folder, the extension is replaced, if format is not empty
+  std::string getOutputFileName(const QDir& inputFolder, const QDir& outputFolder, const QString& inputFileName, const std::string& format)
+  {
+    QString relativeFileName = inputFolder.relativeFilePath(inputFileName);
+
+    if (!format.empty())
+    {
+      QFileInfo fileInfo(relativeFileName);
+      QString path = fileInfo.path() == "." ? QString() : fileInfo.path() + "/";
+      relativeFileName = path + fileInfo.completeBaseName() + QString::fromLocal8Bit(format.c_str());
+    }
+
+    return QDir::toNativeSeparators(outputFolder.filePath(relativeFileName)).toLocal8Bit().constData();
+  }
+
+  void writeTiming(const BatchRunner& runner, size_t qtyJobs, unsigned int qtyFailed, std::ostream& stream)
+  {
+    char line[256];
+
+    // busy: ms per image of one worker, utilization: busy time / (workers * total time)
+    snprintf(line, sizeof(line), "%-8s %8s %10s %10s %10s %12s\n", "stage", "workers", "images", "busy[ms]", "wait[ms]", "utilization");
+    stream << line;
+
+    for (unsigned int stage = 0; stage < BatchRunner::QtyStages; stage++)
+    {
+      const BatchRunner::StageTiming& timing = runner.getStageTiming(static_cast<BatchRunner::Stage>(stage));
+      double qtyImages = std::max(static_cast<double>(timing.m_qtyImages), 1.0);
+      double utilization = runner.getSeconds() > 0 ? timing.m_busySeconds / (timing.m_qtyWorkers * runner.getSeconds()) : 0;
+
+      snprintf(line, sizeof(line), "%-8s %8u %10llu %10.2f %10.2f %11.0f%%\n", BatchRunner::getStageName(static_cast<BatchRunner::Stage>(stage)), timing.m_qtyWorkers,
+               timing.m_qtyImages, 1000 * timing.m_busySeconds / qtyImages, 1000 * timing.m_waitSeconds / qtyImages, 100 * utilization);
+      stream << line;
+    }
+
+    snprintf(line, sizeof(line), "%lu images, %u failed, %.2f s, %.1f images/s\n", static_cast<unsigned long>(qtyJobs), qtyFailed, runner.getSeconds(),
+             runner.getSeconds() > 0 ? qtyJobs / runner.getSeconds() : 0.0);
+    stream << line;
+  }
+
+  int printUsage(const char* program)
+  {
+    std::cerr << "usage: " << program << " --pipeline pipeline.txt --input folder [--output folder] [--format .png] [--recursive]"
+              << " [--decoders 0] [--processors 0] [--encoders 0] [--report report.csv]" << std::endl << std::endl
+              << Pipeline::getSyntax();
+    return 2;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  // the image format plugins of QImage are found by the application, no display is needed
+  QCoreApplication application(argc, argv);
+
+  std::string pipelineFileName;
+  std::string inputFolderName;
+  std::string outputFolderName;
+  std::string format;
+  std::string reportFileName;
+  bool isRecursive = false;
+  unsigned int qtyDecoders = 0;
+  unsigned int qtyProcessors = 0;
+  unsigned int qtyEncoders = 0;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+
+    if (argument == "--pipeline" && hasValue)
+    {
+      pipelineFileName = argv[++i];
+    }
+    else if (argument == "--input" && hasValue)
+    {
+      inputFolderName = argv[++i];
+    }
+    else if (argument == "--output" && hasValue)
+    {
+      outputFolderName = argv[++i];
+    }
+    else if (argument == "--format" && hasValue)
+    {
+      format = argv[++i];
+      if (format[0] != '.')
+      {
+        format = "." + format;
+      }
+    }
+    else if (argument == "--recursive")
+    {
+      isRecursive = true;
+    }
+    else if (argument == "--decoders" && hasValue)
+    {
+      qtyDecoders = static_cast<unsigned int>(atoi(argv[++i]));
+    }
+    else if (argument == "--processors" && hasValue)
+    {
+      qtyProcessors = static_cast<unsigned int>(atoi(argv[++i]));
+    }
+    else if (argument == "--encoders" && hasValue)
+    {
+      qtyEncoders = static_cast<unsigned int>(atoi(argv[++i]));
+    }
+    else if (argument == "--report" && hasValue)
+    {
+      reportFileName = argv[++i];
+    }
+    else
+    {
+      return printUsage(argv[0]);
+    }
+  }
+
+  if (pipelineFileName.empty() || inputFolderName.empty() || (!format.empty() && !ImageFile::isSupported(format)))
+  {
+    return printUsage(argv[0]);
+  }
+
+  Pipeline pipeline;
+  std::string error;
+  if (!pipeline.read(pipelineFileName, error))
+  {
+    std::cerr << pipelineFileName << ": " << error << std::endl;
+    return 2;
+  }
+
+  QDir inputFolder(QString::fromLocal8Bit(inputFolderName.c_str()));
+  if (!inputFolder.exists())
+  {
+    std::cerr << "input folder " << inputFolderName << " does not exist" << std::endl;
+    return 2;
+  }
+
+  QDir outputFolder(QString::fromLocal8Bit(outputFolderName.c_str()));
+
+  // sorted, so the report of every run has the same order
+  std::vector<QString> inputFileNames;
+  QDirIterator it(inputFolder.absolutePath(), QDir::Files, isRecursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+  while (it.hasNext())
+  {
+    QString fileName = it.next();
+    if (ImageFile::isSupported(fileName.toLocal8Bit().constData()))
+    {
+      inputFileNames.push_back(fileName);
+    }
+  }
+  std::sort(inputFileNames.begin(), inputFileNames.end());
+
+  std::vector<BatchRunner::Job> jobs(inputFileNames.size());
+  std::set<QString> outputPaths;
+
+  for (size_t i = 0; i < inputFileNames.size(); i++)
+  {
+    jobs[i].m_inputFileName = inputFileNames[i].toLocal8Bit().constData();
+
+    if (!outputFolderName.empty())
+    {
+      jobs[i].m_outputFileName = getOutputFileName(QDir(inputFolder.absolutePath()), outputFolder, inputFileNames[i], format);
+      outputPaths.insert(QFileInfo(QString::fromLocal8Bit(jobs[i].m_outputFileName.c_str())).absolutePath());
+    }
+  }
+
+  for (std::set<QString>::const_iterator path = outputPaths.begin(); path != outputPaths.end(); ++path)
+  {
+    if (!QDir().mkpath(*path))
+    {
+      std::cerr << "output folder " << path->toLocal8Bit().constData() << " could not be created" << std::endl;
+      return 2;
+    }
+  }
+
+  std::ofstream report;
+  if (!reportFileName.empty())
+  {
+    report.open(reportFileName.c_str());
+    if (!report)
+    {
+      std::cerr << "report " << reportFileName << " could not be created" << std::endl;
+      return 2;
+    }
+
+    report << "file,status,width,height,layers,decode_ms,process_ms,encode_ms" << std::endl;
+  }
+
+  BatchRunner runner(pipeline);
+  runner.setQtyWorkers(qtyDecoders, qtyProcessors, qtyEncoders);
+
+  unsigned int qtyFailed = runner.run(jobs, [&](const BatchRunner::Job& job)
+  {
+    if (!job.m_isOk)
+    {
+      std::cerr << job.m_inputFileName << ": " << job.m_error << std::endl;
+    }
+
+    if (report.is_open())
+    {
+      report << job.m_inputFileName << "," << (job.m_isOk ? "ok" : job.m_error) << "," << job.m_width << "," << job.m_height << "," << job.m_qtyLayers
+             << "," << 1000 * job.m_seconds[BatchRunner::Decode] << "," << 1000 * job.m_seconds[BatchRunner::Process] << "," << 1000 * job.m_seconds[BatchRunner::Encode] << "\n";
+    }
+  });
+
+  writeTiming(runner, jobs.size(), qtyFailed, std::cout);
+
+  return qtyFailed > 0 ? 1 : 0;
+}
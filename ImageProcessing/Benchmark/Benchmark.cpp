@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "Benchmark.h"
+
+std::string Benchmark::Result::getKey() const
+{
+  std::ostringstream key;
+  key << m_operation << "," << m_type << "," << m_width << "," << m_height << "," << m_parameter;
+  return key.str();
+}
+
+Benchmark::Benchmark(unsigned int qtyRepetitions) :
+  m_qtyRepetitions(qtyRepetitions > 0 ? qtyRepetitions : 1)
+{
+}
+
+void Benchmark::setFilter(const std::string& filter)
+{
+  m_filter = filter;
+}
+
+bool Benchmark::isSelected(const std::string& operation) const
+{
+  return m_filter.empty() || operation.find(m_filter) != std::string::npos;
+}
+
+void Benchmark::measure(const std::string& operation, const std::string& type, unsigned int width, unsigned int height, const std::string& parameter,
+                        const std::function<void()>& prepare, const std::function<void()>& function)
+{
+  if (!isSelected(operation))
+  {
+    return;
+  }
+
+  // the median is robust against single slow runs, e.g. caused by page faults or other processes
+  std::vector<double> durations;
+
+  for (unsigned int i = 0; i <= m_qtyRepetitions; i++)
+  {
+    prepare();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    if (i > 0)
+    {
+      durations.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+  }
+
+  std::sort(durations.begin(), durations.end());
+  double median = durations[durations.size() / 2];
+  double qtyPixels = static_cast<double>(width) * height;
+
+  Result result;
+  result.m_operation = operation;
+  result.m_type = type;
+  result.m_width = width;
+  result.m_height = height;
+  result.m_parameter = parameter;
+  result.m_nanosecondsPerPixel = median / qtyPixels;
+  result.m_megaPixelsPerSecond = median > 0.0 ? qtyPixels * 1000.0 / median : 0.0;
+
+  m_results.push_back(result);
+
+  // progress on stderr, stdout may be redirected into the csv file
+  std::cerr << result.getKey() << ": " << result.m_nanosecondsPerPixel << " ns/pixel" << std::endl;
+}
+
+const std::vector<Benchmark::Result>& Benchmark::getResults() const
+{
+  return m_results;
+}
+
+void Benchmark::writeCsv(std::ostream& stream) const
+{
+  stream << "operation,type,width,height,parameter,ns_per_pixel,megapixels_per_second" << "\n";
+
+  for (size_t i = 0; i < m_results.size(); i++)
+  {
+    const Result& result = m_results[i];
+
+    char values[64];
+    snprintf(values, sizeof(values), "%.4f,%.2f", result.m_nanosecondsPerPixel, result.m_megaPixelsPerSecond);
+
+    stream << result.getKey() << "," << values << "\n";
+  }
+
+  stream.flush();
+}
+
+bool Benchmark::readCsv(const std::string& fileName, std::vector<Result>& results)
+{
+  std::ifstream stream(fileName.c_str());
+  if (!stream)
+  {
+    return false;
+  }
+
+  results.clear();
+
+  std::string line;
+  std::getline(stream, line); // header
+
+  while (std::getline(stream, line))
+  {
+    std::vector<std::string> fields;
+    std::istringstream lineStream(line);
+    std::string field;
+
+    while (std::getline(lineStream, field, ','))
+    {
+      fields.push_back(field);
+    }
+
+    if (fields.size() != 7)
+    {
+      continue; // e.g. an empty line at the end
+    }
+
+    Result result;
+    result.m_operation = fields[0];
+    result.m_type = fields[1];
+    result.m_width = static_cast<unsigned int>(atoi(fields[2].c_str()));
+    result.m_height = static_cast<unsigned int>(atoi(fields[3].c_str()));
+    result.m_parameter = fields[4];
+    result.m_nanosecondsPerPixel = atof(fields[5].c_str());
+    result.m_megaPixelsPerSecond = atof(fields[6].c_str());
+
+    results.push_back(result);
+  }
+
+  return true;
+}
+
+unsigned int Benchmark::compare(const std::vector<Result>& baseline, double tolerance, std::ostream& report) const
+{
+  std::map<std::string, double> baselineTimes;
+  for (size_t i = 0; i < baseline.size(); i++)
+  {
+    baselineTimes[baseline[i].getKey()] = baseline[i].m_nanosecondsPerPixel;
+  }
+
+  unsigned int qtyRegressions = 0;
+
+  for (size_t i = 0; i < m_results.size(); i++)
+  {
+    const Result& result = m_results[i];
+    std::map<std::string, double>::const_iterator it = baselineTimes.find(result.getKey());
+
+    if (it == baselineTimes.end() || it->second <= 0.0)
+    {
+      continue;
+    }
+
+    double ratio = result.m_nanosecondsPerPixel / it->second;
+    bool isRegression = ratio > 1.0 + tolerance;
+
+    if (isRegression)
+    {
+      qtyRegressions++;
+    }
+
+    char line[64];
+    snprintf(line, sizeof(line), "%.3f", ratio);
+    report << result.getKey() << ": " << line << (isRegression ? " SLOWER" : "") << "\n";
+  }
+
+  report << qtyRegressions << " of " << m_results.size() << " results are slower than the baseline" << std::endl;
+  return qtyRegressions;
+}
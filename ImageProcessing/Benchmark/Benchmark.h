@@ -0,0 +1,55 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// measures operations on images and compares the results with a baseline
+// every result is identified by operation, type, size and parameter, so results of different runs can be matched
+class Benchmark
+{
+public:
+  class Result
+  {
+  public:
+    std::string getKey() const;
+
+    std::string m_operation;
+    std::string m_type;
+    unsigned int m_width;
+    unsigned int m_height;
+    std::string m_parameter;
+    double m_nanosecondsPerPixel; // median of all repetitions
+    double m_megaPixelsPerSecond;
+  };
+
+  explicit Benchmark(unsigned int qtyRepetitions = 5);
+
+  // only operations whose name contains the filter are measured, an empty filter measures all operations
+  void setFilter(const std::string& filter);
+  bool isSelected(const std::string& operation) const;
+
+  // prepare is called before every repetition and is not measured, e.g. to restore the input of an in place operation
+  // the first call of function is a warm up and is not measured either
+  void measure(const std::string& operation, const std::string& type, unsigned int width, unsigned int height, const std::string& parameter,
+               const std::function<void()>& prepare, const std::function<void()>& function);
+
+  const std::vector<Result>& getResults() const;
+
+  // comma separated values with one header line
+  void writeCsv(std::ostream& stream) const;
+  static bool readCsv(const std::string& fileName, std::vector<Result>& results);
+
+  // reports current / baseline for every result which is also in the baseline
+  // returns the number of results which are slower than baseline * (1 + tolerance)
+  unsigned int compare(const std::vector<Result>& baseline, double tolerance, std::ostream& report) const;
+
+private:
+  unsigned int m_qtyRepetitions;
+  std::string m_filter;
+  std::vector<Result> m_results;
+};
+
+#endif // BENCHMARK_H
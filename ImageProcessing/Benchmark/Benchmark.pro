@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# headless benchmark of the ImageProcessing kernels
+# create the baseline on the reference version: Benchmark --output baseline.csv
+# compare a change on the same machine: Benchmark --baseline baseline.csv
+#
+#-------------------------------------------------
+
+QT       += core
+
+QT       -= gui
+
+TARGET = Benchmark
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    Benchmark.cpp \
+    ../Point.cpp \
+    ../Rectangle.cpp \
+    ../Circle.cpp \
+    ../FreemanCode.cpp \
+    ../PolyLine.cpp \
+    ../FilterGenerator.cpp \
+    ../StructuringElementGenerator.cpp \
+    ../RunLengthCode.cpp \
+    ../Edge.cpp \
+    ../Line.cpp \
+    ../MathHelper.cpp \
+    ../Converter.cpp \
+    ../MemoryHelper.cpp \
+    ../Convolution.cpp \
+    ../ThreadPool.cpp \
+    ../PolarTransformation.cpp \
+    ../Region.cpp \
+    ../BinaryImage.cpp \
+    ../Labeling.cpp \
+    ../EdgeProbe.cpp \
+    ../Rotation.cpp \
+    ../BufferPool.cpp
+
+HEADERS += Benchmark.h
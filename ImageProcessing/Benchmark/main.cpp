@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Circle.h"
+#include "FilterGenerator.h"
+#include "Matrix.h"
+#include "StructuringElementGenerator.h"
+#include "ThreadPool.h"
+
+// headless benchmark of the Matrix operations
+// usage: Benchmark [--sizes 512x512,2048x2048] [--repetitions 5] [--threads 0] [--filter erode]
+//                  [--output results.csv] [--baseline baseline.csv] [--tolerance 0.1]
+// the results are written as csv to --output or stdout, the exit code is 1 if a result is slower than the baseline
+// the baseline is not part of the repository, because the times depend on the machine: compare needs a csv written before on the same machine
+// with the same arguments, e.g. Benchmark --output baseline.csv on the last commit, then Benchmark --baseline baseline.csv on the change
+// operations which are missing in the baseline are not compared, a baseline which cannot be read gives the exit code 2
+
+namespace
+{
+  class Size
+  {
+  public:
+    unsigned int m_width;
+    unsigned int m_height;
+  };
+
+  std::string toString(unsigned int value)
+  {
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+  }
+
+  // threshold between the smallest and the biggest value, bool images are already binary
+  template<typename T>
+  T getThreshold(const Matrix<T>& image)
+  {
+    if (std::is_same<T, bool>::value)
+    {
+      return static_cast<T>(true);
+    }
+
+    return static_cast<T>(image.getMinimum() / 2 + image.getMaximum() / 2);
+  }
+
+  template<typename T>
+  void addMorphology(Benchmark& benchmark, const std::string& type, const Matrix<T>& original, Matrix<T>& image)
+  {
+    unsigned int width = original.getWidth();
+    unsigned int height = original.getHeight();
+    std::function<void()> restore = [&]() {image = original;};
+
+    const unsigned int sizes[] = {3, 7, 15};
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+      StructuringElement rectangle = StructuringElementGenerator::rectangle(sizes[i]);
+      std::string parameter = "rectangle" + toString(sizes[i]);
+
+      benchmark.measure("erode", type, width, height, parameter, restore, [&]() {image.erode(&rectangle);});
+      benchmark.measure("dilate", type, width, height, parameter, restore, [&]() {image.dilate(&rectangle);});
+      benchmark.measure("filterMedian", type, width, height, parameter, restore, [&]() {image.filterMedian(&rectangle);});
+    }
+
+    StructuringElement circle = StructuringElementGenerator::circle(3);
+    benchmark.measure("erode", type, width, height, "circle3", restore, [&]() {image.erode(&circle);});
+    benchmark.measure("filterMedian", type, width, height, "circle3", restore, [&]() {image.filterMedian(&circle);});
+    benchmark.measure("filterQuantil", type, width, height, "circle3", restore, [&]() {image.filterQuantil(&circle, 0.25);});
+
+    StructuringElement neighborhood8 = StructuringElementGenerator::neighborhood8();
+    benchmark.measure("filterConservativeSmoothing", type, width, height, "neighborhood8", restore, [&]() {image.filterConservativeSmoothing(&neighborhood8);});
+
+    // a rotated rectangle in the center, covering about a quarter of the image
+    StructuringElement rectangle = StructuringElementGenerator::rectangle(7);
+    Region region(Rectangle(Point(width / 4.0f, height / 4.0f), width / 2.0f, height / 2.0f, 30.0f));
+    benchmark.measure("erode", type, width, height, "rectangle7.region", restore, [&]() {image.erode(&rectangle, region);});
+    benchmark.measure("filterMedian", type, width, height, "rectangle7.region", restore, [&]() {image.filterMedian(&rectangle, region);});
+  }
+
+  template<typename T>
+  void addFilters(Benchmark& benchmark, const std::string& type, const Matrix<T>& original, Matrix<T>& image)
+  {
+    unsigned int width = original.getWidth();
+    unsigned int height = original.getHeight();
+    std::function<void()> restore = [&]() {image = original;};
+
+    const unsigned int sizes[] = {3, 7, 15, 31};
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+      Filter mean = FilterGenerator::mean(sizes[i]);
+      Filter binomial = FilterGenerator::binomial(sizes[i]);
+      std::string parameter = toString(sizes[i]);
+
+      benchmark.measure("filter.mean", type, width, height, parameter, restore, [&]() {image.filter(&mean);});
+      benchmark.measure("filter.binomial", type, width, height, parameter, restore, [&]() {image.filter(&binomial);});
+      benchmark.measure("filterMean", type, width, height, parameter, restore, [&]() {image.filterMean(sizes[i]);});
+    }
+
+    Filter laplacian = FilterGenerator::laplacian();
+    Filter sobel = FilterGenerator::sobelHorizontal();
+    benchmark.measure("filter.laplacian", type, width, height, "3", restore, [&]() {image.filter(&laplacian);});
+    benchmark.measure("filter.sobelHorizontal", type, width, height, "3", restore, [&]() {image.filter(&sobel);});
+    benchmark.measure("filter.fixed.laplacian", type, width, height, "3", restore, [&]() {image.template filter<FilterGenerator::Laplacian>();});
+    benchmark.measure("filter.fixed.sobelHorizontal", type, width, height, "3", restore, [&]() {image.template filter<FilterGenerator::SobelHorizontal>();});
+    benchmark.measure("filter.fixed.binomial", type, width, height, "3", restore, [&]() {image.template filter<FilterGenerator::Binomial3>();});
+    benchmark.measure("filter.fixed.binomial", type, width, height, "5", restore, [&]() {image.template filter<FilterGenerator::Binomial5>();});
+
+    benchmark.measure("getIntegralImage", type, width, height, "", restore, [&]() {image.getIntegralImage();});
+  }
+
+  template<typename T>
+  void addPointOperations(Benchmark& benchmark, const std::string& type, const Matrix<T>& original, Matrix<T>& image)
+  {
+    unsigned int width = original.getWidth();
+    unsigned int height = original.getHeight();
+    std::function<void()> restore = [&]() {image = original;};
+    T threshold = getThreshold(original);
+
+    benchmark.measure("binarize", type, width, height, "", restore, [&]() {image.binarize(threshold);});
+    benchmark.measure("invert", type, width, height, "", restore, [&]() {image.invert();});
+    benchmark.measure("replace", type, width, height, "", restore, [&]() {image.replace(threshold, 0);});
+    benchmark.measure("pointOperations", type, width, height, "invert.binarize", restore, [&]() {image.pointOperations().invert().binarize(threshold).apply();});
+  }
+
+  template<typename T>
+  void addGeometry(Benchmark& benchmark, const std::string& type, const Matrix<T>& original, Matrix<T>& image)
+  {
+    unsigned int width = original.getWidth();
+    unsigned int height = original.getHeight();
+    std::function<void()> restore = [&]() {image = original;};
+
+    benchmark.measure("mirrorOnHorizontalAxis", type, width, height, "", restore, [&]() {image.mirrorOnHorizontalAxis();});
+    benchmark.measure("mirrorOnVerticalAxis", type, width, height, "", restore, [&]() {image.mirrorOnVerticalAxis();});
+    benchmark.measure("rotateBy90DegreeClockwise", type, width, height, "", restore, [&]() {image.rotateBy90DegreeClockwise();});
+    benchmark.measure("rotateBy180Degree", type, width, height, "", restore, [&]() {image.rotateBy180Degree();});
+    benchmark.measure("rotate", type, width, height, "30.nearest", restore, [&]() {image.rotate(30, PolarTransformation::NearestNeighbour);});
+    benchmark.measure("rotate", type, width, height, "30.bilinear", restore, [&]() {image.rotate(30);});
+
+    // the result has circumference * radius pixels, the time is still related to the size of the input
+    Circle circle(Point(width / 2, height / 2), std::min(width, height) / 2 - 2);
+    benchmark.measure("doPolarTransformation", type, width, height, "nearest", restore, [&]() {image.doPolarTransformation(circle);});
+    benchmark.measure("doPolarTransformation", type, width, height, "bilinear", restore, [&]() {image.doPolarTransformation(circle, PolarTransformation::Bilinear);});
+
+    // rake of horizontal probes over the whole image, the random values yield many edges per probe
+    std::vector<EdgeProbe> probes = EdgeProbe::createRake(Line(Point(0, height / 2), Point(width - 1, height / 2)), height - 1, 256, 20, 3);
+    benchmark.measure("findEdges", type, width, height, "rake256", [](){}, [&]() {original.findEdges(probes);});
+  }
+
+  template<typename T>
+  void addFill(Benchmark& benchmark, const std::string& type, const Matrix<T>& original, Matrix<T>& image)
+  {
+    unsigned int width = original.getWidth();
+    unsigned int height = original.getHeight();
+
+    // random binary pattern -> many small holes and long background paths
+    Matrix<T> binary(original);
+    binary.binarize(getThreshold(original));
+    T background = binary.getMinimum();
+    T object = binary.getMaximum();
+
+    std::function<void()> restore = [&]() {image = binary;};
+    benchmark.measure("fillBackground", type, width, height, "neighborhood4", restore, [&]() {image.fillBackground(background, object);});
+    benchmark.measure("fillHoles", type, width, height, "neighborhood8", restore, [&]() {image.fillHoles(background, object, 0, true);});
+    benchmark.measure("getBlobs", type, width, height, "neighborhood8", [](){}, [&]() {binary.getBlobs(object, 0, true);});
+  }
+
+  // operations which are measured for all types
+  template<typename T>
+  void addAll(Benchmark& benchmark, const std::string& type, const Matrix<T>& original, Matrix<T>& image)
+  {
+    addMorphology(benchmark, type, original, image);
+    addPointOperations(benchmark, type, original, image);
+    addGeometry(benchmark, type, original, image);
+    addFill(benchmark, type, original, image);
+  }
+
+  void addUnsignedChar(Benchmark& benchmark, const Size& size)
+  {
+    std::string type = "uchar";
+    unsigned int width = size.m_width;
+    unsigned int height = size.m_height;
+
+    srand(1);
+    Matrix<unsigned char> original(width, height);
+    original.setRandomValues();
+    Matrix<unsigned char> image(original);
+    std::function<void()> restore = [&]() {image = original;};
+
+    addAll(benchmark, type, original, image);
+    addFilters(benchmark, type, original, image);
+
+    std::vector<unsigned char> lookUpTable(256);
+    for (unsigned int i = 0; i < lookUpTable.size(); i++)
+    {
+      lookUpTable[i] = static_cast<unsigned char>(255 - i);
+    }
+
+    benchmark.measure("applyLookUpTable", type, width, height, "", restore, [&]() {image.applyLookUpTable(lookUpTable);});
+    benchmark.measure("spread", type, width, height, "", restore, [&]() {image.spread();});
+    benchmark.measure("getHistogram", type, width, height, "", restore, [&]() {image.getHistogram(0);});
+
+    Matrix<unsigned char> color(width, height, 4);
+    color.setRandomValues();
+    std::vector<unsigned int> layerIndices;
+    layerIndices.push_back(2);
+    layerIndices.push_back(1);
+    layerIndices.push_back(0);
+    layerIndices.push_back(3);
+    std::vector<unsigned char> buffer(static_cast<size_t>(width) * height * 4);
+    benchmark.measure("getSingleLayer", type, width, height, "bgra", [](){}, [&]() {color.getSingleLayer(layerIndices, &buffer[0]);});
+
+    // the access patterns of Matrix::performanceTestAccessPixels
+    for (unsigned int mode = 0; mode <= 6; mode++)
+    {
+      benchmark.measure("performanceTestAccessPixels", type, width, height, toString(mode), [](){}, [&]() {image.performanceTestAccessPixels(mode);});
+    }
+  }
+
+  void addShort(Benchmark& benchmark, const Size& size)
+  {
+    std::string type = "short";
+
+    srand(1);
+    Matrix<short> original(size.m_width, size.m_height);
+    original.setRandomValues();
+
+    // the range of typical 12 bit images keeps the convolution inside the fast integer path
+    original.pointOperations().map([](short value) {return static_cast<short>(value & 0xfff);}).apply();
+    Matrix<short> image(original);
+    std::function<void()> restore = [&]() {image = original;};
+
+    addAll(benchmark, type, original, image);
+    addFilters(benchmark, type, original, image);
+
+    // signed 16 bit values are binned with an offset
+    benchmark.measure("spread", type, size.m_width, size.m_height, "", restore, [&]() {image.spread();});
+    benchmark.measure("getHistogram", type, size.m_width, size.m_height, "", restore, [&]() {image.getHistogram(0);});
+  }
+
+  void addFloat(Benchmark& benchmark, const Size& size)
+  {
+    std::string type = "float";
+
+    srand(1);
+    Matrix<float> original(size.m_width, size.m_height);
+    original.setRandomValues();
+    Matrix<float> image(original);
+
+    addAll(benchmark, type, original, image);
+    addFilters(benchmark, type, original, image);
+  }
+
+  void addBool(Benchmark& benchmark, const Size& size)
+  {
+    srand(1);
+    Matrix<bool> original(size.m_width, size.m_height);
+    original.setRandomValues();
+    Matrix<bool> image(original);
+
+    addAll(benchmark, "bool", original, image);
+  }
+
+  bool parseSizes(const std::string& text, std::vector<Size>& sizes)
+  {
+    sizes.clear();
+
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+      Size size;
+      if (sscanf(item.c_str(), "%ux%u", &size.m_width, &size.m_height) != 2 || size.m_width < 16 || size.m_height < 16)
+      {
+        return false;
+      }
+      sizes.push_back(size);
+    }
+
+    return !sizes.empty();
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  std::vector<Size> sizes;
+  parseSizes("512x512,2048x2048", sizes);
+
+  unsigned int qtyRepetitions = 5;
+  unsigned int qtyThreads = 0;
+  std::string filter;
+  std::string outputFileName;
+  std::string baselineFileName;
+  double tolerance = 0.1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string argument = argv[i];
+    bool hasValue = i + 1 < argc;
+
+    if (argument == "--sizes" && hasValue && parseSizes(argv[i + 1], sizes))
+    {
+      i++;
+    }
+    else if (argument == "--repetitions" && hasValue)
+    {
+      qtyRepetitions = static_cast<unsigned int>(atoi(argv[++i]));
+    }
+    else if (argument == "--threads" && hasValue)
+    {
+      qtyThreads = static_cast<unsigned int>(atoi(argv[++i]));
+    }
+    else if (argument == "--filter" && hasValue)
+    {
+      filter = argv[++i];
+    }
+    else if (argument == "--output" && hasValue)
+    {
+      outputFileName = argv[++i];
+    }
+    else if (argument == "--baseline" && hasValue)
+    {
+      baselineFileName = argv[++i];
+    }
+    else if (argument == "--tolerance" && hasValue)
+    {
+      tolerance = atof(argv[++i]);
+    }
+    else
+    {
+      std::cerr << "usage: " << argv[0] << " [--sizes 512x512,2048x2048] [--repetitions 5] [--threads 0] [--filter name]"
+                << " [--output results.csv] [--baseline baseline.csv] [--tolerance 0.1]" << std::endl;
+      return 2;
+    }
+  }
+
+  ThreadPool::getInstance().setQtyThreads(qtyThreads);
+
+  Benchmark benchmark(qtyRepetitions);
+  benchmark.setFilter(filter);
+
+  for (size_t i = 0; i < sizes.size(); i++)
+  {
+    addUnsignedChar(benchmark, sizes[i]);
+    addShort(benchmark, sizes[i]);
+    addFloat(benchmark, sizes[i]);
+    addBool(benchmark, sizes[i]);
+  }
+
+  if (outputFileName.empty())
+  {
+    benchmark.writeCsv(std::cout);
+  }
+  else
+  {
+    std::ofstream output(outputFileName.c_str());
+    benchmark.writeCsv(output);
+  }
+
+  if (baselineFileName.empty())
+  {
+    return 0;
+  }
+
+  std::vector<Benchmark::Result> baseline;
+  if (!Benchmark::readCsv(baselineFileName, baseline))
+  {
+    std::cerr << "baseline " << baselineFileName << " could not be read" << std::endl;
+    return 2;
+  }
+
+  return benchmark.compare(baseline, tolerance, std::cerr) > 0 ? 1 : 0;
+}
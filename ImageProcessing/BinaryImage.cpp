@@ -0,0 +1,542 @@
+#include <cstring>
+
+#include "BinaryImage.h"
+#include "Converter.h"
+#include "Matrix.h"
+#include "ThreadPool.h"
+
+const unsigned int BinaryImage::BitsPerWord;
+const unsigned int BinaryImage::MinimumQtyRowsPerTask;
+
+BinaryImage::BinaryImage() :
+  m_width(0),
+  m_height(0),
+  m_qtyWordsPerRow(0)
+{
+}
+
+BinaryImage::BinaryImage(unsigned int width, unsigned int height, bool value) :
+  m_width(width),
+  m_height(height),
+  m_qtyWordsPerRow((width + BitsPerWord - 1) / BitsPerWord),
+  m_words(static_cast<size_t>(m_qtyWordsPerRow) * height, value ? ~static_cast<uint64_t>(0) : 0)
+{
+  // the bits behind the width stay 0
+  if (value && width % BitsPerWord != 0)
+  {
+    uint64_t lastWord = (static_cast<uint64_t>(1) << (width % BitsPerWord)) - 1;
+    for (unsigned int y = 0; y < height; y++)
+    {
+      getRow(y)[m_qtyWordsPerRow - 1] = lastWord;
+    }
+  }
+}
+
+unsigned int BinaryImage::getWidth() const
+{
+  return m_width;
+}
+
+unsigned int BinaryImage::getHeight() const
+{
+  return m_height;
+}
+
+unsigned int BinaryImage::getQtyWordsPerRow() const
+{
+  return m_qtyWordsPerRow;
+}
+
+uint64_t* BinaryImage::getRow(unsigned int y)
+{
+  return &m_words[0] + static_cast<size_t>(y) * m_qtyWordsPerRow;
+}
+
+const uint64_t* BinaryImage::getRow(unsigned int y) const
+{
+  return &m_words[0] + static_cast<size_t>(y) * m_qtyWordsPerRow;
+}
+
+bool BinaryImage::getValue(unsigned int x, unsigned int y) const
+{
+  if (x >= m_width || y >= m_height)
+  {
+    return false;
+  }
+
+  return (getRow(y)[x / BitsPerWord] >> (x % BitsPerWord)) & 1;
+}
+
+void BinaryImage::setValue(bool value, unsigned int x, unsigned int y)
+{
+  if (x >= m_width || y >= m_height)
+  {
+    return;
+  }
+
+  uint64_t bit = static_cast<uint64_t>(1) << (x % BitsPerWord);
+  uint64_t& word = getRow(y)[x / BitsPerWord];
+  word = value ? word | bit : word & ~bit;
+}
+
+size_t BinaryImage::getQtySetPixels() const
+{
+  size_t qtySetPixels = 0;
+  for (size_t i = 0; i < m_words.size(); i++)
+  {
+    qtySetPixels += countBits(m_words[i]);
+  }
+
+  return qtySetPixels;
+}
+
+RunLengthCode BinaryImage::getRunLengthCode() const
+{
+  RunLengthCode runLengthCode;
+
+  // empty and full words are skipped at once, the start and the end of a run are found with count trailing zeros
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    const uint64_t* row = getRow(y);
+    unsigned int x = 0;
+
+    while (x < m_width)
+    {
+      uint64_t bits = row[x / BitsPerWord] >> (x % BitsPerWord);
+      if (bits == 0)
+      {
+        x = (x / BitsPerWord + 1) * BitsPerWord;
+        continue;
+      }
+
+      x += countTrailingZeros(bits);
+      unsigned int start = x;
+
+      // the bits behind the width are 0, so every run ends at the latest at the width
+      while (x < m_width)
+      {
+        uint64_t clearedBits = ~row[x / BitsPerWord] >> (x % BitsPerWord);
+        if (clearedBits == 0)
+        {
+          x = (x / BitsPerWord + 1) * BitsPerWord;
+          continue;
+        }
+
+        x += countTrailingZeros(clearedBits);
+        break;
+      }
+
+      x = std::min(x, m_width);
+      runLengthCode.add(RunLength(static_cast<int>(start), static_cast<int>(y), x - start));
+    }
+  }
+
+  return runLengthCode;
+}
+
+void BinaryImage::erode(const StructuringElement* structuringElement, unsigned int qtyThreads)
+{
+  applyMinMax(structuringElement, true, qtyThreads);
+}
+
+void BinaryImage::dilate(const StructuringElement* structuringElement, unsigned int qtyThreads)
+{
+  applyMinMax(structuringElement, false, qtyThreads);
+}
+
+void BinaryImage::open(const StructuringElement* structuringElement, unsigned int qtyThreads)
+{
+  erode(structuringElement, qtyThreads);
+  dilate(structuringElement, qtyThreads);
+}
+
+void BinaryImage::close(const StructuringElement* structuringElement, unsigned int qtyThreads)
+{
+  dilate(structuringElement, qtyThreads);
+  erode(structuringElement, qtyThreads);
+}
+
+void BinaryImage::filterMedian(const StructuringElement* structuringElement, unsigned int qtyThreads)
+{
+  filterQuantil(structuringElement, 0.5, qtyThreads);
+}
+
+void BinaryImage::applyMinMax(const StructuringElement* structuringElement, bool minimum, unsigned int qtyThreads)
+{
+  std::vector<Offset> offsets;
+  unsigned int offsetLeft, offsetTop, offsetRight, offsetBottom;
+  if (!getOffsets(structuringElement, offsets, offsetLeft, offsetTop, offsetRight, offsetBottom))
+  {
+    return;
+  }
+
+  unsigned int qtyWords = m_qtyWordsPerRow;
+
+  // every run length of the structuring element is applied once to all rows:
+  // pixel x of the reduced row = and / or of the pixels x ... x + length - 1, computed with log2(length) shifts
+  std::vector<unsigned int> lengths;
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    if (std::find(lengths.begin(), lengths.end(), offsets[i].m_length) == lengths.end())
+    {
+      lengths.push_back(offsets[i].m_length);
+    }
+  }
+
+  std::vector<size_t> lengthIndices(offsets.size());
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    lengthIndices[i] = std::find(lengths.begin(), lengths.end(), offsets[i].m_length) - lengths.begin();
+  }
+
+  std::vector<std::vector<uint64_t> > reducedRows(lengths.size());
+  for (size_t i = 0; i < lengths.size(); i++)
+  {
+    std::vector<uint64_t>& reduced = reducedRows[i];
+    unsigned int length = lengths[i];
+
+    if (length == 1)
+    {
+      continue; // the rows of the image are used
+    }
+
+    reduced.resize(m_words.size());
+
+    runRows(0, m_height, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow)
+    {
+      std::vector<uint64_t> shifted(qtyWords);
+
+      for (unsigned int y = firstRow; y < lastRow; y++)
+      {
+        uint64_t* row = &reduced[static_cast<size_t>(y) * qtyWords];
+        std::copy(getRow(y), getRow(y) + qtyWords, row);
+
+        unsigned int covered = 1;
+        while (covered < length)
+        {
+          unsigned int step = std::min(covered, length - covered);
+          shift(row, qtyWords, static_cast<int>(step), &shifted[0]);
+
+          for (unsigned int j = 0; j < qtyWords; j++)
+          {
+            row[j] = minimum ? row[j] & shifted[j] : row[j] | shifted[j];
+          }
+
+          covered += step;
+        }
+      }
+    });
+  }
+
+  std::vector<uint64_t> result(m_words.size());
+
+  // out(x, y) = and / or of the reduced rows in(x + offset.x, y + offset.y) of all runs
+  runRows(offsetTop, m_height - offsetBottom, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow)
+  {
+    std::vector<uint64_t> shifted(qtyWords);
+
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      uint64_t* destination = &result[static_cast<size_t>(y) * qtyWords];
+      std::fill(destination, destination + qtyWords, minimum ? ~static_cast<uint64_t>(0) : 0);
+
+      for (size_t i = 0; i < offsets.size(); i++)
+      {
+        const Offset& offset = offsets[i];
+        unsigned int sourceY = static_cast<unsigned int>(static_cast<int>(y) + offset.m_y);
+        const uint64_t* source = offset.m_length == 1 ? getRow(sourceY) : &reducedRows[lengthIndices[i]][static_cast<size_t>(sourceY) * qtyWords];
+
+        shift(source, qtyWords, offset.m_x, &shifted[0]);
+
+        for (unsigned int j = 0; j < qtyWords; j++)
+        {
+          destination[j] = minimum ? destination[j] & shifted[j] : destination[j] | shifted[j];
+        }
+      }
+    }
+  });
+
+  writeInterior(result, offsetLeft, offsetTop, offsetRight, offsetBottom);
+}
+
+void BinaryImage::filterQuantil(const StructuringElement* structuringElement, double quantil, unsigned int qtyThreads)
+{
+  std::vector<Offset> offsets;
+  unsigned int offsetLeft, offsetTop, offsetRight, offsetBottom;
+  if (!getOffsets(structuringElement, offsets, offsetLeft, offsetTop, offsetRight, offsetBottom))
+  {
+    return;
+  }
+
+  unsigned int sumOfSetValues = 0;
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    sumOfSetValues += offsets[i].m_length;
+  }
+
+  // same threshold as Matrix<bool>::filterQuantil
+  unsigned int threshold = quantil * sumOfSetValues;
+  if (threshold > sumOfSetValues - 1)
+  {
+    threshold = sumOfSetValues - 1;
+  }
+
+  unsigned int qtyCounterBits = 1;
+  while ((static_cast<unsigned long long>(1) << qtyCounterBits) <= sumOfSetValues)
+  {
+    qtyCounterBits++;
+  }
+
+  unsigned int qtyWords = m_qtyWordsPerRow;
+  std::vector<uint64_t> result(m_words.size());
+
+  runRows(offsetTop, m_height - offsetBottom, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow)
+  {
+    // bit b of the counter of pixel x is bit x of counters[b]
+    std::vector<uint64_t> counters(static_cast<size_t>(qtyCounterBits) * qtyWords);
+    std::vector<uint64_t> shifted(qtyWords);
+
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      std::fill(counters.begin(), counters.end(), 0);
+
+      for (size_t i = 0; i < offsets.size(); i++)
+      {
+        const Offset& offset = offsets[i];
+        const uint64_t* source = getRow(static_cast<unsigned int>(static_cast<int>(y) + offset.m_y));
+
+        for (unsigned int k = 0; k < offset.m_length; k++)
+        {
+          shift(source, qtyWords, offset.m_x + static_cast<int>(k), &shifted[0]);
+
+          // ripple carry adder of 64 counters
+          for (unsigned int j = 0; j < qtyWords; j++)
+          {
+            uint64_t carry = shifted[j];
+            for (unsigned int b = 0; b < qtyCounterBits && carry != 0; b++)
+            {
+              uint64_t& counter = counters[static_cast<size_t>(b) * qtyWords + j];
+              uint64_t nextCarry = counter & carry;
+              counter ^= carry;
+              carry = nextCarry;
+            }
+          }
+        }
+      }
+
+      // counter > threshold, compared from the most significant bit
+      uint64_t* destination = &result[static_cast<size_t>(y) * qtyWords];
+      for (unsigned int j = 0; j < qtyWords; j++)
+      {
+        uint64_t greater = 0;
+        uint64_t equal = ~static_cast<uint64_t>(0);
+
+        for (unsigned int b = qtyCounterBits; b-- > 0; )
+        {
+          uint64_t counter = counters[static_cast<size_t>(b) * qtyWords + j];
+          if ((threshold >> b) & 1)
+          {
+            equal &= counter;
+          }
+          else
+          {
+            greater |= equal & counter;
+            equal &= ~counter;
+          }
+        }
+
+        destination[j] = greater;
+      }
+    }
+  });
+
+  writeInterior(result, offsetLeft, offsetTop, offsetRight, offsetBottom);
+}
+
+bool BinaryImage::getOffsets(const StructuringElement* structuringElement, std::vector<Offset>& offsets, unsigned int& offsetLeft, unsigned int& offsetTop,
+                             unsigned int& offsetRight, unsigned int& offsetBottom) const
+{
+  if (m_width < structuringElement->getWidth() || m_height < structuringElement->getHeight())
+  {
+    return false;
+  }
+
+  offsetLeft = Converter::toUInt(structuringElement->getReferencePoint().m_x);
+  offsetTop = Converter::toUInt(structuringElement->getReferencePoint().m_y);
+  offsetRight = structuringElement->getWidth() - offsetLeft - 1;
+  offsetBottom = structuringElement->getHeight() - offsetTop - 1;
+
+  RunLengthCode runLengthCode = structuringElement->getRunLengthCode(true);
+  for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
+  {
+    Offset offset;
+    offset.m_x = it->m_x - static_cast<int>(offsetLeft);
+    offset.m_y = it->m_y - static_cast<int>(offsetTop);
+    offset.m_length = it->m_length;
+    offsets.push_back(offset);
+  }
+
+  return !offsets.empty();
+}
+
+void BinaryImage::writeInterior(const std::vector<uint64_t>& result, unsigned int offsetLeft, unsigned int offsetTop, unsigned int offsetRight, unsigned int offsetBottom)
+{
+  std::vector<uint64_t> mask(m_qtyWordsPerRow, 0);
+  for (unsigned int x = offsetLeft; x < m_width - offsetRight; x++)
+  {
+    mask[x / BitsPerWord] |= static_cast<uint64_t>(1) << (x % BitsPerWord);
+  }
+
+  for (unsigned int y = offsetTop; y < m_height - offsetBottom; y++)
+  {
+    uint64_t* row = getRow(y);
+    const uint64_t* source = &result[static_cast<size_t>(y) * m_qtyWordsPerRow];
+
+    for (unsigned int j = 0; j < m_qtyWordsPerRow; j++)
+    {
+      row[j] = (source[j] & mask[j]) | (row[j] & ~mask[j]);
+    }
+  }
+}
+
+template<typename Task>
+void BinaryImage::runRows(unsigned int firstRow, unsigned int lastRow, unsigned int qtyThreads, const Task& task)
+{
+  if (lastRow <= firstRow)
+  {
+    return;
+  }
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int qtyRows = lastRow - firstRow;
+  unsigned int qtyTasks = std::max(1u, std::min(qtyThreads, qtyRows / MinimumQtyRowsPerTask));
+
+  threadPool.run(qtyTasks, [&](unsigned int index)
+  {
+    unsigned int first = firstRow + static_cast<unsigned int>(static_cast<unsigned long long>(qtyRows) * index / qtyTasks);
+    unsigned int last = firstRow + static_cast<unsigned int>(static_cast<unsigned long long>(qtyRows) * (index + 1) / qtyTasks);
+    task(first, last);
+  }, qtyThreads);
+}
+
+uint64_t BinaryImage::packWord(const bool* source, unsigned int qtyBits, bool threshold)
+{
+  if (!threshold || qtyBits < BitsPerWord || sizeof(bool) != 1)
+  {
+    return packWord<bool>(source, qtyBits, threshold);
+  }
+
+  // 8 bytes of 0 or 1 -> the multiplication moves byte i to bit 56 + i, no two products overlap (little endian)
+  uint64_t bits = 0;
+  for (unsigned int i = 0; i < BitsPerWord; i += 8)
+  {
+    uint64_t bytes;
+    memcpy(&bytes, source + i, sizeof(bytes));
+    bits |= ((bytes * 0x0102040810204080ULL) >> 56) << i;
+  }
+
+  return bits;
+}
+
+void BinaryImage::unpackWord(uint64_t bits, bool* destination, unsigned int qtyBits, bool falseValue, bool trueValue)
+{
+  if (falseValue || !trueValue || qtyBits < BitsPerWord || sizeof(bool) != 1)
+  {
+    unpackWord<bool>(bits, destination, qtyBits, falseValue, trueValue);
+    return;
+  }
+
+  // 8 pixels of every byte of the word at once
+  static const std::vector<uint64_t> bytesOfBits = []()
+  {
+    std::vector<uint64_t> table(256);
+    for (unsigned int value = 0; value < 256; value++)
+    {
+      unsigned char bytes[8];
+      for (unsigned int i = 0; i < 8; i++)
+      {
+        bytes[i] = (value >> i) & 1;
+      }
+      memcpy(&table[value], bytes, sizeof(bytes));
+    }
+    return table;
+  }();
+
+  for (unsigned int i = 0; i < BitsPerWord; i += 8)
+  {
+    memcpy(destination + i, &bytesOfBits[(bits >> i) & 0xff], 8);
+  }
+}
+
+void BinaryImage::shift(const uint64_t* source, unsigned int qtyWords, int offset, uint64_t* destination)
+{
+  unsigned int distance = static_cast<unsigned int>(offset < 0 ? -offset : offset);
+  unsigned int wordShift = distance / BitsPerWord;
+  unsigned int bitShift = distance % BitsPerWord;
+
+  if (offset >= 0)
+  {
+    // pixel x comes from the higher pixel x + offset -> shift to the lower bits
+    for (unsigned int j = 0; j < qtyWords; j++)
+    {
+      uint64_t word = 0;
+      if (j + wordShift < qtyWords)
+      {
+        word = source[j + wordShift] >> bitShift;
+        if (bitShift != 0 && j + wordShift + 1 < qtyWords)
+        {
+          word |= source[j + wordShift + 1] << (BitsPerWord - bitShift);
+        }
+      }
+      destination[j] = word;
+    }
+  }
+  else
+  {
+    for (unsigned int j = 0; j < qtyWords; j++)
+    {
+      uint64_t word = 0;
+      if (j >= wordShift)
+      {
+        word = source[j - wordShift] << bitShift;
+        if (bitShift != 0 && j >= wordShift + 1)
+        {
+          word |= source[j - wordShift - 1] >> (BitsPerWord - bitShift);
+        }
+      }
+      destination[j] = word;
+    }
+  }
+}
+
+unsigned int BinaryImage::countBits(uint64_t word)
+{
+#if defined(__GNUC__)
+  return static_cast<unsigned int>(__builtin_popcountll(word));
+#else
+  word = word - ((word >> 1) & 0x5555555555555555ULL);
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return static_cast<unsigned int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+unsigned int BinaryImage::countTrailingZeros(uint64_t word)
+{
+#if defined(__GNUC__)
+  return static_cast<unsigned int>(__builtin_ctzll(word));
+#else
+  unsigned int qtyZeros = 0;
+  while ((word & 1) == 0)
+  {
+    word >>= 1;
+    qtyZeros++;
+  }
+  return qtyZeros;
+#endif
+}
@@ -0,0 +1,162 @@
+#ifndef BINARYIMAGE_H
+#define BINARYIMAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "MatrixView.h"
+#include "RunLengthCode.h"
+
+class StructuringElement;
+
+// binary image with one bit per pixel, every row is a sequence of 64 bit words
+// bit i of word j of a row is the pixel x = 64 * j + i, the bits behind the width are always 0
+// the neighbourhood operators work on whole words (shift, and, or), so 64 pixels cost a few instructions
+// they follow the contract of Matrix<bool>: only the pixels which are fully covered by the structuring element are written
+class BinaryImage
+{
+public:
+  BinaryImage();
+  BinaryImage(unsigned int width, unsigned int height, bool value = false);
+
+  // pixel = value >= threshold, the same as Matrix::binarize -> BinaryImage(view, true) packs a Matrix<bool>
+  template<typename T>
+  BinaryImage(const MatrixView<const T>& view, T threshold);
+
+  // writes trueValue for set and falseValue for cleared pixels, the view must have the size of the image
+  template<typename T>
+  void copyTo(const MatrixView<T>& view, T falseValue = std::numeric_limits<T>::min(), T trueValue = std::numeric_limits<T>::max()) const;
+
+  unsigned int getWidth() const;
+  unsigned int getHeight() const;
+  unsigned int getQtyWordsPerRow() const;
+
+  uint64_t* getRow(unsigned int y);
+  const uint64_t* getRow(unsigned int y) const;
+
+  bool getValue(unsigned int x, unsigned int y) const;
+  void setValue(bool value, unsigned int x, unsigned int y);
+
+  size_t getQtySetPixels() const;
+  RunLengthCode getRunLengthCode() const;
+
+  void erode(const StructuringElement* structuringElement, unsigned int qtyThreads = 0);
+  void dilate(const StructuringElement* structuringElement, unsigned int qtyThreads = 0);
+  void open(const StructuringElement* structuringElement, unsigned int qtyThreads = 0);
+  void close(const StructuringElement* structuringElement, unsigned int qtyThreads = 0);
+
+  // pixel = number of set pixels under the structuring element > quantil * size of the structuring element
+  // the pixels are counted with bit sliced counters, so 64 pixels are counted at once
+  void filterQuantil(const StructuringElement* structuringElement, double quantil, unsigned int qtyThreads = 0);
+  void filterMedian(const StructuringElement* structuringElement, unsigned int qtyThreads = 0);
+
+private:
+  // run of the structuring element relative to its reference point
+  class Offset
+  {
+  public:
+    int m_x;
+    int m_y;
+    unsigned int m_length;
+  };
+
+  void applyMinMax(const StructuringElement* structuringElement, bool minimum, unsigned int qtyThreads);
+  bool getOffsets(const StructuringElement* structuringElement, std::vector<Offset>& offsets, unsigned int& offsetLeft, unsigned int& offsetTop,
+                  unsigned int& offsetRight, unsigned int& offsetBottom) const;
+
+  // rows of the interior: result for the columns offsetLeft ... width - offsetRight - 1, the original value for all other columns
+  void writeInterior(const std::vector<uint64_t>& result, unsigned int offsetLeft, unsigned int offsetTop, unsigned int offsetRight, unsigned int offsetBottom);
+
+  // calls task(firstRow, lastRow) for bands of the rows firstRow ... lastRow - 1 on the ThreadPool
+  template<typename Task>
+  static void runRows(unsigned int firstRow, unsigned int lastRow, unsigned int qtyThreads, const Task& task);
+
+  // bit i = source[i] >= threshold, Matrix<bool> is packed 8 pixels at once
+  template<typename T>
+  static uint64_t packWord(const T* source, unsigned int qtyBits, T threshold);
+  static uint64_t packWord(const bool* source, unsigned int qtyBits, bool threshold);
+
+  template<typename T>
+  static void unpackWord(uint64_t bits, T* destination, unsigned int qtyBits, T falseValue, T trueValue);
+  static void unpackWord(uint64_t bits, bool* destination, unsigned int qtyBits, bool falseValue, bool trueValue);
+
+  // destination[x] = source[x + offset], pixels outside of the row are 0
+  static void shift(const uint64_t* source, unsigned int qtyWords, int offset, uint64_t* destination);
+  static unsigned int countBits(uint64_t word);
+  static unsigned int countTrailingZeros(uint64_t word); // word must not be 0
+
+  static const unsigned int BitsPerWord = 64;
+  static const unsigned int MinimumQtyRowsPerTask = 16;
+
+  unsigned int m_width;
+  unsigned int m_height;
+  unsigned int m_qtyWordsPerRow;
+  std::vector<uint64_t> m_words;
+};
+
+template<typename T>
+BinaryImage::BinaryImage(const MatrixView<const T>& view, T threshold) :
+  m_width(view.getWidth()),
+  m_height(view.getHeight()),
+  m_qtyWordsPerRow((view.getWidth() + BitsPerWord - 1) / BitsPerWord),
+  m_words(static_cast<size_t>(m_qtyWordsPerRow) * view.getHeight(), 0)
+{
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    const T* source = view.getRow(y);
+    uint64_t* destination = getRow(y);
+
+    for (unsigned int word = 0; word < m_qtyWordsPerRow; word++)
+    {
+      unsigned int first = word * BitsPerWord;
+      destination[word] = packWord(source + first, std::min(BitsPerWord, m_width - first), threshold);
+    }
+  }
+}
+
+template<typename T>
+void BinaryImage::copyTo(const MatrixView<T>& view, T falseValue, T trueValue) const
+{
+  if (view.getWidth() != m_width || view.getHeight() != m_height)
+  {
+    return;
+  }
+
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    const uint64_t* source = getRow(y);
+    T* destination = view.getRow(y);
+
+    for (unsigned int word = 0; word < m_qtyWordsPerRow; word++)
+    {
+      unsigned int first = word * BitsPerWord;
+      unpackWord(source[word], destination + first, std::min(BitsPerWord, m_width - first), falseValue, trueValue);
+    }
+  }
+}
+
+template<typename T>
+uint64_t BinaryImage::packWord(const T* source, unsigned int qtyBits, T threshold)
+{
+  uint64_t bits = 0;
+  for (unsigned int i = 0; i < qtyBits; i++)
+  {
+    bits |= static_cast<uint64_t>(!(source[i] < threshold)) << i;
+  }
+
+  return bits;
+}
+
+template<typename T>
+void BinaryImage::unpackWord(uint64_t bits, T* destination, unsigned int qtyBits, T falseValue, T trueValue)
+{
+  for (unsigned int i = 0; i < qtyBits; i++)
+  {
+    destination[i] = (bits >> i) & 1 ? trueValue : falseValue;
+  }
+}
+
+#endif // BINARYIMAGE_H
@@ -0,0 +1,25 @@
+#ifndef BLOB_H
+#define BLOB_H
+
+#include <cstddef>
+
+#include "Point.h"
+#include "Rectangle.h"
+#include "RunLengthCode.h"
+#include "Statistics.h"
+
+// connected component of a labeled image, see Labeling
+template<typename T>
+class Blob
+{
+public:
+  Blob() : m_area(0) {}
+
+  RunLengthCode m_runLengthCode;
+  size_t m_area; // number of pixels
+  Rectangle m_boundingRectangle; // axis-parallel, width and height in pixels
+  Point m_centroid;
+  Statistics<T> m_statistics; // of the measured values under the blob
+};
+
+#endif // BLOB_H
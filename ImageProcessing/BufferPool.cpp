@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "BufferPool.h"
+#include "MemoryHelper.h"
+
+namespace
+{
+  const size_t HeaderSize = CacheLineSize; // the class size is stored directly in front of the buffer, the buffer stays aligned
+  const size_t MinimumClassSize = CacheLineSize;
+  const size_t MaximumThreadCacheSize = 1 << 20; // bigger buffers always go to the shared free lists
+  const unsigned int QtyThreadCacheBuffers = 8;
+  const size_t DefaultCapacity = static_cast<size_t>(1) << 30;
+
+  class SharedPool
+  {
+  public:
+    SharedPool() :
+      m_capacity(DefaultCapacity),
+      m_qtyHits(0),
+      m_qtyMisses(0),
+      m_bytesInUse(0),
+      m_peakBytesInUse(0),
+      m_bytesCached(0)
+    {
+    }
+
+    std::mutex m_mutex;
+    std::map<size_t, std::vector<void*> > m_freeBuffers; // key: class size
+
+    std::atomic<size_t> m_capacity;
+    std::atomic<unsigned long long> m_qtyHits;
+    std::atomic<unsigned long long> m_qtyMisses;
+    std::atomic<size_t> m_bytesInUse;
+    std::atomic<size_t> m_peakBytesInUse;
+    std::atomic<size_t> m_bytesCached;
+  };
+
+  // never destroyed, so threads which end during the destruction of static objects (e. g. the ThreadPool) can still release their buffers
+  SharedPool& getSharedPool()
+  {
+    static SharedPool* pool = new SharedPool();
+    return *pool;
+  }
+
+  // 4 classes per power of two -> at most 25 % of a buffer are unused
+  size_t getClassSize(size_t size)
+  {
+    if (size <= MinimumClassSize)
+    {
+      return MinimumClassSize;
+    }
+
+    size_t power = MinimumClassSize;
+    while (power <= size / 2)
+    {
+      power *= 2;
+    }
+
+    return MemoryHelper::roundUp(size, std::max(power / 4, MinimumClassSize));
+  }
+
+  size_t& getClassSizeOf(void* buffer)
+  {
+    return reinterpret_cast<size_t*>(buffer)[-1];
+  }
+
+  void* allocateNew(size_t classSize)
+  {
+    unsigned char* buffer = static_cast<unsigned char*>(MemoryHelper::allocateAligned(classSize + HeaderSize)) + HeaderSize;
+    getClassSizeOf(buffer) = classSize;
+    return buffer;
+  }
+
+  void freeBuffer(void* buffer)
+  {
+    MemoryHelper::freeAligned(static_cast<unsigned char*>(buffer) - HeaderSize);
+  }
+
+  void pushShared(SharedPool& pool, void* buffer)
+  {
+    std::lock_guard<std::mutex> lock(pool.m_mutex);
+    pool.m_freeBuffers[getClassSizeOf(buffer)].push_back(buffer);
+  }
+
+  // buffers of static objects may be released after the cache of the main thread is destroyed -> they go to the shared free lists
+  thread_local bool isThreadCacheDestroyed = false;
+
+  // small buffers released by this thread, the most recently released buffer last
+  class ThreadCache
+  {
+  public:
+    ~ThreadCache()
+    {
+      SharedPool& pool = getSharedPool();
+      for (size_t i = 0; i < m_buffers.size(); i++)
+      {
+        pushShared(pool, m_buffers[i]);
+      }
+
+      isThreadCacheDestroyed = true;
+    }
+
+    std::vector<void*> m_buffers;
+  };
+
+  thread_local ThreadCache threadCache;
+}
+
+void* BufferPool::allocate(size_t size)
+{
+  SharedPool& pool = getSharedPool();
+  size_t classSize = getClassSize(size);
+  void* buffer = 0;
+
+  if (classSize <= MaximumThreadCacheSize && !isThreadCacheDestroyed)
+  {
+    std::vector<void*>& buffers = threadCache.m_buffers;
+    for (size_t i = buffers.size(); i > 0; i--)
+    {
+      if (getClassSizeOf(buffers[i - 1]) == classSize)
+      {
+        buffer = buffers[i - 1];
+        buffers.erase(buffers.begin() + (i - 1));
+        break;
+      }
+    }
+  }
+
+  if (buffer == 0)
+  {
+    std::lock_guard<std::mutex> lock(pool.m_mutex);
+    std::map<size_t, std::vector<void*> >::iterator it = pool.m_freeBuffers.find(classSize);
+    if (it != pool.m_freeBuffers.end() && !it->second.empty())
+    {
+      buffer = it->second.back();
+      it->second.pop_back();
+    }
+  }
+
+  if (buffer != 0)
+  {
+    pool.m_qtyHits++;
+    pool.m_bytesCached -= classSize;
+  }
+  else
+  {
+    pool.m_qtyMisses++;
+    buffer = allocateNew(classSize);
+  }
+
+  size_t bytesInUse = pool.m_bytesInUse += classSize;
+  size_t peak = pool.m_peakBytesInUse;
+  while (peak < bytesInUse && !pool.m_peakBytesInUse.compare_exchange_weak(peak, bytesInUse))
+  {
+  }
+
+  return buffer;
+}
+
+void BufferPool::release(void* buffer)
+{
+  if (buffer == 0)
+  {
+    return;
+  }
+
+  SharedPool& pool = getSharedPool();
+  size_t classSize = getClassSizeOf(buffer);
+  pool.m_bytesInUse -= classSize;
+
+  // the check is not exact, if several threads release at the same time, the capacity may be exceeded by a few buffers
+  if (pool.m_bytesCached + classSize > pool.m_capacity)
+  {
+    freeBuffer(buffer);
+    return;
+  }
+
+  pool.m_bytesCached += classSize;
+
+  if (classSize <= MaximumThreadCacheSize && !isThreadCacheDestroyed && threadCache.m_buffers.size() < QtyThreadCacheBuffers)
+  {
+    threadCache.m_buffers.push_back(buffer);
+    return;
+  }
+
+  pushShared(pool, buffer);
+}
+
+size_t BufferPool::getCapacity()
+{
+  return getSharedPool().m_capacity;
+}
+
+void BufferPool::setCapacity(size_t capacity)
+{
+  getSharedPool().m_capacity = capacity;
+
+  if (getSharedPool().m_bytesCached > capacity)
+  {
+    trim();
+  }
+}
+
+void BufferPool::trim()
+{
+  SharedPool& pool = getSharedPool();
+
+  if (!isThreadCacheDestroyed)
+  {
+    std::vector<void*>& buffers = threadCache.m_buffers;
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      pool.m_bytesCached -= getClassSizeOf(buffers[i]);
+      freeBuffer(buffers[i]);
+    }
+    buffers.clear();
+  }
+
+  std::lock_guard<std::mutex> lock(pool.m_mutex);
+  for (std::map<size_t, std::vector<void*> >::iterator it = pool.m_freeBuffers.begin(); it != pool.m_freeBuffers.end(); ++it)
+  {
+    for (size_t i = 0; i < it->second.size(); i++)
+    {
+      pool.m_bytesCached -= it->first;
+      freeBuffer(it->second[i]);
+    }
+  }
+  pool.m_freeBuffers.clear();
+}
+
+BufferPool::Usage BufferPool::getUsage()
+{
+  SharedPool& pool = getSharedPool();
+
+  Usage usage;
+  usage.m_qtyHits = pool.m_qtyHits;
+  usage.m_qtyMisses = pool.m_qtyMisses;
+  usage.m_bytesInUse = pool.m_bytesInUse;
+  usage.m_peakBytesInUse = pool.m_peakBytesInUse;
+  usage.m_bytesCached = pool.m_bytesCached;
+
+  return usage;
+}
+
+void BufferPool::resetUsage()
+{
+  SharedPool& pool = getSharedPool();
+
+  pool.m_qtyHits = 0;
+  pool.m_qtyMisses = 0;
+  pool.m_peakBytesInUse = pool.m_bytesInUse.load();
+}
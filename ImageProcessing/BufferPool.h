@@ -0,0 +1,39 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <cstddef>
+
+// aligned buffers (CacheLineSize), which are reused instead of being freed
+// the sizes are rounded up to size classes (4 classes per power of two), a released buffer is kept in a free list of its class
+// small buffers are kept in a cache of the releasing thread first, so the temporaries of the tasks of the ThreadPool need no lock
+// -> the layers and temporaries of Matrix of a steady processing loop come from the pool and are already mapped by the operating system
+// the buffers are not initialized, a pool keeps at most getCapacity() bytes of free buffers
+class BufferPool
+{
+public:
+  class Usage
+  {
+  public:
+    unsigned long long m_qtyHits; // allocations which reused a buffer
+    unsigned long long m_qtyMisses; // allocations which needed new memory
+    size_t m_bytesInUse;
+    size_t m_peakBytesInUse;
+    size_t m_bytesCached; // free buffers in the pool and in the caches of the threads
+  };
+
+  static void* allocate(size_t size);
+  static void release(void* buffer); // only buffers of allocate(), 0 is ignored
+
+  static size_t getCapacity();
+  static void setCapacity(size_t capacity); // bytes of free buffers, 0 -> every buffer is freed on release
+
+  static void trim(); // frees the free buffers of the pool and of the cache of the calling thread
+
+  static Usage getUsage();
+  static void resetUsage(); // counters to 0, peak to the bytes in use
+
+private:
+  BufferPool();
+};
+
+#endif // BUFFERPOOL_H
@@ -0,0 +1,318 @@
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "Convolution.h"
+
+ConvolutionKernel::ConvolutionKernel()
+{
+  m_width = 0;
+  m_height = 0;
+  m_offsetLeft = 0;
+  m_offsetTop = 0;
+  m_preFactor = 1.0;
+  m_shiftResultValues = false;
+  m_invertNegativeResultValues = false;
+}
+
+bool ConvolutionKernel::isSeparable() const
+{
+  return m_horizontalCoefficients.size() == m_width && m_verticalCoefficients.size() == m_height && m_width > 0 && m_height > 0;
+}
+
+bool ConvolutionKernel::isBox() const
+{
+  if (!isSeparable())
+  {
+    return false;
+  }
+
+  for (unsigned int x = 0; x < m_width; x++)
+  {
+    if (m_horizontalCoefficients[x] != 1)
+    {
+      return false;
+    }
+  }
+
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    if (m_verticalCoefficients[y] != 1)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ConvolutionKernel::setSeparableCoefficients(const std::vector<int>& horizontal, const std::vector<int>& vertical)
+{
+  if (horizontal.size() != m_width || vertical.size() != m_height || m_values.size() != m_width * m_height)
+  {
+    return;
+  }
+
+  // the values of big filters are stored as short and may be truncated, the coefficients are the exact ones
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+      if (static_cast<short>(horizontal[x] * vertical[y]) != m_values[y * m_width + x])
+      {
+        return;
+      }
+    }
+  }
+
+  m_horizontalCoefficients = horizontal;
+  m_verticalCoefficients = vertical;
+}
+
+void ConvolutionKernel::findSeparableCoefficients()
+{
+  m_horizontalCoefficients.clear();
+  m_verticalCoefficients.clear();
+
+  if (m_width == 0 || m_height == 0 || m_values.size() != m_width * m_height)
+  {
+    return;
+  }
+
+  // a separable kernel has rank 1: every row is a multiple of the first row which is not zero
+  const int* firstRow = 0;
+  for (unsigned int y = 0; y < m_height && firstRow == 0; y++)
+  {
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+      if (m_values[y * m_width + x] != 0)
+      {
+        firstRow = &m_values[y * m_width];
+        break;
+      }
+    }
+  }
+
+  if (firstRow == 0)
+  {
+    return;
+  }
+
+  int divisor = 0;
+  int firstNonZero = -1;
+  for (unsigned int x = 0; x < m_width; x++)
+  {
+    int a = std::abs(firstRow[x]);
+    int b = divisor;
+    while (b != 0)
+    {
+      int remainder = a % b;
+      a = b;
+      b = remainder;
+    }
+    divisor = a;
+
+    if (firstNonZero < 0 && firstRow[x] != 0)
+    {
+      firstNonZero = x;
+    }
+  }
+
+  if (firstRow[firstNonZero] < 0)
+  {
+    divisor *= -1;
+  }
+
+  std::vector<int> horizontal(m_width);
+  for (unsigned int x = 0; x < m_width; x++)
+  {
+    horizontal[x] = firstRow[x] / divisor;
+  }
+
+  std::vector<int> vertical(m_height);
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    const int* row = &m_values[y * m_width];
+
+    if (row[firstNonZero] % horizontal[firstNonZero] != 0)
+    {
+      return;
+    }
+    vertical[y] = row[firstNonZero] / horizontal[firstNonZero];
+
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+      if (horizontal[x] * vertical[y] != row[x])
+      {
+        return;
+      }
+    }
+  }
+
+  m_horizontalCoefficients = horizontal;
+  m_verticalCoefficients = vertical;
+}
+
+double ConvolutionKernel::getSumOfAbsoluteValues() const
+{
+  return sumOfAbsoluteValues(m_values);
+}
+
+double ConvolutionKernel::getSumOfAbsoluteHorizontalCoefficients() const
+{
+  return sumOfAbsoluteValues(m_horizontalCoefficients);
+}
+
+double ConvolutionKernel::getSumOfAbsoluteVerticalCoefficients() const
+{
+  return sumOfAbsoluteValues(m_verticalCoefficients);
+}
+
+double ConvolutionKernel::sumOfAbsoluteValues(const std::vector<int>& values)
+{
+  double sum = 0;
+
+  for (std::vector<int>::const_iterator it = values.begin(); it != values.end(); ++it)
+  {
+    sum += std::abs(*it);
+  }
+
+  return sum;
+}
+
+void ConvolutionRows::horizontal(const unsigned char* source, int* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients)
+{
+  unsigned int x = 0;
+
+#if defined(__AVX2__) || defined(__SSE4_1__) || defined(__SSE2__) || defined(_M_X64)
+  bool coefficientsFitInShort = true;
+  for (unsigned int k = 0; k < qtyCoefficients; k++)
+  {
+    if (coefficients[k] < std::numeric_limits<short>::min() || coefficients[k] > std::numeric_limits<short>::max())
+    {
+      coefficientsFitInShort = false;
+    }
+  }
+
+  if (coefficientsFitInShort)
+  {
+    // two taps are processed at once: the source values of x + k and x + k + 1 are interleaved and multiplied with madd
+    // the last pair of an odd number of taps reads one value more than needed, so the vector loop stops early enough
+#if defined(__AVX2__)
+    for (; x + 17 <= width; x += 16)
+    {
+      __m256i sumLow = _mm256_setzero_si256();
+      __m256i sumHigh = _mm256_setzero_si256();
+
+      for (unsigned int k = 0; k < qtyCoefficients; k += 2)
+      {
+        int second = k + 1 < qtyCoefficients ? coefficients[k + 1] : 0;
+        __m256i pair = _mm256_set1_epi32(static_cast<int>((static_cast<unsigned int>(second) << 16) | (static_cast<unsigned int>(coefficients[k]) & 0xFFFF)));
+
+        __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x + k)));
+        __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x + k + 1)));
+
+        sumLow = _mm256_add_epi32(sumLow, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), pair));
+        sumHigh = _mm256_add_epi32(sumHigh, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), pair));
+      }
+
+      // unpack works per 128 bit lane: sumLow holds x 0-3 and 8-11, sumHigh holds x 4-7 and 12-15
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x), _mm256_permute2x128_si256(sumLow, sumHigh, 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x + 8), _mm256_permute2x128_si256(sumLow, sumHigh, 0x31));
+    }
+#else
+    __m128i zero = _mm_setzero_si128();
+
+    for (; x + 9 <= width; x += 8)
+    {
+      __m128i sumLow = _mm_setzero_si128();
+      __m128i sumHigh = _mm_setzero_si128();
+
+      for (unsigned int k = 0; k < qtyCoefficients; k += 2)
+      {
+        int second = k + 1 < qtyCoefficients ? coefficients[k + 1] : 0;
+        __m128i pair = _mm_set1_epi32(static_cast<int>((static_cast<unsigned int>(second) << 16) | (static_cast<unsigned int>(coefficients[k]) & 0xFFFF)));
+
+        __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + x + k)), zero);
+        __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + x + k + 1)), zero);
+
+        sumLow = _mm_add_epi32(sumLow, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pair));
+        sumHigh = _mm_add_epi32(sumHigh, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pair));
+      }
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), sumLow);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x + 4), sumHigh);
+    }
+#endif
+  }
+#endif
+
+  for (; x < width; x++)
+  {
+    int sum = 0;
+    const unsigned char* it = source + x;
+
+    for (unsigned int k = 0; k < qtyCoefficients; k++)
+    {
+      sum += coefficients[k] * it[k];
+    }
+
+    destination[x] = sum;
+  }
+}
+
+void ConvolutionRows::vertical(const int* const* rows, int* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients)
+{
+  unsigned int x = 0;
+
+#if defined(__AVX2__)
+  for (; x + 8 <= width; x += 8)
+  {
+    __m256i sum = _mm256_setzero_si256();
+
+    for (unsigned int k = 0; k < qtyCoefficients; k++)
+    {
+      __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + x));
+      sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(values, _mm256_set1_epi32(coefficients[k])));
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x), sum);
+  }
+#elif defined(__SSE4_1__)
+  for (; x + 4 <= width; x += 4)
+  {
+    __m128i sum = _mm_setzero_si128();
+
+    for (unsigned int k = 0; k < qtyCoefficients; k++)
+    {
+      __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + x));
+      sum = _mm_add_epi32(sum, _mm_mullo_epi32(values, _mm_set1_epi32(coefficients[k])));
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), sum);
+  }
+#endif
+
+  // SSE2 has no 32 bit multiplication, this loop is left to the auto vectorizer of the compiler
+  for (unsigned int i = x; i < width; i++)
+  {
+    destination[i] = 0;
+  }
+
+  for (unsigned int k = 0; k < qtyCoefficients; k++)
+  {
+    int coefficient = coefficients[k];
+    const int* row = rows[k];
+
+    for (unsigned int i = x; i < width; i++)
+    {
+      destination[i] += coefficient * row[i];
+    }
+  }
+}
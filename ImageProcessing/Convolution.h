@@ -0,0 +1,332 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "IntegralImage.h"
+#include "MatrixView.h"
+
+// description of a convolution filter which is independent of the class Filter
+// m_values holds m_width * m_height coefficients row by row
+class ConvolutionKernel
+{
+public:
+  ConvolutionKernel();
+
+  bool isSeparable() const;
+  bool isBox() const;
+  void setSeparableCoefficients(const std::vector<int>& horizontal, const std::vector<int>& vertical);
+  void findSeparableCoefficients();
+
+  double getSumOfAbsoluteValues() const;
+  double getSumOfAbsoluteHorizontalCoefficients() const;
+  double getSumOfAbsoluteVerticalCoefficients() const;
+
+  std::vector<int> m_values;
+  std::vector<int> m_horizontalCoefficients; // empty, if the kernel is not separable
+  std::vector<int> m_verticalCoefficients;
+  unsigned int m_width;
+  unsigned int m_height;
+  unsigned int m_offsetLeft;
+  unsigned int m_offsetTop;
+  double m_preFactor;
+  bool m_shiftResultValues;
+  bool m_invertNegativeResultValues;
+
+private:
+  static double sumOfAbsoluteValues(const std::vector<int>& values);
+};
+
+// row kernels of the convolution
+// the overloads for unsigned char / int use SSE2, SSE4.1 or AVX2, if the compiler is allowed to generate them
+class ConvolutionRows
+{
+public:
+  // destination[x] = sum(coefficients[k] * source[x + k])
+  template<typename T, typename A>
+  static void horizontal(const T* source, A* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients);
+  static void horizontal(const unsigned char* source, int* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients);
+
+  // destination[x] = sum(coefficients[k] * rows[k][x])
+  template<typename A, typename B>
+  static void vertical(const A* const* rows, B* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients);
+  static void vertical(const int* const* rows, int* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients);
+
+  // destination[x] += coefficient * source[x]
+  template<typename T, typename A>
+  static void accumulate(const T* source, A* destination, unsigned int width, int coefficient);
+};
+
+template<typename T>
+class Convolution
+{
+public:
+  // destination and source must not overlap
+  // only the pixels which are fully covered by the kernel are written
+  static void apply(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel);
+
+private:
+  static void applyBox(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel);
+
+  template<typename H, typename V>
+  static void applySeparable(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel);
+
+  template<typename A>
+  static void applyGeneric(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel);
+
+  template<typename A>
+  static void finalizeRow(const A* accumulated, T* destination, unsigned int width, const ConvolutionKernel& kernel);
+
+  static bool hasSmallIntegerType();
+  static double getMaximumAbsoluteValue();
+
+  static const unsigned int MinimumBoxSize = 30; // width + height, below the separable passes are faster
+};
+
+template<typename T, typename A>
+void ConvolutionRows::horizontal(const T* source, A* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients)
+{
+  for (unsigned int x = 0; x < width; x++)
+  {
+    A sum = 0;
+    const T* it = source + x;
+
+    for (unsigned int k = 0; k < qtyCoefficients; k++)
+    {
+      sum += coefficients[k] * static_cast<A>(it[k]);
+    }
+
+    destination[x] = sum;
+  }
+}
+
+template<typename A, typename B>
+void ConvolutionRows::vertical(const A* const* rows, B* destination, unsigned int width, const int* coefficients, unsigned int qtyCoefficients)
+{
+  for (unsigned int x = 0; x < width; x++)
+  {
+    destination[x] = 0;
+  }
+
+  for (unsigned int k = 0; k < qtyCoefficients; k++)
+  {
+    B coefficient = coefficients[k];
+    const A* row = rows[k];
+
+    for (unsigned int x = 0; x < width; x++)
+    {
+      destination[x] += coefficient * row[x];
+    }
+  }
+}
+
+template<typename T, typename A>
+void ConvolutionRows::accumulate(const T* source, A* destination, unsigned int width, int coefficient)
+{
+  // the product is calculated with the type of source * coefficient, the same way as the classic per pixel loop did
+  for (unsigned int x = 0; x < width; x++)
+  {
+    destination[x] += source[x] * coefficient;
+  }
+}
+
+template<typename T>
+void Convolution<T>::apply(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel)
+{
+  if (kernel.m_width == 0 || kernel.m_height == 0 || source.getWidth() < kernel.m_width || source.getHeight() < kernel.m_height)
+  {
+    return;
+  }
+
+  // integer accumulation is used whenever the sum can not overflow, the results are the same as with double accumulation
+  double maximumAbsoluteValue = getMaximumAbsoluteValue();
+  double maximumInt = std::numeric_limits<int>::max();
+
+  // the sums of a box filter are read from an integral image, so the cost does not depend on the size of the kernel
+  // the integral image of big types is calculated with double, so the box path is used only where the sums are exact
+  if (hasSmallIntegerType() && kernel.isBox() && kernel.m_width + kernel.m_height >= MinimumBoxSize)
+  {
+    applyBox(source, destination, kernel);
+  }
+  else if (kernel.isSeparable())
+  {
+    double horizontalBound = maximumAbsoluteValue * kernel.getSumOfAbsoluteHorizontalCoefficients();
+    double verticalBound = horizontalBound * kernel.getSumOfAbsoluteVerticalCoefficients();
+
+    if (hasSmallIntegerType() && horizontalBound <= maximumInt)
+    {
+      if (verticalBound <= maximumInt)
+      {
+        applySeparable<int, int>(source, destination, kernel);
+      }
+      else
+      {
+        applySeparable<int, double>(source, destination, kernel);
+      }
+    }
+    else
+    {
+      applySeparable<double, double>(source, destination, kernel);
+    }
+  }
+  else
+  {
+    if (hasSmallIntegerType() && maximumAbsoluteValue * kernel.getSumOfAbsoluteValues() <= maximumInt)
+    {
+      applyGeneric<int>(source, destination, kernel);
+    }
+    else
+    {
+      applyGeneric<double>(source, destination, kernel);
+    }
+  }
+}
+
+template<typename T>
+void Convolution<T>::applyBox(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel)
+{
+  unsigned int outputWidth = source.getWidth() - kernel.m_width + 1;
+  unsigned int outputHeight = source.getHeight() - kernel.m_height + 1;
+
+  IntegralImage<T> integralImage(source, false);
+  std::vector<typename IntegralImage<T>::SumType> sums(outputWidth);
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    integralImage.getSumsOfRow(y, kernel.m_width, kernel.m_height, &sums[0]);
+    finalizeRow(&sums[0], destination.getRow(y + kernel.m_offsetTop) + kernel.m_offsetLeft, outputWidth, kernel);
+  }
+}
+
+template<typename T>
+template<typename H, typename V>
+void Convolution<T>::applySeparable(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel)
+{
+  unsigned int outputWidth = source.getWidth() - kernel.m_width + 1;
+  unsigned int outputHeight = source.getHeight() - kernel.m_height + 1;
+  unsigned int qtyRows = kernel.m_height;
+
+  // the results of the horizontal pass are kept in a ring buffer of kernel.m_height rows
+  std::vector<H> ringBuffer(qtyRows * outputWidth);
+  std::vector<const H*> rows(qtyRows);
+  std::vector<V> accumulated(outputWidth);
+
+  unsigned int nextSourceRow = 0;
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    while (nextSourceRow < y + qtyRows)
+    {
+      ConvolutionRows::horizontal(source.getRow(nextSourceRow), &ringBuffer[(nextSourceRow % qtyRows) * outputWidth], outputWidth, &kernel.m_horizontalCoefficients[0], kernel.m_width);
+      nextSourceRow++;
+    }
+
+    for (unsigned int k = 0; k < qtyRows; k++)
+    {
+      rows[k] = &ringBuffer[((y + k) % qtyRows) * outputWidth];
+    }
+
+    ConvolutionRows::vertical(&rows[0], &accumulated[0], outputWidth, &kernel.m_verticalCoefficients[0], qtyRows);
+    finalizeRow(&accumulated[0], destination.getRow(y + kernel.m_offsetTop) + kernel.m_offsetLeft, outputWidth, kernel);
+  }
+}
+
+template<typename T>
+template<typename A>
+void Convolution<T>::applyGeneric(const MatrixView<const T>& source, const MatrixView<T>& destination, const ConvolutionKernel& kernel)
+{
+  unsigned int outputWidth = source.getWidth() - kernel.m_width + 1;
+  unsigned int outputHeight = source.getHeight() - kernel.m_height + 1;
+
+  std::vector<A> accumulated(outputWidth);
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    std::fill(accumulated.begin(), accumulated.end(), 0);
+
+    // the taps are added in the same order as in the classic per pixel loop
+    const int* coefficient = &kernel.m_values[0];
+    for (unsigned int fy = 0; fy < kernel.m_height; fy++)
+    {
+      const T* sourceRow = source.getRow(y + fy);
+
+      for (unsigned int fx = 0; fx < kernel.m_width; fx++, coefficient++)
+      {
+        if (*coefficient != 0)
+        {
+          ConvolutionRows::accumulate(sourceRow + fx, &accumulated[0], outputWidth, *coefficient);
+        }
+      }
+    }
+
+    finalizeRow(&accumulated[0], destination.getRow(y + kernel.m_offsetTop) + kernel.m_offsetLeft, outputWidth, kernel);
+  }
+}
+
+template<typename T>
+template<typename A>
+void Convolution<T>::finalizeRow(const A* accumulated, T* destination, unsigned int width, const ConvolutionKernel& kernel)
+{
+  // computed in double, so it does not overflow for int, floor keeps the result of the integer division for the small types
+  double shift = std::floor((static_cast<double>(std::numeric_limits<T>::max()) - static_cast<double>(std::numeric_limits<T>::min())) / 2);
+  double minimum = std::numeric_limits<T>::min();
+  double maximum = std::numeric_limits<T>::max();
+
+  for (unsigned int x = 0; x < width; x++)
+  {
+    double calculatedValue = accumulated[x];
+
+    calculatedValue *= kernel.m_preFactor;
+    calculatedValue > 0 ? calculatedValue += 0.5 : calculatedValue -= 0.5;
+
+    if (kernel.m_shiftResultValues)
+    {
+      calculatedValue += shift;
+    }
+
+    if (kernel.m_invertNegativeResultValues)
+    {
+      if (calculatedValue < 0)
+      {
+        calculatedValue *= -1;
+      }
+    }
+
+    if (calculatedValue < minimum)
+    {
+      calculatedValue = minimum;
+    }
+
+    if (calculatedValue > maximum)
+    {
+      calculatedValue = maximum;
+    }
+
+    destination[x] = calculatedValue;
+  }
+}
+
+template<typename T>
+bool Convolution<T>::hasSmallIntegerType()
+{
+  return std::numeric_limits<T>::is_integer && sizeof(T) <= 2;
+}
+
+template<typename T>
+double Convolution<T>::getMaximumAbsoluteValue()
+{
+  double minimum = std::numeric_limits<T>::min();
+  double maximum = std::numeric_limits<T>::max();
+
+  if (std::numeric_limits<T>::is_integer && -minimum > maximum)
+  {
+    return -minimum;
+  }
+
+  return maximum;
+}
+
+#endif // CONVOLUTION_H
@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include "Edge.h"
 
 Edge::Edge(const Point& position, float direction, float strength) :
@@ -7,7 +9,27 @@ Edge::Edge(const Point& position, float direction, float strength) :
 {
 }
 
-Point Edge::getPosition()
+Point Edge::getPosition() const
 {
   return m_position;
 }
+
+float Edge::getDirection() const
+{
+  return m_direction;
+}
+
+float Edge::getStrength() const
+{
+  return m_strength;
+}
+
+float Edge::getContrast() const
+{
+  return std::fabs(m_strength);
+}
+
+Edge::Polarity Edge::getPolarity() const
+{
+  return m_strength < 0.0f ? Falling : Rising;
+}
@@ -1,15 +1,29 @@
 #ifndef EDGE_H
 #define EDGE_H
 
-#include <list>
+#include <vector>
+
 #include "Point.h"
 
 class Edge
 {
 public:
+  // Any is only used to select edges, see EdgeProbe
+  enum Polarity
+  {
+    Any,
+    Rising, // dark to bright in direction
+    Falling // bright to dark in direction
+  };
+
+  // strength > 0 -> rising edge
   Edge(const Point& position, float direction, float strength);
 
-  Point getPosition();
+  Point getPosition() const;
+  float getDirection() const;
+  float getStrength() const;
+  float getContrast() const; // |strength|
+  Polarity getPolarity() const;
 
 private:
   Point m_position;
@@ -17,6 +31,6 @@ private:
   float m_strength;
 };
 
-typedef std::list<Edge> Edges;
+typedef std::vector<Edge> Edges;
 
 #endif // EDGE_H
@@ -0,0 +1,101 @@
+#include <cmath>
+
+#include "EdgeProbe.h"
+#include "MathHelper.h"
+
+const unsigned int EdgeProbe::MinimumQtyProbesPerTask;
+
+EdgeProbe::EdgeProbe(const Line& line, float minContrast, unsigned int smoothingWidth, Edge::Polarity polarity) :
+  m_line(line),
+  m_minContrast(minContrast),
+  m_smoothingWidth(std::max(smoothingWidth, 1u)),
+  m_polarity(polarity)
+{
+}
+
+std::vector<EdgeProbe> EdgeProbe::createRake(const Line& line, float width, unsigned int qtyLines, float minContrast, unsigned int smoothingWidth,
+                                             Edge::Polarity polarity)
+{
+  std::vector<EdgeProbe> probes;
+  probes.reserve(qtyLines);
+
+  float normal = line.angle() + 90.0f;
+
+  for (unsigned int i = 0; i < qtyLines; i++)
+  {
+    float offset = qtyLines > 1 ? width * i / (qtyLines - 1) - width / 2.0f : 0.0f;
+    Point start = MathHelper::calcEndPoint(line.getStartPoint(), normal, offset);
+    Point end = MathHelper::calcEndPoint(line.getEndPoint(), normal, offset);
+    probes.push_back(EdgeProbe(Line(start, end), minContrast, smoothingWidth, polarity));
+  }
+
+  return probes;
+}
+
+const Line& EdgeProbe::getLine() const
+{
+  return m_line;
+}
+
+float EdgeProbe::getMinContrast() const
+{
+  return m_minContrast;
+}
+
+unsigned int EdgeProbe::getSmoothingWidth() const
+{
+  return m_smoothingWidth;
+}
+
+Edge::Polarity EdgeProbe::getPolarity() const
+{
+  return m_polarity;
+}
+
+void EdgeProbe::findEdges(const std::vector<float>& profile, std::vector<float>& differences, Edges& edges) const
+{
+  if (profile.size() < 2)
+  {
+    return;
+  }
+
+  // differences[i] lies between the samples i and i + 1
+  differences.resize(profile.size() - 1);
+  for (size_t i = 0; i < differences.size(); i++)
+  {
+    differences[i] = profile[i + 1] - profile[i];
+  }
+
+  Point start = m_line.getStartPoint();
+  Point end = m_line.getEndPoint();
+  float length = m_line.length();
+  float dx = (end.m_x - start.m_x) / length;
+  float dy = (end.m_y - start.m_y) / length;
+
+  for (size_t i = 0; i < differences.size(); i++)
+  {
+    float difference = differences[i];
+    float contrast = std::fabs(difference);
+
+    if (contrast < m_minContrast || contrast == 0.0f || (m_polarity == Edge::Rising && difference < 0.0f) || (m_polarity == Edge::Falling && difference > 0.0f))
+    {
+      continue;
+    }
+
+    // neighbours of the other polarity count as 0, a plateau yields its first difference
+    float sign = difference < 0.0f ? -1.0f : 1.0f;
+    float previous = i > 0 ? std::max(sign * differences[i - 1], 0.0f) : 0.0f;
+    float next = i + 1 < differences.size() ? std::max(sign * differences[i + 1], 0.0f) : 0.0f;
+
+    if (previous >= contrast || next > contrast)
+    {
+      continue;
+    }
+
+    float curvature = previous - 2.0f * contrast + next;
+    float shift = curvature < 0.0f ? 0.5f * (previous - next) / curvature : 0.0f;
+    float distance = i + 0.5f + std::min(std::max(shift, -0.5f), 0.5f);
+
+    edges.push_back(Edge(Point(start.m_x + distance * dx, start.m_y + distance * dy), m_line.angle(), difference));
+  }
+}
@@ -0,0 +1,153 @@
+#ifndef EDGEPROBE_H
+#define EDGEPROBE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "Edge.h"
+#include "Line.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
+
+// searches edges along a line with sub-pixel accuracy
+// the profile is sampled every pixel along the line with bilinear interpolation and averaged over smoothingWidth parallel lines
+// an edge is a local maximum of the difference of neighbouring samples, its position is refined with a parabola through the three differences
+// findEdges() runs many probes in parallel, every task reuses its profile buffers -> no allocation per sample
+class EdgeProbe
+{
+public:
+  EdgeProbe(const Line& line, float minContrast, unsigned int smoothingWidth = 1, Edge::Polarity polarity = Edge::Any);
+
+  // qtyLines parallel probes in the direction of line, spread evenly over width perpendicular to it (centred on line)
+  static std::vector<EdgeProbe> createRake(const Line& line, float width, unsigned int qtyLines, float minContrast, unsigned int smoothingWidth = 1,
+                                           Edge::Polarity polarity = Edge::Any);
+
+  // edges of every probe in the order of the probes, the edges of a probe are ordered from its start point to its end point
+  template<typename T>
+  static std::vector<Edges> findEdges(const MatrixView<const T>& view, const std::vector<EdgeProbe>& probes, unsigned int qtyThreads = 0);
+
+  const Line& getLine() const;
+  float getMinContrast() const;
+  unsigned int getSmoothingWidth() const;
+  Edge::Polarity getPolarity() const;
+
+private:
+  template<typename T>
+  void sampleProfile(const MatrixView<const T>& view, std::vector<float>& profile) const;
+
+  // pixels outside of the view are replaced by the nearest pixel of the border
+  template<typename T>
+  static float interpolate(const MatrixView<const T>& view, float x, float y);
+
+  void findEdges(const std::vector<float>& profile, std::vector<float>& differences, Edges& edges) const;
+
+  static const unsigned int MinimumQtyProbesPerTask = 8;
+
+  Line m_line;
+  float m_minContrast;
+  unsigned int m_smoothingWidth;
+  Edge::Polarity m_polarity;
+};
+
+template<typename T>
+std::vector<Edges> EdgeProbe::findEdges(const MatrixView<const T>& view, const std::vector<EdgeProbe>& probes, unsigned int qtyThreads)
+{
+  std::vector<Edges> edges(probes.size());
+
+  if (view.isEmpty() || probes.empty())
+  {
+    return edges;
+  }
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  size_t qtyProbes = probes.size();
+  unsigned int qtyTasks = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(qtyThreads, qtyProbes / MinimumQtyProbesPerTask)));
+
+  threadPool.run(qtyTasks, [&](unsigned int task)
+  {
+    size_t first = qtyProbes * task / qtyTasks;
+    size_t last = qtyProbes * (task + 1) / qtyTasks;
+
+    std::vector<float> profile;
+    std::vector<float> differences;
+    for (size_t i = first; i < last; i++)
+    {
+      probes[i].sampleProfile(view, profile);
+      probes[i].findEdges(profile, differences, edges[i]);
+    }
+  }, qtyThreads);
+
+  return edges;
+}
+
+template<typename T>
+void EdgeProbe::sampleProfile(const MatrixView<const T>& view, std::vector<float>& profile) const
+{
+  Point start = m_line.getStartPoint();
+  Point end = m_line.getEndPoint();
+  float length = m_line.length();
+
+  profile.assign(static_cast<size_t>(length) + 1, 0.0f);
+
+  if (length <= 0.0f)
+  {
+    profile[0] = interpolate(view, start.m_x, start.m_y);
+    return;
+  }
+
+  // unit steps along the line and perpendicular to it
+  float dx = (end.m_x - start.m_x) / length;
+  float dy = (end.m_y - start.m_y) / length;
+
+  for (unsigned int s = 0; s < m_smoothingWidth; s++)
+  {
+    float offset = s - (m_smoothingWidth - 1) / 2.0f;
+    float x = start.m_x - offset * dy;
+    float y = start.m_y + offset * dx;
+
+    for (size_t i = 0; i < profile.size(); i++)
+    {
+      profile[i] += interpolate(view, x + i * dx, y + i * dy);
+    }
+  }
+
+  if (m_smoothingWidth > 1)
+  {
+    float factor = 1.0f / m_smoothingWidth;
+    for (size_t i = 0; i < profile.size(); i++)
+    {
+      profile[i] *= factor;
+    }
+  }
+}
+
+template<typename T>
+float EdgeProbe::interpolate(const MatrixView<const T>& view, float x, float y)
+{
+  float maxX = static_cast<float>(view.getWidth() - 1);
+  float maxY = static_cast<float>(view.getHeight() - 1);
+  x = std::min(std::max(x, 0.0f), maxX);
+  y = std::min(std::max(y, 0.0f), maxY);
+
+  unsigned int x0 = static_cast<unsigned int>(x);
+  unsigned int y0 = static_cast<unsigned int>(y);
+  unsigned int x1 = std::min(x0 + 1, view.getWidth() - 1);
+  unsigned int y1 = std::min(y0 + 1, view.getHeight() - 1);
+  float fx = x - x0;
+  float fy = y - y0;
+
+  const T* row0 = view.getRow(y0);
+  const T* row1 = view.getRow(y1);
+  float top = static_cast<float>(row0[x0]) + fx * (static_cast<float>(row0[x1]) - static_cast<float>(row0[x0]));
+  float bottom = static_cast<float>(row1[x0]) + fx * (static_cast<float>(row1[x1]) - static_cast<float>(row1[x0]));
+
+  return top + fy * (bottom - top);
+}
+
+#endif // EDGEPROBE_H
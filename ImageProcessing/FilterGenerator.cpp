@@ -1,3 +1,5 @@
+#include <numeric>
+
 #include "FilterGenerator.h"
 
 FilterGenerator::FilterGenerator()
@@ -15,6 +17,7 @@ Filter FilterGenerator::mean(unsigned int width, unsigned int height)
 
   filter.setAllValues(1);
   filter.setPreFactor(1.0 / (width * height));
+  filter.setSeparableCoefficients(std::vector<int>(width, 1), std::vector<int>(height, 1));
 
   return filter;
 }
@@ -38,7 +41,12 @@ Filter FilterGenerator::binomial(unsigned int width, unsigned int height)
 
   Filter filter(width, height);
   filter.setBinomialValues();
-  filter.setPreFactor(1.0 / filter.getSumOfAllValues());
+
+  // the values of big binomial filters don't fit in short, the sum is calculated with the exact coefficients
+  std::vector<int> horizontal = binomialCoefficients(width - 1);
+  std::vector<int> vertical = binomialCoefficients(height - 1);
+  filter.setSeparableCoefficients(horizontal, vertical);
+  filter.setPreFactor(1.0 / (std::accumulate(horizontal.begin(), horizontal.end(), 0.0) * std::accumulate(vertical.begin(), vertical.end(), 0.0)));
 
   return filter;
 }
@@ -102,3 +110,19 @@ Filter FilterGenerator::sobelHorizontal()
   filter.rotateBy90DegreeClockwise();
   return filter;
 }
+
+std::vector<int> FilterGenerator::binomialCoefficients(unsigned int n)
+{
+  // row n of pascal's triangle
+  std::vector<int> coefficients(n + 1, 1);
+
+  for (unsigned int i = 1; i < n; i++)
+  {
+    for (unsigned int k = i; k > 0; k--)
+    {
+      coefficients[k] += coefficients[k - 1];
+    }
+  }
+
+  return coefficients;
+}
@@ -1,6 +1,7 @@
 #ifndef FILTERGENERATOR_H
 #define FILTERGENERATOR_H
 
+#include "FixedKernel.h"
 #include "Matrix.h"
 
 class FilterGenerator
@@ -15,6 +16,16 @@ public:
   static Filter laplacian2();
   static Filter sobelHorizontal();
   static Filter sobelVertical();
+
+  // compile-time versions of the classic filters for Matrix::filter<Kernel>(), the results are the same as with the Filter objects
+  typedef FixedKernel<3, 3, 1, false, true, -1, -2, -1, 0, 0, 0, 1, 2, 1> SobelHorizontal;
+  typedef FixedKernel<3, 3, 1, false, true, -1, 0, 1, -2, 0, 2, -1, 0, 1> SobelVertical;
+  typedef FixedKernel<3, 3, 1, false, false, 0, -1, 0, -1, 4, -1, 0, -1, 0> Laplacian;
+  typedef FixedKernel<3, 3, 16, false, false, 1, 2, 1, 2, 4, 2, 1, 2, 1> Binomial3;
+  typedef FixedKernel<5, 5, 256, false, false, 1, 4, 6, 4, 1, 4, 16, 24, 16, 4, 6, 24, 36, 24, 6, 4, 16, 24, 16, 4, 1, 4, 6, 4, 1> Binomial5;
+
+private:
+  static std::vector<int> binomialCoefficients(unsigned int n);
 };
 
 #endif // FILTERGENERATOR_H
@@ -0,0 +1,280 @@
+#ifndef FIXEDKERNEL_H
+#define FIXEDKERNEL_H
+
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "MatrixView.h"
+
+// sums of the positive and of the negative coefficients (as positive number) of a FixedKernel
+template<int... Coefficients>
+class FixedKernelSums
+{
+public:
+  static const int Positive = 0;
+  static const int Negative = 0;
+};
+
+template<int Coefficient, int... Coefficients>
+class FixedKernelSums<Coefficient, Coefficients...>
+{
+public:
+  static const int Positive = (Coefficient > 0 ? Coefficient : 0) + FixedKernelSums<Coefficients...>::Positive;
+  static const int Negative = (Coefficient < 0 ? -Coefficient : 0) + FixedKernelSums<Coefficients...>::Negative;
+};
+
+// number of bits to shift for a division by a power of 2
+template<unsigned int Value>
+class FixedKernelLog2
+{
+public:
+  static const int Result = 1 + FixedKernelLog2<Value / 2>::Result;
+};
+
+template<>
+class FixedKernelLog2<1>
+{
+public:
+  static const int Result = 0;
+};
+
+// the taps of a FixedKernel, one recursion per coefficient -> the loops over the kernel are unrolled, zero coefficients generate no code
+template<unsigned int Width, unsigned int Index, int... Coefficients>
+class FixedKernelTaps
+{
+public:
+  template<typename A, typename T>
+  static void add(A&, const T* const*, unsigned int)
+  {
+  }
+
+#if defined(__SSE2__) || defined(_M_X64)
+  static void add(__m128i&, __m128i&, const unsigned char* const*, unsigned int)
+  {
+  }
+#endif
+};
+
+template<unsigned int Width, unsigned int Index, int Coefficient, int... Coefficients>
+class FixedKernelTaps<Width, Index, Coefficient, Coefficients...>
+{
+public:
+  // the taps are added row by row in the same order as Convolution does
+  template<typename A, typename T>
+  static void add(A& sum, const T* const* rows, unsigned int x)
+  {
+    if (Coefficient != 0)
+    {
+      sum += Coefficient * static_cast<A>(rows[Index / Width][x + Index % Width]);
+    }
+
+    FixedKernelTaps<Width, Index + 1, Coefficients...>::add(sum, rows, x);
+  }
+
+#if defined(__SSE2__) || defined(_M_X64)
+  // 16 pixels in two registers of 8 x 16 bit
+  static void add(__m128i& low, __m128i& high, const unsigned char* const* rows, unsigned int x)
+  {
+    if (Coefficient != 0)
+    {
+      __m128i zero = _mm_setzero_si128();
+      __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[Index / Width] + x + Index % Width));
+      __m128i valuesLow = _mm_unpacklo_epi8(values, zero);
+      __m128i valuesHigh = _mm_unpackhi_epi8(values, zero);
+
+      if (Coefficient == 1)
+      {
+        low = _mm_add_epi16(low, valuesLow);
+        high = _mm_add_epi16(high, valuesHigh);
+      }
+      else if (Coefficient == -1)
+      {
+        low = _mm_sub_epi16(low, valuesLow);
+        high = _mm_sub_epi16(high, valuesHigh);
+      }
+      else
+      {
+        __m128i coefficient = _mm_set1_epi16(static_cast<short>(Coefficient));
+        low = _mm_add_epi16(low, _mm_mullo_epi16(valuesLow, coefficient));
+        high = _mm_add_epi16(high, _mm_mullo_epi16(valuesHigh, coefficient));
+      }
+    }
+
+    FixedKernelTaps<Width, Index + 1, Coefficients...>::add(low, high, rows, x);
+  }
+#endif
+};
+
+// convolution filter, which is completely defined at compile time, e. g. FilterGenerator::SobelHorizontal
+// the result is the same as of a Filter with the same values, preFactor 1 / Divisor and the same flags (see Convolution)
+// the taps are unrolled and the flags are resolved by the compiler, so the loop over the pixels has no branches
+// 8 bit images are filtered with SSE2 in 16 bit lanes, if Divisor is a power of 2, the values are not shifted and the sums fit into 16 bit
+template<unsigned int Width, unsigned int Height, unsigned int Divisor, bool ShiftResultValues, bool InvertNegativeResultValues, int... Coefficients>
+class FixedKernel
+{
+public:
+  static_assert(sizeof...(Coefficients) == Width * Height, "one coefficient per pixel of the kernel");
+  static_assert(Width > 0 && Height > 0 && Divisor > 0, "empty kernel");
+
+  // the reference point is the center of the kernel
+  static const unsigned int OffsetLeft = Width / 2;
+  static const unsigned int OffsetTop = Height / 2;
+  static const unsigned int OffsetRight = Width - OffsetLeft - 1;
+  static const unsigned int OffsetBottom = Height - OffsetTop - 1;
+
+  // destination and source must not overlap, only the pixels which are fully covered by the kernel are written
+  template<typename T>
+  static void apply(const MatrixView<const T>& source, const MatrixView<T>& destination);
+
+private:
+  typedef FixedKernelSums<Coefficients...> Sums;
+  typedef FixedKernelTaps<Width, 0, Coefficients...> Taps;
+
+  static const bool IsPowerOf2 = (Divisor & (Divisor - 1)) == 0;
+  static const unsigned int Maximum8Bit = std::numeric_limits<unsigned char>::max();
+
+  // negative sums need signed 16 bit lanes, a kernel without negative coefficients can use the unsigned range of the lanes
+  static const bool IsSigned = Sums::Negative > 0;
+  static const long long MaximumSum = static_cast<long long>(Sums::Positive > Sums::Negative ? Sums::Positive : Sums::Negative) * Maximum8Bit + Divisor / 2;
+  static const bool FitsInto16Bit = IsSigned ? MaximumSum <= 32767 : (MaximumSum <= 65535 && MaximumSum / Divisor <= 32767);
+  static const bool HasVectorPath = IsPowerOf2 && !ShiftResultValues && FitsInto16Bit;
+
+  template<typename T>
+  static T finalize(double value);
+
+  // returns the number of pixels of the row, which were filtered with SIMD -> the others are filtered pixel by pixel
+  template<typename T>
+  static unsigned int applyRowVectorized(const T* const*, T*, unsigned int);
+  static unsigned int applyRowVectorized(const unsigned char* const* rows, unsigned char* destination, unsigned int width);
+};
+
+template<unsigned int Width, unsigned int Height, unsigned int Divisor, bool ShiftResultValues, bool InvertNegativeResultValues, int... Coefficients>
+template<typename T>
+void FixedKernel<Width, Height, Divisor, ShiftResultValues, InvertNegativeResultValues, Coefficients...>::apply(const MatrixView<const T>& source, const MatrixView<T>& destination)
+{
+  if (source.getWidth() < Width || source.getHeight() < Height)
+  {
+    return;
+  }
+
+  // small integer types are summed exactly with int, the same way as Convolution does
+  typedef typename std::conditional<std::numeric_limits<T>::is_integer && sizeof(T) <= 2, int, double>::type Accumulator;
+
+  unsigned int outputWidth = source.getWidth() - Width + 1;
+  unsigned int outputHeight = source.getHeight() - Height + 1;
+
+  const T* rows[Height];
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    for (unsigned int fy = 0; fy < Height; fy++)
+    {
+      rows[fy] = source.getRow(y + fy);
+    }
+
+    T* destinationRow = destination.getRow(y + OffsetTop) + OffsetLeft;
+
+    for (unsigned int x = applyRowVectorized(rows, destinationRow, outputWidth); x < outputWidth; x++)
+    {
+      Accumulator sum = 0;
+      Taps::add(sum, rows, x);
+      destinationRow[x] = finalize<T>(sum);
+    }
+  }
+}
+
+template<unsigned int Width, unsigned int Height, unsigned int Divisor, bool ShiftResultValues, bool InvertNegativeResultValues, int... Coefficients>
+template<typename T>
+T FixedKernel<Width, Height, Divisor, ShiftResultValues, InvertNegativeResultValues, Coefficients...>::finalize(double value)
+{
+  // same rounding and clipping as Convolution::finalizeRow
+  value *= 1.0 / Divisor;
+  value > 0 ? value += 0.5 : value -= 0.5;
+
+  if (ShiftResultValues)
+  {
+    value += ((std::numeric_limits<T>::max() - std::numeric_limits<T>::min()) / 2);
+  }
+
+  if (InvertNegativeResultValues && value < 0)
+  {
+    value *= -1;
+  }
+
+  if (value < static_cast<double>(std::numeric_limits<T>::min()))
+  {
+    value = std::numeric_limits<T>::min();
+  }
+
+  if (value > static_cast<double>(std::numeric_limits<T>::max()))
+  {
+    value = std::numeric_limits<T>::max();
+  }
+
+  return static_cast<T>(value);
+}
+
+template<unsigned int Width, unsigned int Height, unsigned int Divisor, bool ShiftResultValues, bool InvertNegativeResultValues, int... Coefficients>
+template<typename T>
+unsigned int FixedKernel<Width, Height, Divisor, ShiftResultValues, InvertNegativeResultValues, Coefficients...>::applyRowVectorized(const T* const*, T*, unsigned int)
+{
+  return 0;
+}
+
+template<unsigned int Width, unsigned int Height, unsigned int Divisor, bool ShiftResultValues, bool InvertNegativeResultValues, int... Coefficients>
+unsigned int FixedKernel<Width, Height, Divisor, ShiftResultValues, InvertNegativeResultValues, Coefficients...>::applyRowVectorized(const unsigned char* const* rows, unsigned char* destination, unsigned int width)
+{
+  unsigned int x = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  if (!HasVectorPath)
+  {
+    return 0;
+  }
+
+  __m128i zero = _mm_setzero_si128();
+  __m128i rounding = _mm_set1_epi16(static_cast<short>(Divisor / 2));
+
+  for (; x + 16 <= width; x += 16)
+  {
+    __m128i low = zero;
+    __m128i high = zero;
+    Taps::add(low, high, rows, x);
+
+    // the same results as finalize(): negative sums are 0 or their absolute value, half values are rounded up
+    if (IsSigned)
+    {
+      if (InvertNegativeResultValues)
+      {
+        low = _mm_max_epi16(low, _mm_sub_epi16(zero, low));
+        high = _mm_max_epi16(high, _mm_sub_epi16(zero, high));
+      }
+      else
+      {
+        low = _mm_max_epi16(low, zero);
+        high = _mm_max_epi16(high, zero);
+      }
+    }
+
+    if (Divisor > 1)
+    {
+      low = _mm_srli_epi16(_mm_add_epi16(low, rounding), FixedKernelLog2<Divisor>::Result);
+      high = _mm_srli_epi16(_mm_add_epi16(high, rounding), FixedKernelLog2<Divisor>::Result);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), _mm_packus_epi16(low, high));
+  }
+#else
+  (void)rows;
+  (void)destination;
+  (void)width;
+#endif
+
+  return x;
+}
+
+#endif // FIXEDKERNEL_H
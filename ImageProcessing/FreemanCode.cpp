@@ -10,7 +10,7 @@ void FreemanCode::setStartPoint(const Point &startPoint)
   m_startPoint = startPoint;
 }
 
-void FreemanCode::setDirections(const std::list<unsigned char> &directions)
+void FreemanCode::setDirections(const std::vector<unsigned char> &directions)
 {
   m_directions = directions;
 }
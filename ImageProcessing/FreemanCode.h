@@ -1,7 +1,7 @@
 #ifndef FREEMANCODE_H
 #define FREEMANCODE_H
 
-#include <list>
+#include <vector>
 
 #include "Point.h"
 
@@ -11,10 +11,10 @@ public:
   FreemanCode();
 
   Point m_startPoint; // TODO really public?
-  std::list<unsigned char> m_directions;
+  std::vector<unsigned char> m_directions; // 0 ... 7, see Matrix::setFreemanCode
 
   void setStartPoint(const Point& startPoint);
-  void setDirections(const std::list<unsigned char>& directions);
+  void setDirections(const std::vector<unsigned char>& directions);
 };
 
 #endif // FREEMANCODE_H
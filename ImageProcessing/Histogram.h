@@ -0,0 +1,292 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "MatrixView.h"
+#include "Region.h"
+#include "ThreadPool.h"
+
+// histogram of integer types up to 16 bit, bin i counts the value min of T + i -> signed types are binned with an offset
+// compute() splits the rows (or the spans of a region) over the ThreadPool, every task counts into 4 interleaved sub-histograms,
+// so runs of equal values do not wait for the store of the previous increment of the same bin
+// other types are not supported, their histogram has no bins
+template<typename T>
+class Histogram
+{
+public:
+  Histogram();
+
+  static bool isSupported();
+
+  static Histogram compute(const MatrixView<const T>& view, unsigned int qtyThreads = 0);
+  static Histogram compute(const MatrixView<const T>& view, const Region& region, unsigned int qtyThreads = 0); // region in coordinates of the view
+
+  void add(const Histogram& rhs);
+
+  unsigned int getQtyBins() const;
+  const std::vector<unsigned int>& getBins() const;
+  unsigned int getCount(T value) const;
+  size_t getQtyValues() const;
+
+  // same as Statistics: max of T / min of T, if no value was counted
+  T getMinimum() const;
+  T getMaximum() const;
+  double getMean() const;
+
+  // smallest value, so that at least quantil * number of values are less or equal
+  T getQuantil(double quantil) const;
+
+  static unsigned int getIndex(T value);
+  static T getValue(unsigned int index);
+
+private:
+  // counter(firstItem, lastItem, counts) is called for the items of every task
+  template<typename Counter>
+  static Histogram compute(unsigned int qtyItems, unsigned int minimumQtyItemsPerTask, unsigned int qtyThreads, const Counter& counter);
+
+  // counts has QtySubHistograms * number of bins entries
+  static void count(const T* values, unsigned int length, unsigned int* counts);
+
+  static const unsigned int QtySubHistograms = 4;
+  static const unsigned int MinimumQtyRowsPerTask = 16;
+  static const unsigned int MinimumQtySpansPerTask = 64;
+
+  std::vector<unsigned int> m_bins;
+  size_t m_qtyValues;
+};
+
+template<typename T>
+Histogram<T>::Histogram() :
+  m_qtyValues(0)
+{
+  if (isSupported())
+  {
+    m_bins.assign(static_cast<size_t>(getIndex(std::numeric_limits<T>::max())) + 1, 0);
+  }
+}
+
+template<typename T>
+bool Histogram<T>::isSupported()
+{
+  return std::numeric_limits<T>::is_integer && sizeof(T) <= 2;
+}
+
+template<typename T>
+Histogram<T> Histogram<T>::compute(const MatrixView<const T>& view, unsigned int qtyThreads)
+{
+  unsigned int width = view.getWidth();
+  unsigned int height = view.getHeight();
+
+  return compute(height, MinimumQtyRowsPerTask, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow, unsigned int* counts)
+  {
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      count(view.getRow(y), width, counts);
+    }
+  });
+}
+
+template<typename T>
+Histogram<T> Histogram<T>::compute(const MatrixView<const T>& view, const Region& region, unsigned int qtyThreads)
+{
+  Region clipped = region.clip(view.getWidth(), view.getHeight());
+  const std::vector<Region::Span>& spans = clipped.getSpans();
+
+  return compute(static_cast<unsigned int>(spans.size()), MinimumQtySpansPerTask, qtyThreads, [&](unsigned int firstSpan, unsigned int lastSpan, unsigned int* counts)
+  {
+    for (unsigned int i = firstSpan; i < lastSpan; i++)
+    {
+      count(view.getRow(spans[i].m_y) + spans[i].m_x, spans[i].m_length, counts);
+    }
+  });
+}
+
+template<typename T>
+template<typename Counter>
+Histogram<T> Histogram<T>::compute(unsigned int qtyItems, unsigned int minimumQtyItemsPerTask, unsigned int qtyThreads, const Counter& counter)
+{
+  Histogram histogram;
+
+  if (!isSupported() || qtyItems == 0)
+  {
+    return histogram;
+  }
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int qtyTasks = std::max(1u, std::min(qtyThreads, qtyItems / minimumQtyItemsPerTask));
+  size_t qtyBins = histogram.m_bins.size();
+  std::vector<std::vector<unsigned int> > counts(qtyTasks);
+
+  threadPool.run(qtyTasks, [&](unsigned int task)
+  {
+    unsigned int firstItem = static_cast<unsigned int>(static_cast<unsigned long long>(qtyItems) * task / qtyTasks);
+    unsigned int lastItem = static_cast<unsigned int>(static_cast<unsigned long long>(qtyItems) * (task + 1) / qtyTasks);
+
+    counts[task].assign(QtySubHistograms * qtyBins, 0);
+    counter(firstItem, lastItem, &counts[task][0]);
+  }, qtyThreads);
+
+  for (unsigned int task = 0; task < qtyTasks; task++)
+  {
+    const unsigned int* subHistogram = &counts[task][0];
+    for (unsigned int s = 0; s < QtySubHistograms; s++, subHistogram += qtyBins)
+    {
+      for (size_t i = 0; i < qtyBins; i++)
+      {
+        histogram.m_bins[i] += subHistogram[i];
+        histogram.m_qtyValues += subHistogram[i];
+      }
+    }
+  }
+
+  return histogram;
+}
+
+template<typename T>
+void Histogram<T>::count(const T* values, unsigned int length, unsigned int* counts)
+{
+  size_t qtyBins = static_cast<size_t>(getIndex(std::numeric_limits<T>::max())) + 1;
+  unsigned int* counts0 = counts;
+  unsigned int* counts1 = counts0 + qtyBins;
+  unsigned int* counts2 = counts1 + qtyBins;
+  unsigned int* counts3 = counts2 + qtyBins;
+
+  unsigned int x = 0;
+  for (; x + 4 <= length; x += 4)
+  {
+    counts0[getIndex(values[x])]++;
+    counts1[getIndex(values[x + 1])]++;
+    counts2[getIndex(values[x + 2])]++;
+    counts3[getIndex(values[x + 3])]++;
+  }
+
+  for (; x < length; x++)
+  {
+    counts0[getIndex(values[x])]++;
+  }
+}
+
+template<typename T>
+void Histogram<T>::add(const Histogram& rhs)
+{
+  for (size_t i = 0; i < m_bins.size(); i++)
+  {
+    m_bins[i] += rhs.m_bins[i];
+  }
+
+  m_qtyValues += rhs.m_qtyValues;
+}
+
+template<typename T>
+unsigned int Histogram<T>::getQtyBins() const
+{
+  return static_cast<unsigned int>(m_bins.size());
+}
+
+template<typename T>
+const std::vector<unsigned int>& Histogram<T>::getBins() const
+{
+  return m_bins;
+}
+
+template<typename T>
+unsigned int Histogram<T>::getCount(T value) const
+{
+  return m_bins.empty() ? 0 : m_bins[getIndex(value)];
+}
+
+template<typename T>
+size_t Histogram<T>::getQtyValues() const
+{
+  return m_qtyValues;
+}
+
+template<typename T>
+T Histogram<T>::getMinimum() const
+{
+  for (size_t i = 0; i < m_bins.size(); i++)
+  {
+    if (m_bins[i] > 0)
+    {
+      return getValue(static_cast<unsigned int>(i));
+    }
+  }
+
+  return std::numeric_limits<T>::max();
+}
+
+template<typename T>
+T Histogram<T>::getMaximum() const
+{
+  for (size_t i = m_bins.size(); i > 0; i--)
+  {
+    if (m_bins[i - 1] > 0)
+    {
+      return getValue(static_cast<unsigned int>(i - 1));
+    }
+  }
+
+  return std::numeric_limits<T>::min();
+}
+
+template<typename T>
+double Histogram<T>::getMean() const
+{
+  if (m_qtyValues == 0)
+  {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  for (size_t i = 0; i < m_bins.size(); i++)
+  {
+    sum += static_cast<double>(getValue(static_cast<unsigned int>(i))) * m_bins[i];
+  }
+
+  return sum / m_qtyValues;
+}
+
+template<typename T>
+T Histogram<T>::getQuantil(double quantil) const
+{
+  if (m_qtyValues == 0)
+  {
+    return std::numeric_limits<T>::min();
+  }
+
+  double limit = std::min(std::max(quantil, 0.0), 1.0) * m_qtyValues;
+  size_t sum = 0;
+  for (size_t i = 0; i < m_bins.size(); i++)
+  {
+    sum += m_bins[i];
+    if (sum > 0 && sum >= limit)
+    {
+      return getValue(static_cast<unsigned int>(i));
+    }
+  }
+
+  return getMaximum();
+}
+
+template<typename T>
+unsigned int Histogram<T>::getIndex(T value)
+{
+  return static_cast<unsigned int>(static_cast<long long>(value) - static_cast<long long>(std::numeric_limits<T>::min()));
+}
+
+template<typename T>
+T Histogram<T>::getValue(unsigned int index)
+{
+  return static_cast<T>(static_cast<long long>(std::numeric_limits<T>::min()) + index);
+}
+
+#endif // HISTOGRAM_H
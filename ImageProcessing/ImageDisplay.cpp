@@ -299,34 +299,37 @@ void ImageDisplay::setImage(Image* image)
 {
   m_image = image;
 
-  const unsigned char* data = m_image->getLayer(0);
-  QImage::Format format = QImage::Format_Indexed8;
+  QPixmap pixmap;
 
-  if (image->getQtyLayers() == 3)
+  if (image->getQtyLayers() == 3 || image->getQtyLayers() == 4)
   {
+    // the layers are interleaved into the display buffer, which is only reallocated if the size or the format changes
     std::vector<unsigned int> layerIndices;
     layerIndices.push_back(2);
     layerIndices.push_back(1);
     layerIndices.push_back(0);
-    layerIndices.push_back(0);
-    data = m_image->getSingleLayer(layerIndices);
-    format = QImage::Format_RGB32;
-  }
+    layerIndices.push_back(image->getQtyLayers() == 4 ? 3 : 0);
 
-  if (image->getQtyLayers() == 4)
+    QImage::Format format = image->getQtyLayers() == 4 ? QImage::Format_ARGB32 : QImage::Format_RGB32;
+    int width = image->getWidth();
+    int height = image->getHeight();
+
+    if (m_displayBuffer.width() != width || m_displayBuffer.height() != height || m_displayBuffer.format() != format)
+    {
+      m_displayBuffer = QImage(width, height, format);
+    }
+
+    // the buffer is not shared with a pixmap, so bits() does not detach
+    m_image->getSingleLayer(layerIndices, m_displayBuffer.bits(), m_displayBuffer.bytesPerLine());
+    pixmap = QPixmap::fromImage(m_displayBuffer);
+  }
+  else
   {
-    std::vector<unsigned int> layerIndices;
-    layerIndices.push_back(2);
-    layerIndices.push_back(1);
-    layerIndices.push_back(0);
-    layerIndices.push_back(3);
-    data = m_image->getSingleLayer(layerIndices);
-    format = QImage::Format_ARGB32;
+    // a single layer is shown without any intermediate buffer
+    QImage qImage(m_image->getLayer(0), image->getWidth(), image->getHeight(), m_image->getStride(), QImage::Format_Indexed8);
+    pixmap = QPixmap::fromImage(qImage);
   }
 
-  QImage qImage(data, image->getWidth(), image->getHeight(), format);
-  QPixmap pixmap = QPixmap::fromImage(qImage);
-
   m_scene->clear();
   m_scene->addPixmap(pixmap);
 
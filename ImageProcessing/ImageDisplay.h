@@ -4,6 +4,7 @@
 #include <QBrush>
 #include <QWidget>
 #include <QGraphicsScene>
+#include <QImage>
 #include <QLine>
 #include <QPoint>
 #include <QRect>
@@ -50,6 +51,7 @@ private:
   QGraphicsScene* m_scene;
   bool m_ctrlButtonIsPressed;
   Image* m_image;
+  QImage m_displayBuffer; // interleaved copy of colour images, reused as long as size and format do not change
 
   QPointF m_mousePressPosition;
   QPointF m_mouseMovePosition;
@@ -0,0 +1,179 @@
+#include <cctype>
+#include <cstring>
+
+#include <QImage>
+#include <QString>
+#include <QVector>
+
+#include "ImageFile.h"
+#include "MatrixFile.h"
+
+namespace
+{
+  QString toQString(const std::string& fileName)
+  {
+    return QString::fromLocal8Bit(fileName.c_str());
+  }
+
+  // the indices are the grey values, so the image can be read without conversion
+  bool hasGreyColorTable(const QImage& qImage)
+  {
+    QVector<QRgb> colorTable = qImage.colorTable();
+
+    for (int i = 0; i < colorTable.size(); i++)
+    {
+      if (colorTable[i] != qRgb(i, i, i))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
+
+bool ImageFile::read(const std::string& fileName, Matrix<unsigned char>& image)
+{
+  if (hasExtension(fileName, MatrixFile::Extension))
+  {
+    return MatrixFile::read(fileName, image);
+  }
+
+  // binary PGM / PPM are streamed directly into the image, e.g. ASCII PGM is read by QImage
+  if ((hasExtension(fileName, ".pgm") || hasExtension(fileName, ".ppm")) && MatrixFile::readPnm(fileName, image))
+  {
+    return true;
+  }
+
+  QImage qImage(toQString(fileName));
+
+  if (qImage.isNull())
+  {
+    return false;
+  }
+
+  std::vector<unsigned int> layerIndices;
+  bool isGrey = qImage.format() == QImage::Format_Indexed8 && hasGreyColorTable(qImage);
+
+  // every other format than grey Indexed8, RGB32 and ARGB32 is converted, grey images (e.g. 1 bit or 16 bit grey) keep one layer
+  if (!isGrey && qImage.format() != QImage::Format_ARGB32 && qImage.format() != QImage::Format_RGB32)
+  {
+    isGrey = qImage.isGrayscale();
+    qImage = qImage.convertToFormat(isGrey ? QImage::Format_RGB32 : QImage::Format_ARGB32);
+  }
+
+  if (isGrey)
+  {
+    layerIndices.push_back(0); // the index of Indexed8 or the blue channel of RGB32
+  }
+  else
+  {
+    layerIndices.push_back(2);
+    layerIndices.push_back(1);
+    layerIndices.push_back(0);
+    layerIndices.push_back(3);
+  }
+
+  if (qImage.isNull())
+  {
+    return false;
+  }
+
+  // the rows of QImage are padded to 32 bit
+  image = Matrix<unsigned char>(qImage.width(), qImage.height(), layerIndices.size(), false);
+  image.setSingleLayer(qImage.constBits(), layerIndices, qImage.bytesPerLine());
+
+  return true;
+}
+
+bool ImageFile::write(const std::string& fileName, const Matrix<unsigned char>& image)
+{
+  if (hasExtension(fileName, MatrixFile::Extension))
+  {
+    return MatrixFile::write(fileName, image);
+  }
+
+  if (hasExtension(fileName, ".pgm") || hasExtension(fileName, ".ppm"))
+  {
+    return MatrixFile::writePnm(fileName, image);
+  }
+
+  unsigned int qtyLayers = image.getQtyLayers();
+  int width = image.getWidth();
+  int height = image.getHeight();
+
+  if (qtyLayers == 1)
+  {
+    // the layer is used without a copy, the grey palette maps the values to grey levels
+    QImage qImage(image.getLayer(0), width, height, image.getStride(), QImage::Format_Indexed8);
+
+    QVector<QRgb> colorTable(256);
+    for (int i = 0; i < colorTable.size(); i++)
+    {
+      colorTable[i] = qRgb(i, i, i);
+    }
+    qImage.setColorTable(colorTable);
+
+    return qImage.save(toQString(fileName));
+  }
+
+  if (qtyLayers != 3 && qtyLayers != 4)
+  {
+    return false;
+  }
+
+  // the same interleaving as ImageDisplay
+  std::vector<unsigned int> layerIndices;
+  layerIndices.push_back(2);
+  layerIndices.push_back(1);
+  layerIndices.push_back(0);
+  layerIndices.push_back(qtyLayers == 4 ? 3 : 0);
+
+  QImage qImage(width, height, qtyLayers == 4 ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+  image.getSingleLayer(layerIndices, qImage.bits(), qImage.bytesPerLine());
+
+  return qImage.save(toQString(fileName));
+}
+
+const std::vector<std::string>& ImageFile::getExtensions()
+{
+  static const char* const extensions[] = {".bmp", ".gif", ".jpg", ".jpeg", ".png", ".pbm", ".pgm", ".ppm", ".tif", ".tiff", ".xbm", ".xpm", MatrixFile::Extension};
+  static const std::vector<std::string> result(extensions, extensions + sizeof(extensions) / sizeof(extensions[0]));
+
+  return result;
+}
+
+bool ImageFile::isSupported(const std::string& fileName)
+{
+  const std::vector<std::string>& extensions = getExtensions();
+
+  for (size_t i = 0; i < extensions.size(); i++)
+  {
+    if (hasExtension(fileName, extensions[i].c_str()))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool ImageFile::hasExtension(const std::string& fileName, const char* extension)
+{
+  size_t length = strlen(extension);
+
+  if (fileName.size() < length)
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < length; i++)
+  {
+    if (tolower(static_cast<unsigned char>(fileName[fileName.size() - length + i])) != tolower(static_cast<unsigned char>(extension[i])))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef IMAGEFILE_H
+#define IMAGEFILE_H
+
+#include <string>
+#include <vector>
+
+#include "Matrix.h"
+
+// reads and writes 8 bit images in every format of the application
+// * native format and binary PGM / PPM are streamed by MatrixFile
+// * all other formats (tif, png, bmp, jpg, ...) are decoded and encoded by QImage, no display is needed
+//   every format of QImage is read: 8 bit grey and 32 bit colour images directly, all others are converted to 32 bit first
+// grey images have 1 layer, colour images 4 layers (red, green, blue, alpha) like ImageDisplay expects them
+// the functions are reentrant, so several images can be read and written in parallel
+class ImageFile
+{
+public:
+  static bool read(const std::string& fileName, Matrix<unsigned char>& image);
+
+  // the format is taken from the extension: 1 or 3 layers for PGM / PPM, 1, 3 or 4 layers for the formats of QImage
+  static bool write(const std::string& fileName, const Matrix<unsigned char>& image);
+
+  // lower case with the dot, e.g. ".tif"
+  static const std::vector<std::string>& getExtensions();
+  static bool isSupported(const std::string& fileName); // by the extension
+
+private:
+  ImageFile();
+
+  static bool hasExtension(const std::string& fileName, const char* extension);
+};
+
+#endif // IMAGEFILE_H
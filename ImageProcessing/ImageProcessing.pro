@@ -11,6 +11,8 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 TARGET = ImageProcessing
 TEMPLATE = app
 
+CONFIG += c++11
+
 
 SOURCES += main.cpp\
         MainWindow.cpp \
@@ -35,7 +37,21 @@ SOURCES += main.cpp\
     RectangleRotated.cpp \
     TeachableRectangleRotated.cpp \
     TeachablePolyLine.cpp \
-    GraphicsPolyLineItem.cpp
+    GraphicsPolyLineItem.cpp \
+    MemoryHelper.cpp \
+    Convolution.cpp \
+    ThreadPool.cpp \
+    PolarTransformation.cpp \
+    MappedFile.cpp \
+    MatrixFile.cpp \
+    ImageFile.cpp \
+    Region.cpp \
+    BinaryImage.cpp \
+    Labeling.cpp \
+    EdgeProbe.cpp \
+    Rotation.cpp \
+    TileCache.cpp \
+    BufferPool.cpp
 
 HEADERS  += MainWindow.h \
     ImageDisplay.h \
@@ -47,6 +63,7 @@ HEADERS  += MainWindow.h \
     Matrix.h \
     Image.h \
     FilterGenerator.h \
+    FixedKernel.h \
     StructuringElementGenerator.h \
     RunLengthCode.h \
     Edge.h \
@@ -62,7 +79,30 @@ HEADERS  += MainWindow.h \
     RectangleRotated.h \
     TeachableRectangleRotated.h \
     TeachablePolyLine.h \
-    GraphicsPolyLineItem.h
+    GraphicsPolyLineItem.h \
+    MatrixView.h \
+    MemoryHelper.h \
+    Convolution.h \
+    ThreadPool.h \
+    BandScheduler.h \
+    MinMaxFilter.h \
+    QuantileFilter.h \
+    IntegralImage.h \
+    PointOperations.h \
+    PolarTransformation.h \
+    MappedFile.h \
+    MatrixFile.h \
+    ImageFile.h \
+    Region.h \
+    BinaryImage.h \
+    Blob.h \
+    Labeling.h \
+    EdgeProbe.h \
+    Histogram.h \
+    Rotation.h \
+    TileCache.h \
+    TiledMatrix.h \
+    BufferPool.h
 
 FORMS    += MainWindow.ui \
     ImageDisplay.ui
@@ -0,0 +1,232 @@
+#ifndef INTEGRALIMAGE_H
+#define INTEGRALIMAGE_H
+
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "MatrixView.h"
+
+// summed-area table of a single layer: the sum (and the sum of squares) of any axis aligned rectangle is read with four lookups
+// integer types up to 16 bit are summed exactly with long long, all other types with double
+template<typename T>
+class IntegralImage
+{
+public:
+  typedef typename std::conditional<std::numeric_limits<T>::is_integer && sizeof(T) <= 2, long long, double>::type SumType;
+
+  IntegralImage();
+  explicit IntegralImage(const MatrixView<const T>& view, bool withSquares = true);
+
+  void calculate(const MatrixView<const T>& view, bool withSquares = true);
+
+  unsigned int getWidth() const;
+  unsigned int getHeight() const;
+  bool isEmpty() const;
+  bool hasSquares() const;
+
+  // the rectangle is clipped to the image, the sums of an empty rectangle are 0
+  SumType getSum(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const;
+  SumType getSumOfSquares(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const;
+  double getMean(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const;
+  double getVariance(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const;
+
+  // destination[x] = getSum(x, y, width, height) for all windows of row y which are fully inside the image
+  // -> getWidth() - width + 1 values are written
+  void getSumsOfRow(unsigned int y, unsigned int width, unsigned int height, SumType* destination) const;
+
+private:
+  bool clip(unsigned int& x, unsigned int& y, unsigned int& width, unsigned int& height) const;
+  static SumType getSum(const std::vector<SumType>& table, unsigned int tableWidth, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+  unsigned int m_width;
+  unsigned int m_height;
+  std::vector<SumType> m_sums; // (m_width + 1) * (m_height + 1) values, the first row and the first column are 0
+  std::vector<SumType> m_sumsOfSquares; // empty, if the squares were not calculated
+};
+
+template<typename T>
+IntegralImage<T>::IntegralImage() :
+  m_width(0),
+  m_height(0)
+{
+}
+
+template<typename T>
+IntegralImage<T>::IntegralImage(const MatrixView<const T>& view, bool withSquares) :
+  m_width(0),
+  m_height(0)
+{
+  calculate(view, withSquares);
+}
+
+template<typename T>
+void IntegralImage<T>::calculate(const MatrixView<const T>& view, bool withSquares)
+{
+  m_width = view.getWidth();
+  m_height = view.getHeight();
+
+  unsigned int tableWidth = m_width + 1;
+  size_t tableSize = static_cast<size_t>(tableWidth) * (m_height + 1);
+
+  m_sums.assign(tableSize, 0);
+  m_sumsOfSquares.clear();
+
+  if (withSquares)
+  {
+    m_sumsOfSquares.assign(tableSize, 0);
+  }
+
+  // every entry is the running sum of its row plus the entry above
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    const T* source = view.getRow(y);
+    const SumType* above = &m_sums[static_cast<size_t>(y) * tableWidth];
+    SumType* current = &m_sums[static_cast<size_t>(y + 1) * tableWidth];
+    SumType rowSum = 0;
+
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+      rowSum += static_cast<SumType>(source[x]);
+      current[x + 1] = above[x + 1] + rowSum;
+    }
+
+    if (withSquares)
+    {
+      const SumType* squaresAbove = &m_sumsOfSquares[static_cast<size_t>(y) * tableWidth];
+      SumType* squaresCurrent = &m_sumsOfSquares[static_cast<size_t>(y + 1) * tableWidth];
+      SumType rowSumOfSquares = 0;
+
+      for (unsigned int x = 0; x < m_width; x++)
+      {
+        SumType value = static_cast<SumType>(source[x]);
+        rowSumOfSquares += value * value;
+        squaresCurrent[x + 1] = squaresAbove[x + 1] + rowSumOfSquares;
+      }
+    }
+  }
+}
+
+template<typename T>
+unsigned int IntegralImage<T>::getWidth() const
+{
+  return m_width;
+}
+
+template<typename T>
+unsigned int IntegralImage<T>::getHeight() const
+{
+  return m_height;
+}
+
+template<typename T>
+bool IntegralImage<T>::isEmpty() const
+{
+  return m_sums.empty();
+}
+
+template<typename T>
+bool IntegralImage<T>::hasSquares() const
+{
+  return !m_sumsOfSquares.empty();
+}
+
+template<typename T>
+typename IntegralImage<T>::SumType IntegralImage<T>::getSum(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const
+{
+  if (!clip(x, y, width, height))
+  {
+    return 0;
+  }
+
+  return getSum(m_sums, m_width + 1, x, y, width, height);
+}
+
+template<typename T>
+typename IntegralImage<T>::SumType IntegralImage<T>::getSumOfSquares(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const
+{
+  if (!hasSquares() || !clip(x, y, width, height))
+  {
+    return 0;
+  }
+
+  return getSum(m_sumsOfSquares, m_width + 1, x, y, width, height);
+}
+
+template<typename T>
+double IntegralImage<T>::getMean(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const
+{
+  if (!clip(x, y, width, height))
+  {
+    return 0.0;
+  }
+
+  return static_cast<double>(getSum(m_sums, m_width + 1, x, y, width, height)) / (static_cast<double>(width) * height);
+}
+
+template<typename T>
+double IntegralImage<T>::getVariance(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const
+{
+  if (!hasSquares() || !clip(x, y, width, height))
+  {
+    return 0.0;
+  }
+
+  double qtyPixels = static_cast<double>(width) * height;
+  double mean = static_cast<double>(getSum(m_sums, m_width + 1, x, y, width, height)) / qtyPixels;
+  double variance = static_cast<double>(getSum(m_sumsOfSquares, m_width + 1, x, y, width, height)) / qtyPixels - mean * mean;
+
+  // E(x^2) - E(x)^2 may become slightly negative for floating point types
+  return variance > 0.0 ? variance : 0.0;
+}
+
+template<typename T>
+void IntegralImage<T>::getSumsOfRow(unsigned int y, unsigned int width, unsigned int height, SumType* destination) const
+{
+  if (width == 0 || height == 0 || width > m_width || y + height > m_height)
+  {
+    return;
+  }
+
+  unsigned int tableWidth = m_width + 1;
+  const SumType* top = &m_sums[static_cast<size_t>(y) * tableWidth];
+  const SumType* bottom = &m_sums[static_cast<size_t>(y + height) * tableWidth];
+  unsigned int qtyWindows = m_width - width + 1;
+
+  for (unsigned int x = 0; x < qtyWindows; x++)
+  {
+    destination[x] = bottom[x + width] - bottom[x] - top[x + width] + top[x];
+  }
+}
+
+template<typename T>
+bool IntegralImage<T>::clip(unsigned int& x, unsigned int& y, unsigned int& width, unsigned int& height) const
+{
+  if (x >= m_width || y >= m_height)
+  {
+    return false;
+  }
+
+  if (width > m_width - x)
+  {
+    width = m_width - x;
+  }
+
+  if (height > m_height - y)
+  {
+    height = m_height - y;
+  }
+
+  return width > 0 && height > 0;
+}
+
+template<typename T>
+typename IntegralImage<T>::SumType IntegralImage<T>::getSum(const std::vector<SumType>& table, unsigned int tableWidth, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+  const SumType* top = &table[static_cast<size_t>(y) * tableWidth];
+  const SumType* bottom = &table[static_cast<size_t>(y + height) * tableWidth];
+
+  return bottom[x + width] - bottom[x] - top[x + width] + top[x];
+}
+
+#endif // INTEGRALIMAGE_H
@@ -0,0 +1,56 @@
+#include "Labeling.h"
+
+const unsigned int Labeling::MinimumStripHeight;
+
+void Labeling::connectRows(const std::vector<RunLength>& runs, size_t previousBegin, size_t previousEnd, size_t currentBegin, size_t currentEnd,
+                           bool neighborhood8, std::vector<unsigned int>& parents)
+{
+  // 8-connected runs also touch diagonally
+  long long tolerance = neighborhood8 ? 1 : 0;
+
+  size_t i = previousBegin;
+  size_t j = currentBegin;
+  while (i < previousEnd && j < currentEnd)
+  {
+    const RunLength& previous = runs[i];
+    const RunLength& current = runs[j];
+    long long previousRight = static_cast<long long>(previous.m_x) + previous.m_length;
+    long long currentRight = static_cast<long long>(current.m_x) + current.m_length;
+
+    if (previous.m_x < currentRight + tolerance && current.m_x < previousRight + tolerance)
+    {
+      unite(parents, static_cast<unsigned int>(i), static_cast<unsigned int>(j));
+    }
+
+    // the run which ends first cannot touch any further run of the other row
+    previousRight < currentRight ? i++ : j++;
+  }
+}
+
+unsigned int Labeling::findRoot(std::vector<unsigned int>& parents, unsigned int index)
+{
+  // path halving
+  while (parents[index] != index)
+  {
+    parents[index] = parents[parents[index]];
+    index = parents[index];
+  }
+
+  return index;
+}
+
+void Labeling::unite(std::vector<unsigned int>& parents, unsigned int lhs, unsigned int rhs)
+{
+  unsigned int lhsRoot = findRoot(parents, lhs);
+  unsigned int rhsRoot = findRoot(parents, rhs);
+
+  // the smaller index stays the root, so the root is the first run of the component
+  if (lhsRoot < rhsRoot)
+  {
+    parents[rhsRoot] = lhsRoot;
+  }
+  else if (rhsRoot < lhsRoot)
+  {
+    parents[lhsRoot] = rhsRoot;
+  }
+}
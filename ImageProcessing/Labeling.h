@@ -0,0 +1,261 @@
+#ifndef LABELING_H
+#define LABELING_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "Blob.h"
+#include "MatrixView.h"
+#include "RunLengthCode.h"
+#include "ThreadPool.h"
+
+// connected component labeling of the pixels with the object value, 4- or 8-connected
+// two passes over runs with union find: the first pass finds the runs of every row, measures the values under them and connects them
+// with the overlapping runs of the previous row, the second pass collects the runs of every component into its Blob
+// the image is split in horizontal strips which are labeled in parallel, afterwards the runs at the borders of the strips are connected
+// the blobs are ordered by their first pixel (top to bottom, left to right), independent of the number of threads
+class Labeling
+{
+public:
+  // mask and values must have the same size, the statistics of the blobs are the statistics of values
+  template<typename M, typename T>
+  static std::vector<Blob<T> > getBlobs(const MatrixView<const M>& mask, M objectValue, const MatrixView<const T>& values, bool neighborhood8 = true, unsigned int qtyThreads = 0);
+
+private:
+  template<typename T>
+  class RunValues
+  {
+  public:
+    T m_minimum;
+    T m_maximum;
+    double m_sum;
+    double m_sumOfSquares;
+  };
+
+  template<typename T>
+  class Strip
+  {
+  public:
+    std::vector<RunLength> m_runs;
+    std::vector<RunValues<T> > m_values;
+    std::vector<unsigned int> m_parents; // union find, indices inside of the strip
+    size_t m_qtyRunsOfFirstRow;
+    size_t m_firstRunOfLastRow;
+  };
+
+  template<typename M, typename T>
+  static void labelStrip(const MatrixView<const M>& mask, M objectValue, const MatrixView<const T>& values, bool neighborhood8,
+                         unsigned int firstRow, unsigned int lastRow, Strip<T>& strip);
+
+  // unites the runs [previousBegin, previousEnd) of a row with the overlapping runs [currentBegin, currentEnd) of the next row
+  static void connectRows(const std::vector<RunLength>& runs, size_t previousBegin, size_t previousEnd, size_t currentBegin, size_t currentEnd,
+                          bool neighborhood8, std::vector<unsigned int>& parents);
+
+  // the root of a component is always its first run
+  static unsigned int findRoot(std::vector<unsigned int>& parents, unsigned int index);
+  static void unite(std::vector<unsigned int>& parents, unsigned int lhs, unsigned int rhs);
+
+  static const unsigned int MinimumStripHeight = 64;
+};
+
+template<typename M, typename T>
+std::vector<Blob<T> > Labeling::getBlobs(const MatrixView<const M>& mask, M objectValue, const MatrixView<const T>& values, bool neighborhood8, unsigned int qtyThreads)
+{
+  std::vector<Blob<T> > blobs;
+
+  if (mask.isEmpty() || mask.getWidth() != values.getWidth() || mask.getHeight() != values.getHeight())
+  {
+    return blobs;
+  }
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int height = mask.getHeight();
+  unsigned int qtyStrips = std::max(1u, std::min(qtyThreads, height / MinimumStripHeight));
+  std::vector<Strip<T> > strips(qtyStrips);
+
+  threadPool.run(qtyStrips, [&](unsigned int index)
+  {
+    unsigned int firstRow = static_cast<unsigned int>(static_cast<unsigned long long>(height) * index / qtyStrips);
+    unsigned int lastRow = static_cast<unsigned int>(static_cast<unsigned long long>(height) * (index + 1) / qtyStrips);
+    labelStrip(mask, objectValue, values, neighborhood8, firstRow, lastRow, strips[index]);
+  }, qtyThreads);
+
+  // global indices: the runs of the strips one after another, so the order of all runs is still top to bottom, left to right
+  size_t qtyRuns = 0;
+  for (unsigned int s = 0; s < qtyStrips; s++)
+  {
+    qtyRuns += strips[s].m_runs.size();
+  }
+
+  std::vector<RunLength> runs;
+  std::vector<unsigned int> parents;
+  runs.reserve(qtyRuns);
+  parents.reserve(qtyRuns);
+
+  std::vector<size_t> firstRunOfStrip(qtyStrips);
+  for (unsigned int s = 0; s < qtyStrips; s++)
+  {
+    unsigned int offset = static_cast<unsigned int>(runs.size());
+    firstRunOfStrip[s] = offset;
+
+    runs.insert(runs.end(), strips[s].m_runs.begin(), strips[s].m_runs.end());
+    for (size_t i = 0; i < strips[s].m_parents.size(); i++)
+    {
+      parents.push_back(strips[s].m_parents[i] + offset);
+    }
+
+    if (s > 0)
+    {
+      size_t previousBegin = firstRunOfStrip[s - 1] + strips[s - 1].m_firstRunOfLastRow;
+      connectRows(runs, previousBegin, offset, offset, offset + strips[s].m_qtyRunsOfFirstRow, neighborhood8, parents);
+    }
+  }
+
+  // a run is the root of its component, if it is the first run of the component
+  std::vector<unsigned int> labels(runs.size());
+  for (unsigned int i = 0; i < runs.size(); i++)
+  {
+    unsigned int root = findRoot(parents, i);
+    if (root == i)
+    {
+      labels[i] = static_cast<unsigned int>(blobs.size());
+      blobs.push_back(Blob<T>());
+    }
+    else
+    {
+      labels[i] = labels[root];
+    }
+  }
+
+  std::vector<double> sums(blobs.size(), 0.0);
+  std::vector<double> sumsOfSquares(blobs.size(), 0.0);
+  std::vector<double> sumsOfX(blobs.size(), 0.0);
+  std::vector<double> sumsOfY(blobs.size(), 0.0);
+  std::vector<int> lefts(blobs.size(), std::numeric_limits<int>::max());
+  std::vector<int> rights(blobs.size(), std::numeric_limits<int>::min());
+  std::vector<int> tops(blobs.size(), 0);
+  std::vector<int> bottoms(blobs.size(), 0);
+
+  size_t index = 0;
+  for (unsigned int s = 0; s < qtyStrips; s++)
+  {
+    const Strip<T>& strip = strips[s];
+
+    for (size_t i = 0; i < strip.m_runs.size(); i++, index++)
+    {
+      const RunLength& run = strip.m_runs[i];
+      const RunValues<T>& runValues = strip.m_values[i];
+      unsigned int label = labels[index];
+      Blob<T>& blob = blobs[label];
+
+      if (blob.m_area == 0)
+      {
+        tops[label] = run.m_y;
+        blob.m_statistics.minimum = runValues.m_minimum;
+        blob.m_statistics.maximum = runValues.m_maximum;
+      }
+
+      // the runs of a blob are found in sorted order, so they are appended in O(1)
+      blob.m_runLengthCode.add(run);
+      blob.m_area += run.m_length;
+      bottoms[label] = run.m_y + 1;
+      lefts[label] = std::min(lefts[label], run.m_x);
+      rights[label] = std::max(rights[label], run.m_x + static_cast<int>(run.m_length));
+
+      sumsOfX[label] += run.m_length * (run.m_x + (run.m_length - 1) / 2.0);
+      sumsOfY[label] += static_cast<double>(run.m_length) * run.m_y;
+
+      blob.m_statistics.minimum = std::min(blob.m_statistics.minimum, runValues.m_minimum);
+      blob.m_statistics.maximum = std::max(blob.m_statistics.maximum, runValues.m_maximum);
+      sums[label] += runValues.m_sum;
+      sumsOfSquares[label] += runValues.m_sumOfSquares;
+    }
+  }
+
+  for (size_t label = 0; label < blobs.size(); label++)
+  {
+    Blob<T>& blob = blobs[label];
+    double area = static_cast<double>(blob.m_area);
+
+    blob.m_boundingRectangle = Rectangle(Point(static_cast<float>(lefts[label]), static_cast<float>(tops[label])),
+                                         static_cast<float>(rights[label] - lefts[label]), static_cast<float>(bottoms[label] - tops[label]));
+    blob.m_centroid = Point(static_cast<float>(sumsOfX[label] / area), static_cast<float>(sumsOfY[label] / area));
+    blob.m_statistics.meanValue = sums[label] / area;
+    blob.m_statistics.variance = std::max(0.0, sumsOfSquares[label] / area - blob.m_statistics.meanValue * blob.m_statistics.meanValue);
+  }
+
+  return blobs;
+}
+
+template<typename M, typename T>
+void Labeling::labelStrip(const MatrixView<const M>& mask, M objectValue, const MatrixView<const T>& values, bool neighborhood8,
+                          unsigned int firstRow, unsigned int lastRow, Strip<T>& strip)
+{
+  unsigned int width = mask.getWidth();
+  size_t previousBegin = 0;
+  size_t previousEnd = 0;
+
+  strip.m_qtyRunsOfFirstRow = 0;
+  strip.m_firstRunOfLastRow = 0;
+
+  for (unsigned int y = firstRow; y < lastRow; y++)
+  {
+    const M* maskRow = mask.getRow(y);
+    const T* valueRow = values.getRow(y);
+    size_t currentBegin = strip.m_runs.size();
+    unsigned int x = 0;
+
+    while (x < width)
+    {
+      if (!(maskRow[x] == objectValue))
+      {
+        x++;
+        continue;
+      }
+
+      unsigned int start = x;
+      RunValues<T> runValues;
+      runValues.m_minimum = valueRow[x];
+      runValues.m_maximum = valueRow[x];
+      runValues.m_sum = 0.0;
+      runValues.m_sumOfSquares = 0.0;
+
+      while (x < width && maskRow[x] == objectValue)
+      {
+        T value = valueRow[x];
+        runValues.m_minimum = std::min(runValues.m_minimum, value);
+        runValues.m_maximum = std::max(runValues.m_maximum, value);
+        runValues.m_sum += value;
+        runValues.m_sumOfSquares += static_cast<double>(value) * value;
+        x++;
+      }
+
+      strip.m_parents.push_back(static_cast<unsigned int>(strip.m_runs.size()));
+      strip.m_runs.push_back(RunLength(static_cast<int>(start), static_cast<int>(y), x - start));
+      strip.m_values.push_back(runValues);
+    }
+
+    size_t currentEnd = strip.m_runs.size();
+
+    if (y == firstRow)
+    {
+      strip.m_qtyRunsOfFirstRow = currentEnd;
+    }
+    else
+    {
+      connectRows(strip.m_runs, previousBegin, previousEnd, currentBegin, currentEnd, neighborhood8, strip.m_parents);
+    }
+
+    strip.m_firstRunOfLastRow = currentBegin;
+    previousBegin = currentBegin;
+    previousEnd = currentEnd;
+  }
+}
+
+#endif // LABELING_H
@@ -34,29 +34,26 @@ float Line::angle() const
   return m_angle;
 }
 
-Points Line::getPointsAlongLine() const
+float Line::length() const
 {
-  // code below copied partially from
-  // https://de.wikipedia.org/wiki/Bresenham-Algorithmus#Kompakte_Variante
+  return m_lenght;
+}
 
-  int x0 = m_startPoint.m_x;
-  int y0 = m_startPoint.m_y;
-  int x1 = m_endPoint.m_x;
-  int y1 = m_endPoint.m_y;
+unsigned int Line::getQtyPointsAlongLine() const
+{
+  // Bresenham makes one step per pixel of the longer direction
+  int dx = abs(static_cast<int>(m_endPoint.m_x) - static_cast<int>(m_startPoint.m_x));
+  int dy = abs(static_cast<int>(m_endPoint.m_y) - static_cast<int>(m_startPoint.m_y));
 
-  int dx =  abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
-  int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
-  int err = dx + dy, e2; /* error value e_xy */
+  return static_cast<unsigned int>(dx > dy ? dx : dy) + 1;
+}
 
+Points Line::getPointsAlongLine() const
+{
   Points points;
-  while(1){
-    points.push_back(Point(x0, y0));
-    if (x0==x1 && y0==y1) break;
-    e2 = 2*err;
-    if (e2 > dy) { err += dy; x0 += sx; } /* e_xy+e_x > 0 */
-    if (e2 < dx) { err += dx; y0 += sy; } /* e_xy+e_y < 0 */
-  }
+  points.reserve(getQtyPointsAlongLine());
+
+  visitPointsAlongLine([&points](int x, int y) {points.push_back(Point(x, y));});
 
   return points;
 }
-
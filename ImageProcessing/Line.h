@@ -1,6 +1,8 @@
 #ifndef LINE_H
 #define LINE_H
 
+#include <cstdlib>
+
 #include "Point.h"
 
 class Line
@@ -12,7 +14,13 @@ public:
   Point getStartPoint() const;
   Point getEndPoint() const;
   float angle() const;
+  float length() const;
 
+  // Bresenham from the start point to the end point (coordinates truncated to int)
+  // visitor(x, y) is called for every point, no list of points is created
+  template<typename Visitor>
+  void visitPointsAlongLine(Visitor visitor) const;
+  unsigned int getQtyPointsAlongLine() const;
   Points getPointsAlongLine() const;
 
 private:
@@ -22,4 +30,28 @@ private:
   float m_lenght;
 };
 
+template<typename Visitor>
+void Line::visitPointsAlongLine(Visitor visitor) const
+{
+  // code below copied partially from
+  // https://de.wikipedia.org/wiki/Bresenham-Algorithmus#Kompakte_Variante
+
+  int x0 = m_startPoint.m_x;
+  int y0 = m_startPoint.m_y;
+  int x1 = m_endPoint.m_x;
+  int y1 = m_endPoint.m_y;
+
+  int dx =  abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy, e2; /* error value e_xy */
+
+  while(1){
+    visitor(x0, y0);
+    if (x0==x1 && y0==y1) break;
+    e2 = 2*err;
+    if (e2 > dy) { err += dy; x0 += sx; } /* e_xy+e_x > 0 */
+    if (e2 < dx) { err += dx; y0 += sy; } /* e_xy+e_y < 0 */
+  }
+}
+
 #endif // LINE_H
@@ -3,7 +3,6 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QString>
-#include <QImage>
 #include <QSettings>
 
 #include "MainWindow.h"
@@ -12,6 +11,7 @@
 #include "ImageDisplay.h"
 #include "Matrix.h"
 #include "Image.h"
+#include "ImageFile.h"
 #include "FilterGenerator.h"
 #include "StructuringElementGenerator.h"
 #include "Line.h"
@@ -32,6 +32,7 @@ MainWindow::MainWindow(QWidget *parent) :
   m_imageDisplay = new ImageDisplay(this);
   setCentralWidget(m_imageDisplay);
 
+  //wideImageTest();
   //polyLineTest();
   //edgeDetectionTest();
   //lineDirectionTest();
@@ -51,7 +52,11 @@ MainWindow::~MainWindow()
 void MainWindow::on_actionOpenImage_triggered()
 {
   QStringList supportedFileFormats;
-  supportedFileFormats << "*.bmp" << "*.gif" << "*.jpg" << "*.jpeg" << "*.png" << "*.pbm" << "*.pgm" << "*.ppm" << "*.tif" << "*.tiff" << "*.xbm" << "*.xpm";
+  const std::vector<std::string>& extensions = ImageFile::getExtensions();
+  for (size_t i = 0; i < extensions.size(); i++)
+  {
+    supportedFileFormats << QString("*%1").arg(extensions[i].c_str());
+  }
 
   QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"), m_lastSelectedFile, tr("Images (%1)").arg(supportedFileFormats.join(" ")));
 
@@ -198,6 +203,27 @@ void MainWindow::morphologyTest()
   m_imageDisplay->setImage(image);
 }
 
+void MainWindow::wideImageTest()
+{
+  // a single row is bigger than the chunks of the in place operators and the kernels have no halo rows
+  unsigned int width = 300000;
+  unsigned int height = 40;
+
+  Matrix<unsigned char> image(width, height);
+  image.setIncreasingValues();
+
+  StructuringElement structuringElement = StructuringElementGenerator::rectangle(5, 1);
+  Filter filter = FilterGenerator::mean(5, 1);
+
+  QElapsedTimer timer;
+  timer.start();
+
+  image.erode(&structuringElement);
+  image.filter(&filter);
+
+  qDebug() << "erode and filter of" << width << "x" << height << "took" << timer.elapsed() << "milliseconds";
+}
+
 void MainWindow::polyLineTest()
 {
   for (unsigned int i = 0; i < 9; i++)
@@ -219,6 +245,11 @@ void MainWindow::edgeDetectionTest()
 
   Edges edges = image->findEdges(line, 20, 3);
 
+  for (size_t i = 0; i < edges.size(); i++)
+  {
+    image->setPoint(255, edges[i].getPosition());
+  }
+
   m_imageDisplay->setImage(image);
 }
 
@@ -243,14 +274,14 @@ void MainWindow::statisticsTest()
   image->setIncreasingValues();
 
   RunLengthCode runLenghtCode;
-  //runLenghtCode.push_back(RunLength(Point(0, 0), 2));
+  //runLenghtCode.add(RunLength(0, 0, 2));
 
   for (unsigned int y = 0; y < height; y++)
   {
-    runLenghtCode.push_back(RunLength(Point(0, y), width));
+    runLenghtCode.add(RunLength(0, y, width));
   }
 
-  //runLenghtCode.push_back(RunLength());
+  //runLenghtCode.add(RunLength());
 
   Statistics<unsigned char> statistics = image->getStatistics(runLenghtCode);
 
@@ -321,52 +352,20 @@ void MainWindow::showLena()
 
 void MainWindow::openAndShowImage(const QString &fileName, bool provideFeedback)
 {
-  QImage qImage(fileName);
-
-  if (qImage.isNull())
-  {
-    if (provideFeedback)
-    {
-      QMessageBox mb;
-      mb.setText(tr("Image could not be opened."));
-      mb.exec();
-    }
-    return;
-  }
-
-  std::vector<unsigned int> layerIndices;
+  Image* image = new Image();
 
-  // TODO create class FormatHelper and use also in class ImageDisplay
-  QImage::Format format = qImage.format();
-  switch(format)
+  if (!ImageFile::read(fileName.toLocal8Bit().constData(), *image))
   {
-  case QImage::Format_Indexed8:
-    layerIndices.push_back(0);
-    break;
-
-  case QImage::Format_ARGB32:
-  case QImage::Format_RGB32:
-    layerIndices.push_back(2);
-    layerIndices.push_back(1);
-    layerIndices.push_back(0);
-    layerIndices.push_back(3);
-    break;
-  }
+    delete image;
 
-  if (layerIndices.size() == 0)
-  {
     if (provideFeedback)
     {
       QMessageBox mb;
-      mb.setText(tr("Image format could not be recognized."));
+      mb.setText(tr("Image could not be opened."));
       mb.exec();
     }
     return;
   }
 
-  Image* image = new Image(qImage.width(), qImage.height(), layerIndices.size());
-
-  image->setSingleLayer(qImage.bits(), layerIndices);
-
   m_imageDisplay->setImage(image);
 }
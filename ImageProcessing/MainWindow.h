@@ -30,6 +30,7 @@ private:
   void filterTest();
   void binomialFilterTest();
   void morphologyTest();
+  void wideImageTest();
   void polyLineTest();
   void edgeDetectionTest();
   void lineDirectionTest();
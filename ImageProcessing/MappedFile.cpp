@@ -0,0 +1,149 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() :
+  m_data(0),
+  m_size(0)
+#if defined(_WIN32)
+  ,
+  m_file(INVALID_HANDLE_VALUE),
+  m_mapping(0)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& fileName)
+{
+  close();
+
+  m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+  if (m_file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+  {
+    close();
+    return false;
+  }
+
+  m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+  if (m_mapping == 0)
+  {
+    close();
+    return false;
+  }
+
+  m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (m_data == 0)
+  {
+    close();
+    return false;
+  }
+
+  m_size = static_cast<size_t>(size.QuadPart);
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (m_data != 0)
+  {
+    UnmapViewOfFile(m_data);
+  }
+
+  if (m_mapping != 0)
+  {
+    CloseHandle(m_mapping);
+  }
+
+  if (m_file != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(m_file);
+  }
+
+  m_data = 0;
+  m_size = 0;
+  m_mapping = 0;
+  m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const std::string& fileName)
+{
+  close();
+
+  int file = ::open(fileName.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(file, &status) != 0 || status.st_size <= 0)
+  {
+    ::close(file);
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(status.st_size);
+  void* data = mmap(0, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+  // the mapping keeps its own reference to the file
+  ::close(file);
+
+  if (data == MAP_FAILED)
+  {
+    return false;
+  }
+
+  m_data = static_cast<const unsigned char*>(data);
+  m_size = size;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (m_data != 0)
+  {
+    munmap(const_cast<unsigned char*>(m_data), m_size);
+  }
+
+  m_data = 0;
+  m_size = 0;
+}
+
+#endif
+
+bool MappedFile::isOpen() const
+{
+  return m_data != 0;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+  return m_data;
+}
+
+size_t MappedFile::getSize() const
+{
+  return m_size;
+}
@@ -0,0 +1,35 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// read-only memory mapping of a whole file
+// the pages are loaded by the operating system on the first access, so opening a big file costs no read and no copy
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  bool open(const std::string& fileName); // false, if the file does not exist, is empty or cannot be mapped
+  void close();
+
+  bool isOpen() const;
+  const unsigned char* getData() const;
+  size_t getSize() const;
+
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator= (const MappedFile&);
+
+  const unsigned char* m_data;
+  size_t m_size;
+
+#if defined(_WIN32)
+  void* m_file;
+  void* m_mapping;
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -1,25 +1,48 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <limits>
-#include <list>
 #include <math.h>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
 #include <vector>
 
+#include "BandScheduler.h"
+#include "BinaryImage.h"
+#include "Blob.h"
+#include "BufferPool.h"
 #include "Circle.h"
+#include "Convolution.h"
 #include "Converter.h"
 #include "Edge.h"
+#include "EdgeProbe.h"
 #include "FreemanCode.h"
+#include "Histogram.h"
+#include "IntegralImage.h"
+#include "Labeling.h"
 #include "Line.h"
 #include "MathHelper.h"
+#include "MatrixView.h"
+#include "MemoryHelper.h"
+#include "MinMaxFilter.h"
 #include "Point.h"
+#include "PointOperations.h"
+#include "PolarTransformation.h"
 #include "PolyLine.h"
+#include "QuantileFilter.h"
 #include "Rectangle.h"
+#include "Region.h"
+#include "Rotation.h"
 #include "RunLengthCode.h"
 #include "Statistics.h"
+#include "ThreadPool.h"
 
 // TODO rename this header to Base.h? Here ist not only Matrix defined anymore
 // TODO use const wherever possible
@@ -48,6 +71,7 @@ public:
   Matrix(unsigned int width, unsigned int height, unsigned int qtyLayers = 1, bool setDefaultValue = true, T defaultValue = 0);
   Matrix(const Matrix& rhs);
   Matrix(Matrix&& rhs);
+  explicit Matrix(const MatrixView<const T>& view);
   virtual ~Matrix();
 
   Matrix& operator= (const Matrix& rhs);
@@ -58,26 +82,56 @@ public:
   unsigned int getWidth() const;
   unsigned int getHeight() const;
   unsigned int getQtyLayers() const;
-  
+  unsigned int getStride() const;
+
   T getMinimum() const;
   T getMaximum() const;
 
   T getValue(unsigned int x, unsigned int y, unsigned int z = 0) const;
-  T*** getValues() const; // TODO const, so the pointer-adress can not be changed
+  T* getRow(unsigned int y, unsigned int z = 0);
+  const T* getRow(unsigned int y, unsigned int z = 0) const;
+  MatrixView<T> getView(unsigned int z = 0);
+  MatrixView<const T> getView(unsigned int z = 0) const;
+  // a view is axis aligned -> rotated rectangles return an empty view, use a Region instead
+  MatrixView<T> getView(const Rectangle& region, unsigned int z = 0);
+  MatrixView<const T> getView(const Rectangle& region, unsigned int z = 0) const;
   double getSumOfAllValues(unsigned int z = 0) const;
   const T* getLayer(unsigned int z) const;
-  const T* getSingleLayer(std::vector<unsigned int> layerIndices) const;
-  std::vector<unsigned int> getHistogram(unsigned int z);
+  // interleaves the given layers pixel by pixel into buffer (e.g. BGRA for a display) in one pass
+  // the buffer is owned by the caller, so it can be reused for every frame
+  // stride: distance between two rows of buffer in elements, 0 -> getWidth() * layerIndices.size()
+  // qtyThreads: 0 -> all threads of ThreadPool::getInstance(), 1 -> single threaded
+  void getSingleLayer(const std::vector<unsigned int>& layerIndices, T* buffer, unsigned int stride = 0, unsigned int qtyThreads = 0) const;
+  // bin i counts the value min of T + i, integer types up to 16 bit only, see Histogram
+  std::vector<unsigned int> getHistogram(unsigned int z) const;
+  std::vector<unsigned int> getHistogram(const Region& region, unsigned int z = 0) const;
+  Histogram<T> computeHistogram(unsigned int z = 0, unsigned int qtyThreads = 0) const;
+  Histogram<T> computeHistogram(const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0) const;
   RunLengthCode getRunLengthCode(T value, unsigned int z = 0) const;
   double getAverageAlongLine(const Line& line, unsigned int z = 0) const;
-  Statistics<T> getStatistics(const RunLengthCode& runLengthCode, unsigned int z = 0);
+  Statistics<T> getStatistics(const RunLengthCode& runLengthCode, unsigned int z = 0) const;
+  Statistics<T> getStatistics(const Region& region, unsigned int z = 0) const;
+  // connected components of the pixels with objectValue, see Labeling
+  std::vector<Blob<T> > getBlobs(T objectValue, unsigned int z = 0, bool neighborhood8 = true, unsigned int qtyThreads = 0) const;
+  // the same, but the statistics of the blobs are measured in layer z of values
+  template<typename U>
+  std::vector<Blob<U> > getBlobs(T objectValue, const Matrix<U>& values, unsigned int z = 0, bool neighborhood8 = true, unsigned int qtyThreads = 0) const;
+
+  // the integral image is calculated on the first call and cached until the matrix is accessed for writing
+  // (non-const getRow / getView and all methods which change values), const methods may call it concurrently
+  // rows and views requested for writing must not be written after the integral image was requested, request them again
+  const IntegralImage<T>& getIntegralImage(unsigned int z = 0) const;
+  // rotated rectangles contain all pixels whose center is inside (see Region) and cost one lookup per row
+  double getMean(const Rectangle& region, unsigned int z = 0) const;
+  double getVariance(const Rectangle& region, unsigned int z = 0) const;
 
   void setIncreasingValues();
   void setRandomValues();
   void setBinomialValues(unsigned int z = 0);
   void setAllValues(T value, unsigned int z = 0);
   void setValue(T value, unsigned int x, unsigned int y, unsigned int z = 0);
-  void setSingleLayer(T* buffer, std::vector<unsigned int> layerIndices);
+  // buffer: interleaved pixels, stride = distance between two rows in elements, 0 -> width * number of layer indices
+  void setSingleLayer(const T* buffer, const std::vector<unsigned int>& layerIndices, unsigned int stride = 0);
   void setRow(T value, unsigned int y, unsigned int z = 0);
   void setColumn(T value, unsigned int x, unsigned int z = 0);
   void setPoint(T value, const Point& point, unsigned int z = 0);
@@ -90,36 +144,84 @@ public:
   void setStructureElement(T value, const StructuringElement *structuringElement, const Point& referencePointPosition, unsigned int z = 0);
   void setHistogram(const std::vector<unsigned int>& histogram, unsigned int z = 0);
 
-  void filter(const Filter* filter, unsigned int z = 0);
-  void filterQuantil(const StructuringElement *structuringElement, double quantil, unsigned int z = 0);
-  void filterMedian(const StructuringElement *structuringElement, unsigned int z = 0);
-  void filterConservativeSmoothing(const StructuringElement *structuringElement, unsigned int z = 0);
+  // all neighbourhood operators process the given view in place, the border pixels which are not covered by the operator are left unchanged
+  // qtyThreads: 0 -> all threads of ThreadPool::getInstance(), 1 -> single threaded, the result is always the same
+  void filter(const Filter* filter, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filter(const Filter* filter, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  // compile-time kernel, e. g. filter<FilterGenerator::SobelHorizontal>(), see FixedKernel
+  template<typename Kernel>
+  void filter(unsigned int z = 0, unsigned int qtyThreads = 0);
+  template<typename Kernel>
+  void filter(const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  void filterQuantil(const StructuringElement *structuringElement, double quantil, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterQuantil(const StructuringElement *structuringElement, double quantil, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  void filterMedian(const StructuringElement *structuringElement, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterMedian(const StructuringElement *structuringElement, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  void filterConservativeSmoothing(const StructuringElement *structuringElement, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterConservativeSmoothing(const StructuringElement *structuringElement, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  void filterMean(unsigned int width, unsigned int height = 0, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterMean(unsigned int width, unsigned int height, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+
+  // the operators restricted to a Region (Rectangle, rotated Rectangle or RunLengthCode): only the pixels of the region are written,
+  // only the bounding rectangle of the region and the halo of the operator are read -> the result inside the region is the same as for the whole layer
+  void filter(const Filter* filter, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterQuantil(const StructuringElement *structuringElement, double quantil, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterMedian(const StructuringElement *structuringElement, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterConservativeSmoothing(const StructuringElement *structuringElement, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void filterMean(unsigned int width, unsigned int height, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void erode(const StructuringElement* structuringElement, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void dilate(const StructuringElement* structuringElement, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void open(const StructuringElement* structuringElement, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void close(const StructuringElement* structuringElement, const Region& region, unsigned int z = 0, unsigned int qtyThreads = 0);
+
+  // point operations of the same layer can be chained and applied in one pass, see PointOperations
+  PointOperations<T> pointOperations(unsigned int z = 0);
 
   void binarize(T threshold);
+  void binarize(T threshold, const Region& region);
   void spread();
+  // maps the quantils lowerQuantil ... upperQuantil of the histogram linearly to 0 ... max of T, values outside are clipped
+  // the histogram can be measured in a region or in another image, unsigned integer types up to 16 bit only
+  void autoContrast(double lowerQuantil = 0.0, double upperQuantil = 1.0, unsigned int z = 0);
+  void autoContrast(const Histogram<T>& histogram, double lowerQuantil = 0.0, double upperQuantil = 1.0, unsigned int z = 0);
   void clear();
   void invert();
-  void fillBackground(T backgroundValue, T fillValue, unsigned int z = 0);
+  void invert(const Region& region);
+  // fillBackground sets the background pixels which are connected to the border of the image to fillValue, fillHoles all other background pixels
+  // neighborhood8: the background pixels are 8-connected, otherwise 4-connected (use 4 for objects which are drawn with 8-connected lines)
+  void fillBackground(T backgroundValue, T fillValue, unsigned int z = 0, bool neighborhood8 = false);
+  void fillHoles(T backgroundValue, T fillValue, unsigned int z = 0, bool neighborhood8 = false);
   void replace(T currentValue, T newValue, unsigned int z = 0);
+  void replace(T currentValue, T newValue, const Region& region, unsigned int z = 0);
 
-  Edges findEdges(const Line& line, float minContrast, unsigned int smoothingWidth = 1, unsigned int z = 0);
+  Edges findEdges(const Line& line, float minContrast, unsigned int smoothingWidth = 1, unsigned int z = 0) const;
+  // sub-pixel edges of many probes at once, one Edges per probe, see EdgeProbe
+  std::vector<Edges> findEdges(const std::vector<EdgeProbe>& probes, unsigned int z = 0, unsigned int qtyThreads = 0) const;
 
   // morphology
-  void erode(const StructuringElement* structuringElement, unsigned int z = 0);
-  void dilate(const StructuringElement* structuringElement, unsigned int z = 0);
-  void open(const StructuringElement* structuringElement, unsigned int z = 0);
-  void close(const StructuringElement* structuringElement, unsigned int z = 0);
-
+  void erode(const StructuringElement* structuringElement, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void erode(const StructuringElement* structuringElement, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  void dilate(const StructuringElement* structuringElement, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void dilate(const StructuringElement* structuringElement, const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  void open(const StructuringElement* structuringElement, unsigned int z = 0, unsigned int qtyThreads = 0);
+  void close(const StructuringElement* structuringElement, unsigned int z = 0, unsigned int qtyThreads = 0);
+
+  // see Rotation: tiled transposition, square images and flips are rotated in place
   void mirrorOnHorizontalAxis();
   void mirrorOnVerticalAxis();
   void rotateBy90DegreeClockwise();
   void rotateBy90DegreeCounterClockwise();
   void rotateBy180Degree();
+  // rotates every layer by angle (deg, clockwise) around the center, the size is kept, pixels from outside of the image get backgroundValue
+  void rotate(float angle, PolarTransformation::Interpolation interpolation = PolarTransformation::Bilinear, T backgroundValue = 0, unsigned int qtyThreads = 0);
 
+  // rotated rectangles return Matrix<T>() like rectangles outside of the image, rotate the image first
   Matrix<T> crop(const Rectangle &cropRegion);
-  Matrix<T> doPolarTransformation(const Circle& circle);
+  // qtyThreads: 0 -> all threads of ThreadPool::getInstance(), 1 -> single threaded
+  Matrix<T> doPolarTransformation(const Circle& circle, PolarTransformation::Interpolation interpolation = PolarTransformation::NearestNeighbour, unsigned int qtyThreads = 0);
 
   void applyLookUpTable(const std::vector<T> &lookUpTable);
+  void applyLookUpTable(const std::vector<T> &lookUpTable, const Region& region);
 
   bool isPointInsideImage(const Point& point);
   bool isRectangleInsideImage(const Rectangle& rectangle);
@@ -132,10 +234,11 @@ public:
   void performanceTestAccessPixels(unsigned int mode);
   
 protected:
-  T*** m_values;
+  T** m_layers; // one buffer of the BufferPool per layer, rows are padded to a multiple of CacheLineSize bytes
   unsigned int m_width;
   unsigned int m_height;
-  unsigned int m_size;
+  unsigned int m_stride; // distance between two rows in elements
+  size_t m_size; // pixels per layer, may be more than fit into an unsigned int
   unsigned int m_qtyLayers;
 
 private:
@@ -144,17 +247,37 @@ private:
   unsigned int calculateBinomialCoefficient(unsigned int n, unsigned int k);
 
   void create();
-  void createRowBeginVector();
-  void createLayers();
   void destroy();
-  void destroyRowBeginVector();
-  void destroyLayers();
   void copy(const Matrix&);
   void print(const std::string& message);
-
-  void filterQuantilBool(const StructuringElement *structuringElement, double quantil, unsigned int z = 0);
-
-  T** m_layers;
+  void invalidateIntegralImages();
+  // points outside of the image get the value of the nearest border pixel, the layer must not be empty
+  T getClampedValue(int x, int y, unsigned int z) const;
+  // sums of the spans of a rotated rectangle, read from the integral image
+  void getSumsOfRotatedRectangle(const Rectangle& rectangle, unsigned int z, double& qtyPixels, double& sum, double& sumOfSquares) const;
+
+  template<typename IsInside, typename FillSpan>
+  void floodFillFromBorder(bool neighborhood8, const IsInside& isInside, const FillSpan& fillSpan);
+
+  static void copyView(const MatrixView<const T>& source, const MatrixView<T>& destination);
+
+  // calls operation(view) for the bounding rectangle of the region plus the halo
+  // writesOnlyInterior: the operation writes only the pixels which are at least the halo away from the border of the view,
+  // so a rectangular region is processed in place, all other regions are processed on a copy and only their pixels are copied back
+  template<typename Operation>
+  void applyInRegion(const Region& region, unsigned int z, unsigned int haloLeft, unsigned int haloTop, unsigned int haloRight, unsigned int haloBottom,
+                     bool writesOnlyInterior, const Operation& operation);
+
+  static void interleaveRow(const T* const* sources, unsigned int qtySources, T* destination, unsigned int width);
+
+  static void filterKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const Filter* filter);
+  static void filterQuantilKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement, double quantil);
+  static void filterConservativeSmoothingKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement);
+  static void erodeKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement);
+  static void dilateKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement);
+
+  mutable std::vector<std::unique_ptr<IntegralImage<T> > > m_integralImages; // one entry per layer, empty if nothing is cached
+  mutable std::mutex m_integralImagesMutex; // guards m_integralImages in the const methods, the non-const methods must not run concurrently anyway
 };
 
 // TBD type short?
@@ -175,6 +298,12 @@ public:
   bool getInvertNegativeResultValues() const {return m_invertNegativeResultValues;}
   void setInvertNegativeResultValues(bool invertNegativeResultValues) {m_invertNegativeResultValues = invertNegativeResultValues;}
 
+  // optional factors of a separable filter: value(x, y) = horizontal[x] * vertical[y]
+  // they are only used as long as they still match the values of the filter
+  void setSeparableCoefficients(const std::vector<int>& horizontal, const std::vector<int>& vertical) {m_horizontalCoefficients = horizontal; m_verticalCoefficients = vertical;}
+  const std::vector<int>& getHorizontalCoefficients() const {return m_horizontalCoefficients;}
+  const std::vector<int>& getVerticalCoefficients() const {return m_verticalCoefficients;}
+
 private:
   Filter(){}
 
@@ -182,6 +311,8 @@ private:
   bool m_invertNegativeResultValues;
   double m_preFactor;
   Point m_referencePoint;
+  std::vector<int> m_horizontalCoefficients;
+  std::vector<int> m_verticalCoefficients;
 };
 
 class StructuringElement : public Matrix<bool>
@@ -192,7 +323,7 @@ public:
   void setReferencePoint(const Point& referencePoint) {m_referencePoint = referencePoint;}
   Point getReferencePoint() const {return m_referencePoint;}
 
-  bool isValueSet(unsigned int x, unsigned int y) const {return m_values[0][y][x];}
+  bool isValueSet(unsigned int x, unsigned int y) const {return getRow(y)[x];}
 
   // TODO is this function really needed?
   unsigned int getSumOfSetValues() const
@@ -202,7 +333,7 @@ public:
     {
       for (unsigned int x = 0; x < m_width; x++)
       {
-        if (m_values[0][y][x])
+        if (getRow(y)[x])
         {
           sum++;
         }
@@ -218,17 +349,38 @@ private:
 };
 
 template<typename T>
-void Matrix<T>::setSingleLayer( T* buffer, std::vector<unsigned int> layerIndices )
+void Matrix<T>::setSingleLayer(const T* buffer, const std::vector<unsigned int>& layerIndices, unsigned int stride)
 {
   unsigned int qtyLayerIndices = layerIndices.size();
-  
-  for (unsigned int y = 0; y < m_height; y++)
+
+  for (unsigned int i = 0; i < qtyLayerIndices; i++)
   {
-    for (unsigned int x = 0; x < m_width; x++)
+    if (layerIndices[i] >= m_qtyLayers)
+    {
+      return;
+    }
+  }
+
+  if (stride == 0)
+  {
+    stride = m_width * qtyLayerIndices;
+  }
+
+  invalidateIntegralImages();
+
+  // one layer after the other, so every layer is written sequentially
+  for (unsigned int i = 0; i < qtyLayerIndices; i++)
+  {
+    unsigned int z = layerIndices[i];
+
+    for (unsigned int y = 0; y < m_height; y++)
     {
-      for (unsigned int z = 0; z < qtyLayerIndices; z++)
+      const T* source = &buffer[static_cast<size_t>(y) * stride + i];
+      T* destination = m_layers[z] + static_cast<size_t>(y) * m_stride;
+
+      for (unsigned int x = 0; x < m_width; x++, source += qtyLayerIndices)
       {
-        m_values[layerIndices[z]][y][x] = buffer[(y * m_width + x) * qtyLayerIndices + z];
+        destination[x] = *source;
       }
     }
   }
@@ -265,17 +417,42 @@ Matrix<T>::Matrix(Matrix&& rhs)
 
   m_height = rhs.m_height;
   m_width = rhs.m_width;
+  m_stride = rhs.m_stride;
   m_size = rhs.m_size;
   m_qtyLayers = rhs.m_qtyLayers;
-  m_values = rhs.m_values;
   m_layers = rhs.m_layers;
+  m_integralImages = std::move(rhs.m_integralImages);
 
   rhs.m_height = 0;
   rhs.m_width = 0;
+  rhs.m_stride = 0;
   rhs.m_size = 0;
   rhs.m_qtyLayers = 0;
-  rhs.m_values = 0; // nullptr
   rhs.m_layers = 0; // nullptr
+  rhs.m_integralImages.clear();
+}
+
+template<typename T>
+Matrix<T>::Matrix(const MatrixView<const T>& view) :
+  m_width(view.getWidth()),
+  m_height(view.getHeight()),
+  m_qtyLayers(1)
+{
+  print("view constructor");
+
+  if (m_width == 0)
+  {
+    m_width = 1;
+  }
+
+  if (m_height == 0)
+  {
+    m_height = 1;
+  }
+
+  create();
+  clear();
+  copyView(view, getView());
 }
 
 template<typename T>
@@ -315,66 +492,30 @@ Matrix<T>::Matrix(unsigned int width, unsigned int height, unsigned int qtyLayer
 template<typename T>
 void Matrix<T>::create()
 {
-  createLayers();
-  createRowBeginVector();
-}
+  m_stride = MemoryHelper::roundUp(m_width * sizeof(T), CacheLineSize) / sizeof(T);
+  m_size = static_cast<size_t>(m_width) * m_height;
 
-template<typename T>
-void Matrix<T>::createLayers()
-{
   m_layers = new T*[m_qtyLayers];
 
-  m_size = m_width * m_height;
-
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    m_layers[z] = new T[m_size];
+    m_layers[z] = static_cast<T*>(BufferPool::allocate(static_cast<size_t>(m_stride) * m_height * sizeof(T)));
   }
-}
-
-template<typename T>
-void Matrix<T>::createRowBeginVector()
-{
-  m_values = new T**[m_qtyLayers];
 
-  for (unsigned int z = 0; z < m_qtyLayers; z++)
-  {
-    m_values[z] = new T*[m_height];
-
-    for (unsigned int y = 0; y < m_height; y++)
-    {
-      m_values[z][y] = &m_layers[z][y * m_width];
-    }
-  }
+  invalidateIntegralImages();
 }
 
 template<typename T>
 void Matrix<T>::destroy()
-{
-  destroyRowBeginVector();
-  destroyLayers();
-}
-
-template<typename T>
-void Matrix<T>::destroyLayers()
 {
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    delete[] m_layers[z];
+    BufferPool::release(m_layers[z]);
   }
 
   delete[] m_layers;
-}
-
-template<typename T>
-void Matrix<T>::destroyRowBeginVector()
-{
-  for (unsigned int z = 0; z < m_qtyLayers; z++)
-  {
-    delete[] m_values[z];
-  }
 
-  delete[] m_values;
+  invalidateIntegralImages();
 }
 
 template<typename T>
@@ -419,17 +560,19 @@ Matrix<T>& Matrix<T>::operator=(Matrix&& rhs)
 
     m_height = rhs.m_height;
     m_width = rhs.m_width;
+    m_stride = rhs.m_stride;
     m_size = rhs.m_size;
     m_qtyLayers = rhs.m_qtyLayers;
-    m_values = rhs.m_values;
     m_layers = rhs.m_layers;
+    m_integralImages = std::move(rhs.m_integralImages);
 
     rhs.m_height = 0;
     rhs.m_width = 0;
+    rhs.m_stride = 0;
     rhs.m_size = 0;
     rhs.m_qtyLayers = 0;
-    rhs.m_values = 0; // nullptr
     rhs.m_layers = 0; // nullptr
+    rhs.m_integralImages.clear();
   }
   return *this;
 }
@@ -445,11 +588,12 @@ bool Matrix<T>::operator==(const Matrix& rhs)
   equal &= m_height == rhs.m_height;
   equal &= m_qtyLayers == rhs.m_qtyLayers;
 
-  if (equal)
+  for (unsigned int z = 0; z < m_qtyLayers && equal; z++)
   {
-    for (unsigned int z = 0; z < m_qtyLayers; z++)
+    for (unsigned int y = 0; y < m_height && equal; y++)
     {
-      equal &= (memcmp(m_layers[z], rhs.m_layers[z], m_width * m_height * sizeof(T)) == 0);
+      // the padding at the end of each row is not compared
+      equal &= (memcmp(getRow(y, z), rhs.getRow(y, z), m_width * sizeof(T)) == 0);
     }
   }
 
@@ -460,24 +604,149 @@ template<typename T>
 bool Matrix<T>::operator!=(const Matrix& rhs)
 {
   print("!= operator");
-  return !(this == rhs);
+  return !(*this == rhs);
 }
 
 template<typename T>
 void Matrix<T>::clear()
 {
+  invalidateIntegralImages();
+
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    memset(m_layers[z], 0, m_width * m_height * sizeof(T));
+    memset(m_layers[z], 0, static_cast<size_t>(m_stride) * m_height * sizeof(T));
   }
 }
 
 template<typename T>
 void Matrix<T>::copy(const Matrix& rhs)
 {
+  invalidateIntegralImages();
+
+  // both matrices have the same width, so they also have the same stride
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    memcpy(m_values[z][0], rhs.m_values[z][0], m_width * m_height * sizeof(T));
+    memcpy(m_layers[z], rhs.m_layers[z], static_cast<size_t>(m_stride) * m_height * sizeof(T));
+  }
+}
+
+template<typename T>
+void Matrix<T>::copyView(const MatrixView<const T>& source, const MatrixView<T>& destination)
+{
+  unsigned int width = std::min(source.getWidth(), destination.getWidth());
+  unsigned int height = std::min(source.getHeight(), destination.getHeight());
+
+  for (unsigned int y = 0; y < height; y++)
+  {
+    memcpy(destination.getRow(y), source.getRow(y), width * sizeof(T));
+  }
+}
+
+template<typename T>
+void Matrix<T>::interleaveRow(const T* const* sources, unsigned int qtySources, T* destination, unsigned int width)
+{
+  // the common cases use one pointer per source, so the compiler keeps them in registers and can vectorize the loops
+  // (writes to destination could alias a pointer array for T = unsigned char)
+  if (qtySources == 1)
+  {
+    std::copy(sources[0], sources[0] + width, destination);
+    return;
+  }
+
+  if (qtySources == 3)
+  {
+    const T* source0 = sources[0];
+    const T* source1 = sources[1];
+    const T* source2 = sources[2];
+
+    for (unsigned int x = 0; x < width; x++, destination += 3)
+    {
+      destination[0] = source0[x];
+      destination[1] = source1[x];
+      destination[2] = source2[x];
+    }
+    return;
+  }
+
+  if (qtySources == 4)
+  {
+    const T* source0 = sources[0];
+    const T* source1 = sources[1];
+    const T* source2 = sources[2];
+    const T* source3 = sources[3];
+
+    for (unsigned int x = 0; x < width; x++, destination += 4)
+    {
+      destination[0] = source0[x];
+      destination[1] = source1[x];
+      destination[2] = source2[x];
+      destination[3] = source3[x];
+    }
+    return;
+  }
+
+  for (unsigned int i = 0; i < qtySources; i++)
+  {
+    const T* source = sources[i];
+    T* it = destination + i;
+
+    for (unsigned int x = 0; x < width; x++, it += qtySources)
+    {
+      *it = source[x];
+    }
+  }
+}
+
+template<typename T>
+template<typename Operation>
+void Matrix<T>::applyInRegion(const Region& region, unsigned int z, unsigned int haloLeft, unsigned int haloTop, unsigned int haloRight, unsigned int haloBottom,
+                              bool writesOnlyInterior, const Operation& operation)
+{
+  if (z >= m_qtyLayers)
+  {
+    return;
+  }
+
+  Region clipped = region.clip(m_width, m_height);
+  if (clipped.isEmpty())
+  {
+    return;
+  }
+
+  // bounding rectangle plus halo, at the border of the image the halo is missing like for the whole layer
+  unsigned int left = clipped.getLeft() > haloLeft ? clipped.getLeft() - haloLeft : 0;
+  unsigned int top = clipped.getTop() > haloTop ? clipped.getTop() - haloTop : 0;
+  unsigned int right = std::min(m_width, clipped.getRight() + haloRight);
+  unsigned int bottom = std::min(m_height, clipped.getBottom() + haloBottom);
+
+  MatrixView<T> box = getView(z).getSubView(left, top, right - left, bottom - top);
+
+  if (writesOnlyInterior && clipped.isRectangle())
+  {
+    operation(box);
+    return;
+  }
+
+  MatrixView<const T> source = box;
+  Matrix<T> buffer(source);
+  operation(buffer.getView());
+
+  const Matrix<T>& result = buffer;
+  const std::vector<Region::Span>& spans = clipped.getSpans();
+
+  for (size_t i = 0; i < spans.size(); i++)
+  {
+    const Region::Span& span = spans[i];
+    memcpy(box.getRow(span.m_y - top) + (span.m_x - left), result.getRow(span.m_y - top) + (span.m_x - left), span.m_length * sizeof(T));
+  }
+}
+
+template<typename T>
+void Matrix<T>::invalidateIntegralImages()
+{
+  if (!m_integralImages.empty())
+  {
+    m_integralImages.clear();
   }
 }
 
@@ -495,14 +764,18 @@ void Matrix<T>::setAllValues(T value, unsigned int z)
     return;
   }
 
+  invalidateIntegralImages();
+
   if (sizeof(T) == 1)
   {
-    memset(m_layers[z], value, m_width * m_height);
+    memset(m_layers[z], value, static_cast<size_t>(m_stride) * m_height);
   }
   else
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++)
+    // the padding is set too, so the whole layer can be written in one sweep
+    T* it = m_layers[z];
+    T* end = it + static_cast<size_t>(m_stride) * m_height;
+    while (it != end)
     {
       *it++ = value;
     }
@@ -514,7 +787,7 @@ void Matrix<T>::setValue(T value, unsigned int x, unsigned int y, unsigned int z
 {
   if (x < m_width && y < m_height && z < m_qtyLayers)
   {
-    m_values[z][y][x] = value;
+    getRow(y, z)[x] = value;
   }
 }
 
@@ -523,7 +796,7 @@ T Matrix<T>::getValue(unsigned int x, unsigned int y, unsigned int z) const
 {
   if (x < m_width && y < m_height && z < m_qtyLayers)
   {
-    return m_values[z][y][x];
+    return getRow(y, z)[x];
   }
   else
   {
@@ -532,20 +805,84 @@ T Matrix<T>::getValue(unsigned int x, unsigned int y, unsigned int z) const
 }
 
 template<typename T>
-T ***Matrix<T>::getValues() const
+inline T* Matrix<T>::getRow(unsigned int y, unsigned int z)
+{
+  invalidateIntegralImages();
+  return m_layers[z] + static_cast<size_t>(y) * m_stride;
+}
+
+template<typename T>
+inline const T* Matrix<T>::getRow(unsigned int y, unsigned int z) const
+{
+  return m_layers[z] + static_cast<size_t>(y) * m_stride;
+}
+
+template<typename T>
+MatrixView<T> Matrix<T>::getView(unsigned int z)
+{
+  if (z >= m_qtyLayers)
+  {
+    return MatrixView<T>();
+  }
+
+  invalidateIntegralImages();
+
+  return MatrixView<T>(m_layers[z], m_width, m_height, m_stride);
+}
+
+template<typename T>
+MatrixView<const T> Matrix<T>::getView(unsigned int z) const
+{
+  if (z >= m_qtyLayers)
+  {
+    return MatrixView<const T>();
+  }
+
+  return MatrixView<const T>(m_layers[z], m_width, m_height, m_stride);
+}
+
+template<typename T>
+MatrixView<T> Matrix<T>::getView(const Rectangle& region, unsigned int z)
+{
+  if (region.m_angle != 0)
+  {
+    return MatrixView<T>();
+  }
+
+  return getView(z).getSubView(Converter::toUInt(region.m_origin.m_x), Converter::toUInt(region.m_origin.m_y), Converter::toUInt(region.m_width), Converter::toUInt(region.m_height));
+}
+
+template<typename T>
+MatrixView<const T> Matrix<T>::getView(const Rectangle& region, unsigned int z) const
 {
-  return m_values;
+  if (region.m_angle != 0)
+  {
+    return MatrixView<const T>();
+  }
+
+  return getView(z).getSubView(Converter::toUInt(region.m_origin.m_x), Converter::toUInt(region.m_origin.m_y), Converter::toUInt(region.m_width), Converter::toUInt(region.m_height));
 }
 
 template<typename T>
 double Matrix<T>::getSumOfAllValues(unsigned int z) const
 {
+  {
+    std::lock_guard<std::mutex> lock(m_integralImagesMutex);
+    if (z < m_integralImages.size() && m_integralImages[z])
+    {
+      return m_integralImages[z]->getSum(0, 0, m_width, m_height);
+    }
+  }
+
   double sum = 0.0;
 
-  T* it = m_values[z][0];
-  for (unsigned int i = 0; i < m_size; i++)
+  for (unsigned int y = 0; y < m_height; y++)
   {
-    sum += *it++;
+    const T* it = getRow(y, z);
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+      sum += *it++;
+    }
   }
 
   return sum;
@@ -554,115 +891,195 @@ double Matrix<T>::getSumOfAllValues(unsigned int z) const
 template<typename T>
 const T* Matrix<T>::getLayer(unsigned int z) const
 {
-  return *(m_values[z]);
+  // rows are getStride() elements apart
+  return m_layers[z];
 }
 
 template<typename T>
-const T* Matrix<T>::getSingleLayer(std::vector<unsigned int> layerIndices) const
+void Matrix<T>::getSingleLayer(const std::vector<unsigned int>& layerIndices, T* buffer, unsigned int stride, unsigned int qtyThreads) const
 {
   unsigned int qtyLayerIndices = layerIndices.size();
-  unsigned int bufferSize = m_height * m_width * qtyLayerIndices;
-  T* singleLayer = new T[bufferSize]; // TODO avoid memory leak -> recycle buffer if possible
 
-  for (unsigned int y = 0; y < m_height; y++)
+  if (qtyLayerIndices == 0 || buffer == 0)
   {
-    for (unsigned int x = 0; x < m_width; x++)
+    return;
+  }
+
+  for (unsigned int i = 0; i < qtyLayerIndices; i++)
+  {
+    if (layerIndices[i] >= m_qtyLayers)
+    {
+      return;
+    }
+  }
+
+  if (stride == 0)
+  {
+    stride = m_width * qtyLayerIndices;
+  }
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int qtyTasks = std::max(1u, std::min(qtyThreads, m_height / 16));
+
+  threadPool.run(qtyTasks, [&](unsigned int task)
+  {
+    unsigned int firstRow = static_cast<unsigned int>(static_cast<unsigned long long>(m_height) * task / qtyTasks);
+    unsigned int lastRow = static_cast<unsigned int>(static_cast<unsigned long long>(m_height) * (task + 1) / qtyTasks);
+    std::vector<const T*> sources(qtyLayerIndices);
+
+    for (unsigned int y = firstRow; y < lastRow; y++)
     {
-      for (unsigned int z = 0; z < qtyLayerIndices; z++)
+      for (unsigned int i = 0; i < qtyLayerIndices; i++)
       {
-        singleLayer[(y * m_width + x) * qtyLayerIndices + z] = m_values[layerIndices[z]][y][x] ;
+        sources[i] = m_layers[layerIndices[i]] + static_cast<size_t>(y) * m_stride;
       }
+
+      interleaveRow(&sources[0], qtyLayerIndices, buffer + static_cast<size_t>(y) * stride, m_width);
     }
-  }
+  }, qtyThreads);
+}
+
+template<typename T>
+std::vector<unsigned int> Matrix<T>::getHistogram(unsigned int z) const
+{
+  return computeHistogram(z).getBins();
+}
 
-  return singleLayer;
+template<typename T>
+std::vector<unsigned int> Matrix<T>::getHistogram(const Region& region, unsigned int z) const
+{
+  return computeHistogram(region, z).getBins();
 }
 
 template<typename T>
-std::vector<unsigned int> Matrix<T>::getHistogram(unsigned int z)
+Histogram<T> Matrix<T>::computeHistogram(unsigned int z, unsigned int qtyThreads) const
 {
-  if (std::numeric_limits<T>::is_signed && !std::numeric_limits<T>::is_integer)
+  if (z >= m_qtyLayers)
   {
-    // TODO how to implement negative values?
-    return std::vector<unsigned int>(0);
+    return Histogram<T>();
   }
 
-  std::vector<unsigned int> histogram(std::numeric_limits<T>::max() + 1); // TODO verify for big data types like long etc.
-  std::fill(histogram.begin(), histogram.end(), 0);
+  return Histogram<T>::compute(getView(z), qtyThreads);
+}
 
-  T* it = m_values[z][0];
-  for (unsigned int i = 0; i < m_size; i++)
+template<typename T>
+Histogram<T> Matrix<T>::computeHistogram(const Region& region, unsigned int z, unsigned int qtyThreads) const
+{
+  if (z >= m_qtyLayers)
   {
-    histogram[*it++]++;
+    return Histogram<T>();
   }
 
-  return histogram;
+  return Histogram<T>::compute(getView(z), region, qtyThreads);
 }
 
 template<typename T>
 RunLengthCode Matrix<T>::getRunLengthCode(T value, unsigned int z) const
 {
   RunLengthCode runLengthCode;
-  unsigned int length = 0;
 
+  if (z >= m_qtyLayers)
+  {
+    return runLengthCode;
+  }
+
+  // the runs are found row by row, so they are appended in sorted order
   for (unsigned int y = 0; y < m_height; y++)
   {
-    length = 0;
-    for (unsigned int x = 0; x < m_width; x++)
+    const T* row = getRow(y, z);
+    unsigned int x = 0;
+
+    while (x < m_width)
     {
-      if (m_values[z][y][x] == value)
+      if (row[x] != value)
       {
-        length++;
-        if (x == m_width - 1) // reached end of row?
-        {
-          runLengthCode.push_back(RunLength(Point(x - length + 1, y), length));
-          length = 0;
-        }
+        x++;
+        continue;
       }
-      else
+
+      unsigned int start = x;
+      while (x < m_width && row[x] == value)
       {
-        if (length > 0)
-        {
-          runLengthCode.push_back(RunLength(Point(x - length, y), length));
-          length = 0;
-        }
+        x++;
       }
+
+      runLengthCode.add(RunLength(static_cast<int>(start), static_cast<int>(y), x - start));
     }
   }
+
   return runLengthCode;
 }
 
 template<typename T>
 double Matrix<T>::getAverageAlongLine(const Line &line, unsigned int z) const
 {
-  double average = 0.0;
+  if (z >= m_qtyLayers || m_width == 0 || m_height == 0 || line.getQtyPointsAlongLine() == 0)
+  {
+    return 0.0;
+  }
+
+  double sum = 0.0;
+  unsigned int qtyPoints = 0;
+  bool isInsideImage = false;
 
-  Points points = line.getPointsAlongLine();
+  line.visitPointsAlongLine([&](int x, int y)
+  {
+    isInsideImage = isInsideImage || (x >= 0 && y >= 0 && static_cast<unsigned int>(x) < m_width && static_cast<unsigned int>(y) < m_height);
+    sum += getClampedValue(x, y, z);
+    qtyPoints++;
+  });
 
-  for (auto it = points.begin(); it != points.end(); it++)
+  if (!isInsideImage)
   {
-    average += m_values[z][Converter::toUInt(it->m_y)][Converter::toUInt(it->m_x)];
+    return 0.0;
   }
 
-  average /= points.size();
+  return sum / qtyPoints;
+}
+
+template<typename T>
+T Matrix<T>::getClampedValue(int x, int y, unsigned int z) const
+{
+  unsigned int clampedX = x < 0 ? 0 : std::min(static_cast<unsigned int>(x), m_width - 1);
+  unsigned int clampedY = y < 0 ? 0 : std::min(static_cast<unsigned int>(y), m_height - 1);
+
+  return getRow(clampedY, z)[clampedX];
+}
 
-  return average;
+template<typename T>
+Statistics<T> Matrix<T>::getStatistics(const RunLengthCode& runLengthCode, unsigned int z) const
+{
+  return getStatistics(Region(runLengthCode), z);
 }
 
 template<typename T>
-Statistics<T> Matrix<T>::getStatistics(const RunLengthCode& runLengthCode, unsigned int z)
+Statistics<T> Matrix<T>::getStatistics(const Region& region, unsigned int z) const
 {
   Statistics<T> statistics;
 
-  unsigned int qtyPixels = 0;
+  if (z >= m_qtyLayers)
+  {
+    return statistics;
+  }
+
+  size_t qtyPixels = 0;
   double sumOfPixels = 0.0;
+  double sumOfSquares = 0.0;
+
+  Region clipped = region.clip(m_width, m_height);
+  const std::vector<Region::Span>& spans = clipped.getSpans();
 
-  for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
+  for (size_t i = 0; i < spans.size(); i++)
   {
-    qtyPixels += it->m_length;
+    qtyPixels += spans[i].m_length;
 
-    T* ptr = &m_values[z][Converter::toUInt(it->m_startPoint.m_y)][Converter::toUInt(it->m_startPoint.m_x)];
-    for (unsigned int i = 0; i < it->m_length; i++, ptr++)
+    const T* ptr = getRow(spans[i].m_y, z) + spans[i].m_x;
+    for (unsigned int x = 0; x < spans[i].m_length; x++, ptr++)
     {
       if (*ptr < statistics.minimum)
       {
@@ -675,68 +1092,194 @@ Statistics<T> Matrix<T>::getStatistics(const RunLengthCode& runLengthCode, unsig
       }
 
       sumOfPixels += *ptr;
+      sumOfSquares += static_cast<double>(*ptr) * *ptr;
     }
   }
 
   if (qtyPixels > 0)
   {
     statistics.meanValue = sumOfPixels / qtyPixels;
+    statistics.variance = std::max(0.0, sumOfSquares / qtyPixels - statistics.meanValue * statistics.meanValue);
   }
 
   return statistics;
 }
 
 template<typename T>
-void Matrix<T>::setRandomValues()
+std::vector<Blob<T> > Matrix<T>::getBlobs(T objectValue, unsigned int z, bool neighborhood8, unsigned int qtyThreads) const
 {
-  for (unsigned int z = 0; z < m_qtyLayers; z++)
-  {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++)
-    {
-      *it++ = rand();
-    }
-  }
+  return getBlobs(objectValue, *this, z, neighborhood8, qtyThreads);
 }
 
 template<typename T>
-void Matrix<T>::setBinomialValues(unsigned int z)
+template<typename U>
+std::vector<Blob<U> > Matrix<T>::getBlobs(T objectValue, const Matrix<U>& values, unsigned int z, bool neighborhood8, unsigned int qtyThreads) const
 {
-  for (unsigned int y = 0; y < m_height; y++)
+  if (z >= m_qtyLayers || z >= values.getQtyLayers())
   {
-    for (unsigned int x = 0; x < m_width; x++)
-    {
-      m_values[z][y][x] = calculateBinomialCoefficient(m_width - 1, x) * calculateBinomialCoefficient(m_height - 1, y);
-    }
+    return std::vector<Blob<U> >();
   }
+
+  return Labeling::getBlobs(getView(z), objectValue, values.getView(z), neighborhood8, qtyThreads);
 }
 
 template<typename T>
-void Matrix<T>::binarize(T threshold)
+const IntegralImage<T>& Matrix<T>::getIntegralImage(unsigned int z) const
 {
-  for (unsigned int z = 0; z < m_qtyLayers; z++)
+  if (z >= m_qtyLayers)
+  {
+    static const IntegralImage<T> empty;
+    return empty;
+  }
+
+  // an integral image is only freed by the non-const methods, so the returned reference stays valid for the other const calls
+  std::lock_guard<std::mutex> lock(m_integralImagesMutex);
+
+  if (m_integralImages.size() != m_qtyLayers)
+  {
+    m_integralImages.resize(m_qtyLayers);
+  }
+
+  if (!m_integralImages[z])
+  {
+    m_integralImages[z].reset(new IntegralImage<T>(getView(z)));
+  }
+
+  return *m_integralImages[z];
+}
+
+template<typename T>
+void Matrix<T>::getSumsOfRotatedRectangle(const Rectangle& rectangle, unsigned int z, double& qtyPixels, double& sum, double& sumOfSquares) const
+{
+  qtyPixels = 0.0;
+  sum = 0.0;
+  sumOfSquares = 0.0;
+
+  if (z >= m_qtyLayers)
+  {
+    return;
+  }
+
+  const IntegralImage<T>& integralImage = getIntegralImage(z);
+  Region region = Region(rectangle).clip(m_width, m_height);
+  const std::vector<Region::Span>& spans = region.getSpans();
+
+  for (size_t i = 0; i < spans.size(); i++)
+  {
+    qtyPixels += spans[i].m_length;
+    sum += static_cast<double>(integralImage.getSum(spans[i].m_x, spans[i].m_y, spans[i].m_length, 1));
+    sumOfSquares += static_cast<double>(integralImage.getSumOfSquares(spans[i].m_x, spans[i].m_y, spans[i].m_length, 1));
+  }
+}
+
+template<typename T>
+double Matrix<T>::getMean(const Rectangle& region, unsigned int z) const
+{
+  if (region.m_angle != 0)
+  {
+    double qtyPixels, sum, sumOfSquares;
+    getSumsOfRotatedRectangle(region, z, qtyPixels, sum, sumOfSquares);
+    return qtyPixels > 0 ? sum / qtyPixels : 0.0;
+  }
+
+  return getIntegralImage(z).getMean(Converter::toUInt(region.m_origin.m_x), Converter::toUInt(region.m_origin.m_y), Converter::toUInt(region.m_width), Converter::toUInt(region.m_height));
+}
+
+template<typename T>
+double Matrix<T>::getVariance(const Rectangle& region, unsigned int z) const
+{
+  if (region.m_angle != 0)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++)
+    double qtyPixels, sum, sumOfSquares;
+    getSumsOfRotatedRectangle(region, z, qtyPixels, sum, sumOfSquares);
+    if (qtyPixels == 0)
     {
-      if (*it < threshold)
-      {
-        *it = std::numeric_limits<T>::min();
-      }
-      else
+      return 0.0;
+    }
+
+    double mean = sum / qtyPixels;
+    return std::max(0.0, sumOfSquares / qtyPixels - mean * mean);
+  }
+
+  return getIntegralImage(z).getVariance(Converter::toUInt(region.m_origin.m_x), Converter::toUInt(region.m_origin.m_y), Converter::toUInt(region.m_width), Converter::toUInt(region.m_height));
+}
+
+template<typename T>
+void Matrix<T>::setRandomValues()
+{
+  for (unsigned int z = 0; z < m_qtyLayers; z++)
+  {
+    for (unsigned int y = 0; y < m_height; y++)
+    {
+      T* it = getRow(y, z);
+      for (unsigned int x = 0; x < m_width; x++)
       {
-        *it = std::numeric_limits<T>::max();
+        *it++ = rand();
       }
-      it++;
     }
   }
 }
 
+template<typename T>
+void Matrix<T>::setBinomialValues(unsigned int z)
+{
+  for (unsigned int y = 0; y < m_height; y++)
+  {
+    for (unsigned int x = 0; x < m_width; x++)
+    {
+      unsigned int value = calculateBinomialCoefficient(m_width - 1, x) * calculateBinomialCoefficient(m_height - 1, y);
+      getRow(y, z)[x] = std::is_same<T, bool>::value ? static_cast<T>(value != 0) : static_cast<T>(value);
+    }
+  }
+}
+
+template<typename T>
+PointOperations<T> Matrix<T>::pointOperations(unsigned int z)
+{
+  return PointOperations<T>(getView(z));
+}
+
+template<typename T>
+void Matrix<T>::binarize(T threshold)
+{
+  for (unsigned int z = 0; z < m_qtyLayers; z++)
+  {
+    pointOperations(z).binarize(threshold).apply();
+  }
+}
+
+template<typename T>
+void Matrix<T>::binarize(T threshold, const Region& region)
+{
+  for (unsigned int z = 0; z < m_qtyLayers; z++)
+  {
+    pointOperations(z).binarize(threshold).apply(region);
+  }
+}
+
 template<typename T>
 void Matrix<T>::spread()
 {
-  T maximum = getMaximum();
-  T minimum = getMinimum();
+  T maximum;
+  T minimum;
+
+  if (Histogram<T>::isSupported())
+  {
+    // one parallel pass over every layer instead of a pass for the minimum and one for the maximum
+    Histogram<T> histogram = computeHistogram(0);
+    for (unsigned int z = 1; z < m_qtyLayers; z++)
+    {
+      histogram.add(computeHistogram(z));
+    }
+
+    maximum = histogram.getMaximum();
+    minimum = histogram.getMinimum();
+  }
+  else
+  {
+    maximum = getMaximum();
+    minimum = getMinimum();
+  }
 
   if ((maximum - minimum) == 0)
   {
@@ -747,24 +1290,43 @@ void Matrix<T>::spread()
 
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++)
-    {
-      if (std::numeric_limits<T>::is_signed)
-      {
-        // TODO define spread-function for signed types
-      }
-      else
-      {
-        if (minimum != 0)
-        {
-          *it -= minimum;
-        }
+    pointOperations(z).spread(minimum, maximum).apply();
+  }
+}
 
-        *it *= std::numeric_limits<T>::max() / (maximum - minimum);
-      }
-    }
+template<typename T>
+void Matrix<T>::autoContrast(double lowerQuantil, double upperQuantil, unsigned int z)
+{
+  autoContrast(computeHistogram(z), lowerQuantil, upperQuantil, z);
+}
+
+template<typename T>
+void Matrix<T>::autoContrast(const Histogram<T>& histogram, double lowerQuantil, double upperQuantil, unsigned int z)
+{
+  if (std::numeric_limits<T>::is_signed || histogram.getQtyValues() == 0 || z >= m_qtyLayers)
+  {
+    return;
   }
+
+  double lower = histogram.getQuantil(lowerQuantil);
+  double upper = histogram.getQuantil(upperQuantil);
+
+  if (upper <= lower)
+  {
+    return; // avoid division by zero
+  }
+
+  double maximum = std::numeric_limits<T>::max();
+  double factor = maximum / (upper - lower);
+
+  std::vector<T> lookUpTable(histogram.getQtyBins());
+  for (unsigned int i = 0; i < lookUpTable.size(); i++)
+  {
+    double value = (Histogram<T>::getValue(i) - lower) * factor + 0.5;
+    lookUpTable[i] = static_cast<T>(std::min(std::max(value, 0.0), maximum));
+  }
+
+  pointOperations(z).lookUpTable(lookUpTable).apply();
 }
 
 template<typename T>
@@ -818,13 +1380,13 @@ void Matrix<T>::setRow(T value, unsigned int y, unsigned int z)
 
   if (sizeof(T) == 1)
   {
-    memset(m_values[z][y], value, m_width);
+    memset(getRow(y, z), value, m_width);
   }
   else
   {
     for (unsigned int x = 0; x < m_width; x++)
     {
-      m_values[z][y][x] = value;
+      getRow(y, z)[x] = value;
     }
   }
 }
@@ -839,7 +1401,7 @@ void Matrix<T>::setColumn(T value, unsigned int x, unsigned int z)
 
   for (unsigned int y = 0; y < m_width; y++)
   {
-    m_values[z][y][x] = value;
+    getRow(y, z)[x] = value;
   }
 }
 
@@ -850,7 +1412,7 @@ void Matrix<T>::setPoint(T value, const Point &point, unsigned int z)
   {
     return;
   }
-  m_values[z][Converter::toUInt(point.m_y)][Converter::toUInt(point.m_x)] = value;
+  getRow(Converter::toUInt(point.m_y), z)[Converter::toUInt(point.m_x)] = value;
 }
 
 template<typename T>
@@ -869,13 +1431,13 @@ void Matrix<T>::setRectangle(T value, const Rectangle &rectangle, bool fill, uns
       {
         if (sizeof(T) == 1)
         {
-          memset(&(m_values[z][y][Converter::toUInt(rectangle.m_origin.m_x)]), value, rectangle.m_width);
+          memset(&(getRow(y, z)[Converter::toUInt(rectangle.m_origin.m_x)]), value, rectangle.m_width);
         }
         else
         {
           for (unsigned int x = rectangle.m_origin.m_x; x < (Converter::toUInt(rectangle.m_origin.m_x) + rectangle.m_width); x++)
           {
-            m_values[z][y][x] = value;
+            getRow(y, z)[x] = value;
           }
         }
       }
@@ -885,14 +1447,14 @@ void Matrix<T>::setRectangle(T value, const Rectangle &rectangle, bool fill, uns
       for (unsigned int x = rectangle.m_origin.m_x; x < (rectangle.m_origin.m_x + rectangle.m_width); x++)
       {
         // TODO use memset if sizeof(T) == 1
-        m_values[z][Converter::toUInt(rectangle.m_origin.m_y)][x] = value;
-        m_values[z][Converter::toUInt(rectangle.m_origin.m_y) + Converter::toUInt(rectangle.m_height) - 1][x] = value;
+        getRow(Converter::toUInt(rectangle.m_origin.m_y), z)[x] = value;
+        getRow(Converter::toUInt(rectangle.m_origin.m_y) + Converter::toUInt(rectangle.m_height) - 1, z)[x] = value;
       }
 
       for (unsigned int y = rectangle.m_origin.m_y + 1; y < (rectangle.m_origin.m_y + rectangle.m_height - 1); y++)
       {
-        m_values[z][y][Converter::toUInt(rectangle.m_origin.m_x)] = value;
-        m_values[z][y][Converter::toUInt(rectangle.m_origin.m_x) + Converter::toUInt(rectangle.m_width) - 1] = value;
+        getRow(y, z)[Converter::toUInt(rectangle.m_origin.m_x)] = value;
+        getRow(y, z)[Converter::toUInt(rectangle.m_origin.m_x) + Converter::toUInt(rectangle.m_width) - 1] = value;
       }
     }
   }
@@ -928,7 +1490,7 @@ void Matrix<T>::setLine(T value, const Line & line, bool drawArrow, unsigned int
 
     for (unsigned int y = min; y <= max; y++)
     {
-      m_values[z][y][Converter::toUInt(p1.m_x)] = value;
+      getRow(y, z)[Converter::toUInt(p1.m_x)] = value;
     }
   }
   else if (p1.m_y == p2.m_y)
@@ -939,13 +1501,13 @@ void Matrix<T>::setLine(T value, const Line & line, bool drawArrow, unsigned int
 
     if (sizeof(T) == 1)
     {
-      memset(&m_values[z][Converter::toUInt(p1.m_y)][min], value, max - min + 1);
+      memset(&getRow(Converter::toUInt(p1.m_y), z)[min], value, max - min + 1);
     }
     else
     {
       for (unsigned int x = min; x <= max; x++)
       {
-        m_values[z][Converter::toUInt(p1.m_y)][x] = value;
+        getRow(Converter::toUInt(p1.m_y), z)[x] = value;
       }
     }
   }
@@ -965,7 +1527,7 @@ void Matrix<T>::setLine(T value, const Line & line, bool drawArrow, unsigned int
 
     while (true)
     {
-      m_values[z][y0][x0] = value;
+      getRow(y0, z)[x0] = value;
 
       if (x0 == x1 && y0 == y1)
       {
@@ -1019,14 +1581,14 @@ void Matrix<T>::setCircle(T value, const Circle &circle, bool fill, unsigned int
     {
       for (int xx = -x; xx <= x; xx++)
       {
-        m_values[z][Converter::toUInt(circle.m_center.m_y) + y][Converter::toUInt(circle.m_center.m_x) + xx] = value; // Octant 1 + Octant 4
-        m_values[z][Converter::toUInt(circle.m_center.m_y) - y][Converter::toUInt(circle.m_center.m_x) + xx] = value; // Octant 5 + Octant 8
+        getRow(Converter::toUInt(circle.m_center.m_y) + y, z)[Converter::toUInt(circle.m_center.m_x) + xx] = value; // Octant 1 + Octant 4
+        getRow(Converter::toUInt(circle.m_center.m_y) - y, z)[Converter::toUInt(circle.m_center.m_x) + xx] = value; // Octant 5 + Octant 8
       }
 
       for (int yy = -y; yy <= y; yy++)
       {
-        m_values[z][Converter::toUInt(circle.m_center.m_y) + x][Converter::toUInt(circle.m_center.m_x) + yy] = value; // Octant 2 + Octant 3
-        m_values[z][Converter::toUInt(circle.m_center.m_y) - x][Converter::toUInt(circle.m_center.m_x) + yy] = value; // Octant 6 + Octant 7
+        getRow(Converter::toUInt(circle.m_center.m_y) + x, z)[Converter::toUInt(circle.m_center.m_x) + yy] = value; // Octant 2 + Octant 3
+        getRow(Converter::toUInt(circle.m_center.m_y) - x, z)[Converter::toUInt(circle.m_center.m_x) + yy] = value; // Octant 6 + Octant 7
       }
 
       // IP memset for sizeof(T) == 1
@@ -1039,15 +1601,15 @@ void Matrix<T>::setCircle(T value, const Circle &circle, bool fill, unsigned int
     }
     else
     {
-      m_values[z][Converter::toUInt(circle.m_center.m_y) + y][Converter::toUInt(circle.m_center.m_x) + x] = value; // Octant 1
-      m_values[z][Converter::toUInt(circle.m_center.m_y) + x][Converter::toUInt(circle.m_center.m_x) + y] = value; // Octant 2
-      m_values[z][Converter::toUInt(circle.m_center.m_y) + x][Converter::toUInt(circle.m_center.m_x) - y] = value; // Octant 3
-      m_values[z][Converter::toUInt(circle.m_center.m_y) + y][Converter::toUInt(circle.m_center.m_x) - x] = value; // Octant 4
+      getRow(Converter::toUInt(circle.m_center.m_y) + y, z)[Converter::toUInt(circle.m_center.m_x) + x] = value; // Octant 1
+      getRow(Converter::toUInt(circle.m_center.m_y) + x, z)[Converter::toUInt(circle.m_center.m_x) + y] = value; // Octant 2
+      getRow(Converter::toUInt(circle.m_center.m_y) + x, z)[Converter::toUInt(circle.m_center.m_x) - y] = value; // Octant 3
+      getRow(Converter::toUInt(circle.m_center.m_y) + y, z)[Converter::toUInt(circle.m_center.m_x) - x] = value; // Octant 4
 
-      m_values[z][Converter::toUInt(circle.m_center.m_y) - y][Converter::toUInt(circle.m_center.m_x) - x] = value; // Octant 5
-      m_values[z][Converter::toUInt(circle.m_center.m_y) - x][Converter::toUInt(circle.m_center.m_x) - y] = value; // Octant 6
-      m_values[z][Converter::toUInt(circle.m_center.m_y) - x][Converter::toUInt(circle.m_center.m_x) + y] = value; // Octant 7
-      m_values[z][Converter::toUInt(circle.m_center.m_y) - y][Converter::toUInt(circle.m_center.m_x) + x] = value; // Octant 8
+      getRow(Converter::toUInt(circle.m_center.m_y) - y, z)[Converter::toUInt(circle.m_center.m_x) - x] = value; // Octant 5
+      getRow(Converter::toUInt(circle.m_center.m_y) - x, z)[Converter::toUInt(circle.m_center.m_x) - y] = value; // Octant 6
+      getRow(Converter::toUInt(circle.m_center.m_y) - x, z)[Converter::toUInt(circle.m_center.m_x) + y] = value; // Octant 7
+      getRow(Converter::toUInt(circle.m_center.m_y) - y, z)[Converter::toUInt(circle.m_center.m_x) + x] = value; // Octant 8
     }
 
     y++;
@@ -1175,9 +1737,18 @@ void Matrix<T>::setHistogram(const std::vector<unsigned int> &histogram, unsigne
 template<typename T>
 void Matrix<T>::setRunLengthCode(T value, const RunLengthCode &runLengthCode, unsigned int z)
 {
-  for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
+  if (z >= m_qtyLayers)
+  {
+    return;
+  }
+
+  Region clipped = Region(runLengthCode).clip(m_width, m_height);
+  const std::vector<Region::Span>& spans = clipped.getSpans();
+
+  for (size_t i = 0; i < spans.size(); i++)
   {
-    setLine(value, Line(it->m_startPoint, Point(it->m_startPoint.m_x + it->m_length - 1, it->m_startPoint.m_y)), z);
+    T* row = getRow(spans[i].m_y, z) + spans[i].m_x;
+    std::fill(row, row + spans[i].m_length, value);
   }
 }
 
@@ -1217,136 +1788,160 @@ void Matrix<T>::setStructureElement(T value, const StructuringElement *structuri
     {
       if (structuringElement->getValue(x, y))
       {
-        m_values[z][y + dy][x + dx] = value;
+        getRow(y + dy, z)[x + dx] = value;
       }
     }
   }
 }
 
 template<typename T>
-void Matrix<T>::filter(const Filter *filter, unsigned int z)
+void Matrix<T>::filter(const Filter *filter, unsigned int z, unsigned int qtyThreads)
 {
-  Matrix<T> original(*this);
+  this->filter(filter, getView(z), qtyThreads);
+}
 
-  short*** filterValues = filter->getValues();
+template<typename T>
+void Matrix<T>::filter(const Filter* filter, const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (view.isEmpty())
+  {
+    return;
+  }
 
-  unsigned int offsetLeft = filter->getReferencePoint().m_x;
   unsigned int offsetTop = filter->getReferencePoint().m_y;
-  unsigned int offsetRight = filter->getWidth() - offsetLeft - 1;
   unsigned int offsetBottom = filter->getHeight() - offsetTop - 1;
 
-  double calculatedValue;
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  BandScheduler::runInPlace(view, offsetTop, offsetBottom, qtyThreads, [&](const MatrixView<const T>& source, const MatrixView<T>& destination)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
-    {
-      calculatedValue = 0;
-      for (unsigned int fy = 0; fy < filter->getHeight(); fy++)
-      {
-        for (unsigned int fx = 0; fx < filter->getWidth(); fx++)
-        {
-          calculatedValue += original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft] * filterValues[0][fy][fx];
-        }
-      }
-      calculatedValue *= filter->getPreFactor();
-      calculatedValue > 0 ? calculatedValue += 0.5 : calculatedValue -= 0.5;
+    filterKernel(source, destination, filter);
+  });
+}
 
-      if (filter->getShiftResultValues())
-      {
-        calculatedValue += ((std::numeric_limits<T>::max() - std::numeric_limits<T>::min()) / 2);
-      }
+template<typename T>
+template<typename Kernel>
+void Matrix<T>::filter(unsigned int z, unsigned int qtyThreads)
+{
+  filter<Kernel>(getView(z), qtyThreads);
+}
 
-      if (filter->getInvertNegativeResultValues())
-      {
-        if (calculatedValue < 0)
-        {
-          calculatedValue *= -1;
-        }
-      }
+template<typename T>
+template<typename Kernel>
+void Matrix<T>::filter(const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (view.isEmpty())
+  {
+    return;
+  }
 
-      if (calculatedValue < std::numeric_limits<T>::min())
-      {
-        calculatedValue = std::numeric_limits<T>::min();
-      }
+  BandScheduler::runInPlace(view, Kernel::OffsetTop, Kernel::OffsetBottom, qtyThreads, [](const MatrixView<const T>& source, const MatrixView<T>& destination)
+  {
+    Kernel::template apply<T>(source, destination);
+  });
+}
 
-      if (calculatedValue > std::numeric_limits<T>::max())
-      {
-        calculatedValue = std::numeric_limits<T>::max();
-      }
+template<typename T>
+void Matrix<T>::filter(const Filter* filter, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = filter->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = filter->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = filter->getHeight() - haloTop - 1;
 
-      m_values[z][y][x] = calculatedValue;
-    }
-  }
+  applyInRegion(region, z, haloLeft, haloTop, haloRight, haloBottom, true, [&](const MatrixView<T>& view)
+  {
+    this->filter(filter, view, qtyThreads);
+  });
 }
 
 template<typename T>
-void Matrix<T>::filterQuantilBool(const StructuringElement* structuringElement, double quantil, unsigned int z)
+void Matrix<T>::filterMean(unsigned int width, unsigned int height, unsigned int z, unsigned int qtyThreads)
 {
-  Matrix<T> original(*this);
-
-  unsigned int offsetLeft = structuringElement->getReferencePoint().m_x;
-  unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
-  unsigned int offsetRight = structuringElement->getWidth() - offsetLeft - 1;
-  unsigned int offsetBottom = structuringElement->getHeight() - offsetTop - 1;
+  filterMean(width, height, getView(z), qtyThreads);
+}
 
-  unsigned int sumOfSetValues = structuringElement->getSumOfSetValues();
-  unsigned int sum = 0;
+template<typename T>
+void Matrix<T>::filterMean(unsigned int width, unsigned int height, const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (height == 0)
+  {
+    height = width;
+  }
 
-  unsigned int threshold = quantil * sumOfSetValues;
-  if (threshold > structuringElement->getSumOfSetValues() - 1)
+  if (view.isEmpty() || width == 0)
   {
-    threshold = structuringElement->getSumOfSetValues() - 1;
+    return;
   }
 
-  RunLengthCode runLengthCode = structuringElement->getRunLengthCode(true);
+  // same filter as FilterGenerator::mean, small integer types are filtered with an integral image
+  ConvolutionKernel kernel;
+  kernel.m_width = width;
+  kernel.m_height = height;
+  kernel.m_offsetLeft = width / 2;
+  kernel.m_offsetTop = height / 2;
+  kernel.m_preFactor = 1.0 / (width * height);
+  kernel.m_values.assign(width * height, 1);
+  kernel.setSeparableCoefficients(std::vector<int>(width, 1), std::vector<int>(height, 1));
 
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  BandScheduler::runInPlace(view, kernel.m_offsetTop, height - kernel.m_offsetTop - 1, qtyThreads, [&](const MatrixView<const T>& source, const MatrixView<T>& destination)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
-    {
-      if (x == offsetLeft)
-      {
-        sum = 0;
+    Convolution<T>::apply(source, destination, kernel);
+  });
+}
 
-        for (unsigned int fy = 0; fy < structuringElement->getHeight(); fy++)
-        {
-          for (unsigned int fx = 0; fx < structuringElement->getWidth(); fx++)
-          {
-            if (structuringElement->isValueSet(fx, fy) && original.m_values[z][y + fy - offsetTop][fx])
-            {
-              sum++;
-            }
-          }
-        }
-      }
-      else
-      {
-        for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
-        {
-          unsigned int dx = x - offsetLeft + it->m_startPoint.m_x - 1;
+template<typename T>
+void Matrix<T>::filterMean(unsigned int width, unsigned int height, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  if (height == 0)
+  {
+    height = width;
+  }
 
-          // remove entry of left side
-          if (original.m_values[z][y - offsetTop + Converter::toUInt(it->m_startPoint.m_y)][dx])
-          {
-            sum--;
-          }
+  if (width == 0)
+  {
+    return;
+  }
 
-          // add entry of right side
-          if (original.m_values[z][y - offsetTop + Converter::toUInt(it->m_startPoint.m_y)][dx + it->m_length])
-          {
-            sum++;
-          }
-        }
-      }
+  applyInRegion(region, z, width / 2, height / 2, width - width / 2 - 1, height - height / 2 - 1, true, [&](const MatrixView<T>& view)
+  {
+    filterMean(width, height, view, qtyThreads);
+  });
+}
 
-      m_values[z][y][x] = (sum > threshold);
-    }
+template<typename T>
+void Matrix<T>::filterKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const Filter* filter)
+{
+  ConvolutionKernel kernel;
+  kernel.m_width = filter->getWidth();
+  kernel.m_height = filter->getHeight();
+  kernel.m_offsetLeft = filter->getReferencePoint().m_x;
+  kernel.m_offsetTop = filter->getReferencePoint().m_y;
+  kernel.m_preFactor = filter->getPreFactor();
+  kernel.m_shiftResultValues = filter->getShiftResultValues();
+  kernel.m_invertNegativeResultValues = filter->getInvertNegativeResultValues();
+
+  kernel.m_values.reserve(kernel.m_width * kernel.m_height);
+  for (unsigned int fy = 0; fy < kernel.m_height; fy++)
+  {
+    const short* filterRow = filter->getRow(fy);
+    kernel.m_values.insert(kernel.m_values.end(), filterRow, filterRow + kernel.m_width);
   }
+
+  // separable filters are processed as a horizontal and a vertical pass
+  kernel.setSeparableCoefficients(filter->getHorizontalCoefficients(), filter->getVerticalCoefficients());
+  if (!kernel.isSeparable())
+  {
+    kernel.findSeparableCoefficients();
+  }
+
+  Convolution<T>::apply(source, destination, kernel);
 }
 
 template<typename T>
 void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
 {
+  invalidateIntegralImages();
+
   /*
     Mac OS 10.11.3 - Qt 5.2.0 clang 64bit - width = height = 65535
     method 0 took 2050 milliseconds
@@ -1371,6 +1966,7 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
 
   // method 3 should be the best - matrix should have additional parameter m_size which is calculated each time the width or height changes
   // m_size must be <= size_t
+  // the methods 2 - 6 also write the padding at the end of each row
 
   if (mode == 0)
   {
@@ -1378,7 +1974,7 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
     {
       for (unsigned int x = 0; x < m_width; x++)
       {
-        m_values[0][y][x] = 255;
+        getRow(y)[x] = 255;
       }
     }
   }
@@ -1388,13 +1984,13 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
     {
       for (unsigned int x = 0; x < m_width; x++)
       {
-        m_values[0][0][y * m_width + x] = 255;
+        m_layers[0][y * m_stride + x] = 255;
       }
     }
   }
   else if (mode == 2)
   {
-    T* it = m_values[0][0];
+    T* it = m_layers[0];
     for (unsigned int y = 0; y < m_height; y++)
     {
       for (unsigned int x = 0; x < m_width; x++)
@@ -1405,8 +2001,8 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
   }
   else if (mode == 3)
   {
-    T* it = m_values[0][0];
-    unsigned int size = m_height * m_width;
+    T* it = m_layers[0];
+    unsigned int size = m_height * m_stride;
     for (unsigned int y = 0; y < size; y++)
     {
       *it++ = 255;
@@ -1414,12 +2010,12 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
   }
   else if (mode == 4)
   {
-    memset(m_values[0][0], 255, m_height * m_width);
+    memset(m_layers[0], 255, m_height * m_stride * sizeof(T));
   }
   else if (mode == 5)
   {
-    T* it = m_values[0][0];
-    T* stop = &m_values[0][0][m_width * m_height - 1];
+    T* it = m_layers[0];
+    T* stop = &m_layers[0][m_stride * m_height - 1];
 
     while (it != stop)
     {
@@ -1429,8 +2025,8 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
   }
   else if (mode == 6)
   {
-    T* it = m_values[0][0];
-    T* stop = &m_values[0][0][m_width * m_height - 1];
+    T* it = m_layers[0];
+    T* stop = &m_layers[0][m_stride * m_height - 1];
 
     while (it <= stop)
     {
@@ -1440,145 +2036,109 @@ void Matrix<T>::performanceTestAccessPixels(unsigned int mode)
 }
 
 template<typename T>
-void Matrix<T>::filterQuantil(const StructuringElement* structuringElement, double quantil, unsigned int z)
+void Matrix<T>::filterQuantil(const StructuringElement* structuringElement, double quantil, unsigned int z, unsigned int qtyThreads)
+{
+  filterQuantil(structuringElement, quantil, getView(z), qtyThreads);
+}
+
+template<typename T>
+void Matrix<T>::filterQuantil(const StructuringElement* structuringElement, double quantil, const MatrixView<T>& view, unsigned int qtyThreads)
 {
   if (quantil < 0.0 || quantil > 1.0)
   {
     return; // TODO throw exception ?
   }
 
-  if (typeid(bool) == typeid(T))
+  if (view.isEmpty())
   {
-    filterQuantilBool(structuringElement, quantil, z);
     return;
   }
 
-  if (std::numeric_limits<T>::is_signed || !std::numeric_limits<T>::is_integer)
+  // binary images are processed with one bit per pixel
+  if (std::is_same<T, bool>::value)
   {
-    return; // TODO throw exception ?
+    BinaryImage binaryImage(MatrixView<const T>(view), static_cast<T>(true));
+    binaryImage.filterQuantil(structuringElement, quantil, qtyThreads);
+    binaryImage.copyTo(view, static_cast<T>(false), static_cast<T>(true));
+    return;
   }
 
-  Matrix<T> original(*this);
-
-  unsigned int offsetLeft = structuringElement->getReferencePoint().m_x;
   unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
-  unsigned int offsetRight = structuringElement->getWidth() - offsetLeft - 1;
   unsigned int offsetBottom = structuringElement->getHeight() - offsetTop - 1;
 
-  unsigned long long histogram[sizeof(T) * 256];
-  unsigned long long median = 0;
-  unsigned int lessThanMedian = 0;
-  unsigned int sumOfSetValues = structuringElement->getSumOfSetValues();
-
-  unsigned int threshold = quantil * sumOfSetValues;
-  if (threshold > structuringElement->getSumOfSetValues() - 1)
+  BandScheduler::runInPlace(view, offsetTop, offsetBottom, qtyThreads, [&](const MatrixView<const T>& source, const MatrixView<T>& destination)
   {
-    threshold = structuringElement->getSumOfSetValues() - 1;
-  }
+    filterQuantilKernel(source, destination, structuringElement, quantil);
+  });
+}
 
-  RunLengthCode runLengthCode = structuringElement->getRunLengthCode(true);
+template<typename T>
+void Matrix<T>::filterQuantil(const StructuringElement* structuringElement, double quantil, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = structuringElement->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = structuringElement->getHeight() - haloTop - 1;
 
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  applyInRegion(region, z, haloLeft, haloTop, haloRight, haloBottom, true, [&](const MatrixView<T>& view)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
-    {
-      if (x == offsetLeft)
-      {
-        // Set up histogram for the first window (in every line)
-        memset(histogram, 0, sizeof(histogram));
-
-        for (unsigned int fy = 0; fy < structuringElement->getHeight(); fy++)
-        {
-          for (unsigned int fx = 0; fx < structuringElement->getWidth(); fx++)
-          {
-            if (structuringElement->isValueSet(fx, fy))
-            {
-              histogram[original.m_values[z][y + fy - offsetTop][fx]]++;
-            }
-          }
-        }
+    filterQuantil(structuringElement, quantil, view, qtyThreads);
+  });
+}
 
-        // find median by moving through the histogram bins
-        int sum = 0;
-        for (int i = 0; i < 256; i++)
-        {
-          sum += histogram[i];
-          if (sum > threshold)
-          {
-            median = i;
-            lessThanMedian = sum - histogram[i];
-            break;
-          }
-        }
-      }
-      else
-      {
-        // update histogram
-        for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
-        {
-          unsigned int dx = x - offsetLeft + it->m_startPoint.m_x - 1;
+template<typename T>
+void Matrix<T>::filterQuantilKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement, double quantil)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  QuantileFilter<T>::apply(source, destination, structuringElement->getView(), referencePoint.m_x, referencePoint.m_y, quantil);
+}
 
-          // remove entry of left side
-          T value = original.m_values[z][y - offsetTop + Converter::toUInt(it->m_startPoint.m_y)][dx];
-          histogram[value]--;
-          if (value < median)
-          {
-            lessThanMedian--;
-          }
+template<typename T>
+void Matrix<T>::filterConservativeSmoothing(const StructuringElement *structuringElement, unsigned int z, unsigned int qtyThreads)
+{
+  filterConservativeSmoothing(structuringElement, getView(z), qtyThreads);
+}
 
-          // add entry of right side
-          value = original.m_values[z][y - offsetTop + Converter::toUInt(it->m_startPoint.m_y)][dx + it->m_length];
-          histogram[value]++;
-          if (value < median)
-          {
-            lessThanMedian++;
-          }
-        }
+template<typename T>
+void Matrix<T>::filterConservativeSmoothing(const StructuringElement *structuringElement, const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (typeid(bool) == typeid(T))
+  {
+    return; // nothing to do
+  }
 
-        // find median
-        if (lessThanMedian > threshold)
-        {
-          // the median in the current window is smaller than
-          // the one in the previous window
-          while (lessThanMedian > threshold)
-          {
-            median--;
-            lessThanMedian -= histogram[median];
-          }
-        }
-        else
-        {
-          while(lessThanMedian + histogram[median] <= threshold)
-          {
-            lessThanMedian += histogram[median];
-            median++;
-          }
-        }
-      }
+  if (view.isEmpty())
+  {
+    return;
+  }
 
-      if (sumOfSetValues % 2 == 1 || quantil != 0.5) // TODO verify, is that correct?
-      {
-        m_values[z][y][x] = median;
-      }
-      else
-      {
-        unsigned long long medianCopy = median;
-        unsigned int lessThanMedianCopy = lessThanMedian;
+  unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
+  unsigned int offsetBottom = structuringElement->getHeight() - offsetTop - 1;
 
-        while (lessThanMedianCopy > threshold - 1)
-        {
-          medianCopy--;
-          lessThanMedianCopy -= histogram[medianCopy];
-        }
+  BandScheduler::runInPlace(view, offsetTop, offsetBottom, qtyThreads, [&](const MatrixView<const T>& source, const MatrixView<T>& destination)
+  {
+    filterConservativeSmoothingKernel(source, destination, structuringElement);
+  });
+}
 
-        m_values[z][y][x] = ((double) median + medianCopy) / 2 + 0.5;
-      }
-    }
-  }
+template<typename T>
+void Matrix<T>::filterConservativeSmoothing(const StructuringElement* structuringElement, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = structuringElement->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = structuringElement->getHeight() - haloTop - 1;
+
+  applyInRegion(region, z, haloLeft, haloTop, haloRight, haloBottom, true, [&](const MatrixView<T>& view)
+  {
+    filterConservativeSmoothing(structuringElement, view, qtyThreads);
+  });
 }
 
 template<typename T>
-void Matrix<T>::filterConservativeSmoothing(const StructuringElement *structuringElement, unsigned int z)
+void Matrix<T>::filterConservativeSmoothingKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement)
 {
   // look all values in structuringElement (except for reference point)
   // define minimum and maximum
@@ -1586,15 +2146,11 @@ void Matrix<T>::filterConservativeSmoothing(const StructuringElement *structurin
   // if value at reference point is bigger than the maximum, the value is set to the maximum
   // see: http://homepages.inf.ed.ac.uk/rbf/HIPR2/csmooth.htm
 
-  if (typeid(bool) == typeid(T))
+  if (source.getWidth() < structuringElement->getWidth() || source.getHeight() < structuringElement->getHeight())
   {
-    return; // nothing to do
+    return;
   }
 
-  Matrix<T> original(*this);
-
-  bool*** structuringElementValues = structuringElement->getValues();
-
   unsigned int offsetLeft = structuringElement->getReferencePoint().m_x;
   unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
   unsigned int offsetRight = structuringElement->getWidth() - offsetLeft - 1;
@@ -1602,235 +2158,223 @@ void Matrix<T>::filterConservativeSmoothing(const StructuringElement *structurin
 
   T minimum;
   T maximum;
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  for (unsigned int y = offsetTop; y < (source.getHeight() - offsetBottom); y++)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
+    T* destinationRow = destination.getRow(y);
+    const T* centerRow = source.getRow(y);
+
+    for (unsigned int x = offsetLeft; x < (source.getWidth() - offsetRight); x++)
     {
       minimum = std::numeric_limits<T>::max();
       maximum = std::numeric_limits<T>::min();
 
       for (unsigned int fy = 0; fy < structuringElement->getHeight(); fy++)
       {
+        const T* sourceRow = source.getRow(y + fy - offsetTop) + x - offsetLeft;
+        const bool* structuringElementRow = structuringElement->getRow(fy);
+
         for (unsigned int fx = 0; fx < structuringElement->getWidth(); fx++)
         {
           bool onReferencePoint = (fx == offsetLeft && fy == offsetTop);
 
-          if (structuringElementValues[0][fy][fx] && !onReferencePoint)
+          if (structuringElementRow[fx] && !onReferencePoint)
           {
-            if (original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft] < minimum)
+            if (sourceRow[fx] < minimum)
             {
-              minimum = original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft];
+              minimum = sourceRow[fx];
             }
-            if (original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft] > maximum)
+            if (sourceRow[fx] > maximum)
             {
-              maximum = original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft];
+              maximum = sourceRow[fx];
             }
           }
         }
       }
 
-      if (original.m_values[z][y][x] < minimum)
+      if (centerRow[x] < minimum)
       {
-        m_values[z][y][x] = minimum;
+        destinationRow[x] = minimum;
       }
 
-      if (original.m_values[z][y][x] > maximum)
+      if (centerRow[x] > maximum)
       {
-        m_values[z][y][x] = maximum;
+        destinationRow[x] = maximum;
       }
     }
   }
 }
 
 template<typename T>
-void Matrix<T>::erode(const StructuringElement *structuringElement, unsigned int z)
+void Matrix<T>::erode(const StructuringElement *structuringElement, unsigned int z, unsigned int qtyThreads)
 {
-  bool typeIsBool = (typeid(bool) == typeid(T));
+  erode(structuringElement, getView(z), qtyThreads);
+}
 
-  if (!typeIsBool && !std::numeric_limits<T>::is_signed && std::numeric_limits<T>::is_integer)
+template<typename T>
+void Matrix<T>::erode(const StructuringElement *structuringElement, const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (view.isEmpty())
   {
-    filterQuantil(structuringElement, 1.0, z);
     return;
   }
 
-  Matrix<T> original(*this);
-
-  bool*** structuringElementValues = structuringElement->getValues();
+  // binary images are processed with one bit per pixel
+  if (std::is_same<T, bool>::value)
+  {
+    BinaryImage binaryImage(MatrixView<const T>(view), static_cast<T>(true));
+    binaryImage.erode(structuringElement, qtyThreads);
+    binaryImage.copyTo(view, static_cast<T>(false), static_cast<T>(true));
+    return;
+  }
 
-  unsigned int offsetLeft = structuringElement->getReferencePoint().m_x;
   unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
-  unsigned int offsetRight = structuringElement->getWidth() - offsetLeft - 1;
   unsigned int offsetBottom = structuringElement->getHeight() - offsetTop - 1;
 
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  BandScheduler::runInPlace(view, offsetTop, offsetBottom, qtyThreads, [&](const MatrixView<const T>& source, const MatrixView<T>& destination)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
-    {
-      if (typeIsBool)
-      {
-        bool bitSet = false;
-        for (unsigned int fy = 0; fy < structuringElement->getHeight() && !bitSet; fy++)
-        {
-          for (unsigned int fx = 0; fx < structuringElement->getWidth() && !bitSet; fx++)
-          {
-            if (structuringElementValues[0][fy][fx] && !original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft])
-            {
-              m_values[z][y][x] = false;
-              bitSet = true;
-            }
-          }
-        }
-        if (!bitSet)
-        {
-          m_values[z][y][x] = true;
-        }
-      }
-      else
-      {
-        T minimum = std::numeric_limits<T>::max();
+    erodeKernel(source, destination, structuringElement);
+  });
+}
 
-        for (unsigned int fy = 0; fy < structuringElement->getHeight(); fy++)
-        {
-          for (unsigned int fx = 0; fx < structuringElement->getWidth(); fx++)
-          {
-            if (structuringElementValues[0][fy][fx] && original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft] < minimum)
-            {
-              minimum = original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft];
-            }
-          }
-        }
-        m_values[z][y][x] = minimum;
-      }
-    }
-  }
+template<typename T>
+void Matrix<T>::erode(const StructuringElement* structuringElement, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = structuringElement->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = structuringElement->getHeight() - haloTop - 1;
+
+  applyInRegion(region, z, haloLeft, haloTop, haloRight, haloBottom, true, [&](const MatrixView<T>& view)
+  {
+    erode(structuringElement, view, qtyThreads);
+  });
 }
 
 template<typename T>
-void Matrix<T>::dilate(const StructuringElement *structuringElement, unsigned int z)
+void Matrix<T>::erodeKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement)
 {
-  bool typeIsBool = (typeid(bool) == typeid(T));
+  Point referencePoint = structuringElement->getReferencePoint();
+  MinMaxFilter<T>::apply(source, destination, structuringElement->getView(), referencePoint.m_x, referencePoint.m_y, true);
+}
 
-  if (!typeIsBool && !std::numeric_limits<T>::is_signed && std::numeric_limits<T>::is_integer)
+template<typename T>
+void Matrix<T>::dilate(const StructuringElement *structuringElement, unsigned int z, unsigned int qtyThreads)
+{
+  dilate(structuringElement, getView(z), qtyThreads);
+}
+
+template<typename T>
+void Matrix<T>::dilate(const StructuringElement *structuringElement, const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (view.isEmpty())
   {
-    filterQuantil(structuringElement, 0.0, z);
     return;
   }
 
-  Matrix<T> original(*this);
-
-  bool*** structuringElementValues = structuringElement->getValues();
+  // binary images are processed with one bit per pixel
+  if (std::is_same<T, bool>::value)
+  {
+    BinaryImage binaryImage(MatrixView<const T>(view), static_cast<T>(true));
+    binaryImage.dilate(structuringElement, qtyThreads);
+    binaryImage.copyTo(view, static_cast<T>(false), static_cast<T>(true));
+    return;
+  }
 
-  unsigned int offsetLeft = structuringElement->getReferencePoint().m_x;
   unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
-  unsigned int offsetRight = structuringElement->getWidth() - offsetLeft - 1;
   unsigned int offsetBottom = structuringElement->getHeight() - offsetTop - 1;
 
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  BandScheduler::runInPlace(view, offsetTop, offsetBottom, qtyThreads, [&](const MatrixView<const T>& source, const MatrixView<T>& destination)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
-    {
-      if (typeIsBool)
-      {
-        bool bitSet = false;
-        for (unsigned int fy = 0; fy < structuringElement->getHeight() && !bitSet; fy++)
-        {
-          for (unsigned int fx = 0; fx < structuringElement->getWidth() && !bitSet; fx++)
-          {
-            if (structuringElementValues[0][fy][fx] && original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft])
-            {
-              m_values[z][y][x] = true;
-              bitSet = true;
-            }
-          }
-        }
-        if (!bitSet)
-        {
-          m_values[z][y][x] = false;
-        }
-      }
-      else
-      {
-        T maximum = std::numeric_limits<T>::min();
+    dilateKernel(source, destination, structuringElement);
+  });
+}
 
-        for (unsigned int fy = 0; fy < structuringElement->getHeight(); fy++)
-        {
-          for (unsigned int fx = 0; fx < structuringElement->getWidth(); fx++)
-          {
-            if (structuringElementValues[0][fy][fx] && original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft] > maximum)
-            {
-              maximum = original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft];
-            }
-          }
-        }
+template<typename T>
+void Matrix<T>::dilate(const StructuringElement* structuringElement, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = structuringElement->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = structuringElement->getHeight() - haloTop - 1;
 
-        m_values[z][y][x] = maximum;
-      }
-    }
-  }
+  applyInRegion(region, z, haloLeft, haloTop, haloRight, haloBottom, true, [&](const MatrixView<T>& view)
+  {
+    dilate(structuringElement, view, qtyThreads);
+  });
 }
 
 template<typename T>
-void Matrix<T>::open(const StructuringElement *structuringElement, unsigned int z)
+void Matrix<T>::dilateKernel(const MatrixView<const T>& source, const MatrixView<T>& destination, const StructuringElement* structuringElement)
 {
-  erode(structuringElement, z);
-  dilate(structuringElement, z);
+  Point referencePoint = structuringElement->getReferencePoint();
+  MinMaxFilter<T>::apply(source, destination, structuringElement->getView(), referencePoint.m_x, referencePoint.m_y, false);
 }
 
 template<typename T>
-void Matrix<T>::close(const StructuringElement *structuringElement, unsigned int z)
+void Matrix<T>::open(const StructuringElement *structuringElement, unsigned int z, unsigned int qtyThreads)
 {
-  dilate(structuringElement, z);
-  erode(structuringElement, z);
+  erode(structuringElement, z, qtyThreads);
+  dilate(structuringElement, z, qtyThreads);
 }
 
 template<typename T>
-void Matrix<T>::filterMedian(const StructuringElement *structuringElement, unsigned int z)
+void Matrix<T>::close(const StructuringElement *structuringElement, unsigned int z, unsigned int qtyThreads)
 {
-  if (!std::numeric_limits<T>::is_signed && std::numeric_limits<T>::is_integer)
-  {
-    filterQuantil(structuringElement, 0.5, z);
-    return;
-  }
+  dilate(structuringElement, z, qtyThreads);
+  erode(structuringElement, z, qtyThreads);
+}
 
-  Matrix<T> original(*this);
+template<typename T>
+void Matrix<T>::open(const StructuringElement* structuringElement, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = structuringElement->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = structuringElement->getHeight() - haloTop - 1;
 
-  bool*** structuringElementValues = structuringElement->getValues();
+  // the second operator needs the result of the first one in its halo, so the halo is doubled and the region is processed on a copy
+  applyInRegion(region, z, 2 * haloLeft, 2 * haloTop, 2 * haloRight, 2 * haloBottom, false, [&](const MatrixView<T>& view)
+  {
+    erode(structuringElement, view, qtyThreads);
+    dilate(structuringElement, view, qtyThreads);
+  });
+}
 
-  unsigned int offsetLeft = structuringElement->getReferencePoint().m_x;
-  unsigned int offsetTop = structuringElement->getReferencePoint().m_y;
-  unsigned int offsetRight = structuringElement->getWidth() - offsetLeft - 1;
-  unsigned int offsetBottom = structuringElement->getHeight() - offsetTop - 1;
+template<typename T>
+void Matrix<T>::close(const StructuringElement* structuringElement, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  Point referencePoint = structuringElement->getReferencePoint();
+  unsigned int haloLeft = Converter::toUInt(referencePoint.m_x);
+  unsigned int haloTop = Converter::toUInt(referencePoint.m_y);
+  unsigned int haloRight = structuringElement->getWidth() - haloLeft - 1;
+  unsigned int haloBottom = structuringElement->getHeight() - haloTop - 1;
 
-  std::vector<T> values;
-  for (unsigned int y = offsetTop; y < (m_height - offsetBottom); y++)
+  applyInRegion(region, z, 2 * haloLeft, 2 * haloTop, 2 * haloRight, 2 * haloBottom, false, [&](const MatrixView<T>& view)
   {
-    for (unsigned int x = offsetLeft; x < (m_width - offsetRight); x++)
-    {
-      for (unsigned int fy = 0; fy < structuringElement->getHeight(); fy++)
-      {
-        for (unsigned int fx = 0; fx < structuringElement->getWidth(); fx++)
-        {
-          if (structuringElementValues[0][fy][fx])
-          {
-            values.push_back(original.m_values[z][y + fy - offsetTop][x + fx - offsetLeft]);
-          }
-        }
-      }
+    dilate(structuringElement, view, qtyThreads);
+    erode(structuringElement, view, qtyThreads);
+  });
+}
 
-      std::sort(values.begin(), values.end());
+template<typename T>
+void Matrix<T>::filterMedian(const StructuringElement *structuringElement, unsigned int z, unsigned int qtyThreads)
+{
+  filterMedian(structuringElement, getView(z), qtyThreads);
+}
 
-      if (values.size() % 2 == 0)
-      {
-        m_values[z][y][x] = ((double)values[values.size() / 2 - 1] + values[values.size() / 2]) / 2 + 0.5; // TODO correct implemenation for negative values
-      }
-      else
-      {
-        m_values[z][y][x] = values[values.size() / 2];
-      }
+template<typename T>
+void Matrix<T>::filterMedian(const StructuringElement *structuringElement, const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  filterQuantil(structuringElement, 0.5, view, qtyThreads);
+}
 
-      values.clear();
-    }
-  }
+template<typename T>
+void Matrix<T>::filterMedian(const StructuringElement* structuringElement, const Region& region, unsigned int z, unsigned int qtyThreads)
+{
+  filterQuantil(structuringElement, 0.5, region, z, qtyThreads);
 }
 
 template<typename T>
@@ -1838,162 +2382,182 @@ void Matrix<T>::invert()
 {
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++)
-    {
-      if (typeid(T) == typeid(bool))
-      {
-        *it = !(*it);
-      }
-      else
-      {
-        if (std::numeric_limits<T>::is_signed)
-        {
-          // TODO
-        }
-        else
-        {
-          *it = std::numeric_limits<T>::max() - *it;
-        }
-      }
-      it++;
-    }
+    pointOperations(z).invert().apply();
   }
 }
 
 template<typename T>
-void Matrix<T>::fillBackground(T backgroundValue, T fillValue, unsigned int z)
+void Matrix<T>::invert(const Region& region)
 {
+  for (unsigned int z = 0; z < m_qtyLayers; z++)
+  {
+    pointOperations(z).invert().apply(region);
+  }
+}
 
-  if (m_height < 3 || m_width < 3)
+template<typename T>
+void Matrix<T>::fillBackground(T backgroundValue, T fillValue, unsigned int z, bool neighborhood8)
+{
+  if (z >= m_qtyLayers || backgroundValue == fillValue)
   {
-    replace(backgroundValue, fillValue, z);
     return;
   }
 
-  // set edge points
-  m_values[z][0][0] = fillValue;
-  m_values[z][0][m_width-1] = fillValue;
-  m_values[z][m_height-1][0] = fillValue;
-  m_values[z][m_height-1][m_width-1] = fillValue;
-
-  std::list<Point> floodPoints;
+  // a filled pixel is not background anymore, so the layer itself marks the visited pixels
+  floodFillFromBorder(neighborhood8, [&](unsigned int x, unsigned int y)
+  {
+    return getRow(y, z)[x] == backgroundValue;
+  },
+  [&](unsigned int y, unsigned int xStart, unsigned int xEnd)
+  {
+    std::fill(getRow(y, z) + xStart, getRow(y, z) + xEnd + 1, fillValue);
+  });
+}
 
-  // view in first line
-  for (unsigned int x = 1; x < m_width - 1; x++)
+template<typename T>
+void Matrix<T>::fillHoles(T backgroundValue, T fillValue, unsigned int z, bool neighborhood8)
+{
+  if (z >= m_qtyLayers)
   {
-    if (m_values[z][0][x] == backgroundValue)
-    {
-      m_values[z][0][x] = fillValue;
-      if (m_values[z][1][x] == backgroundValue)
-      {
-        floodPoints.push_back(Point(x, 1));
-      }
-    }
+    return;
   }
 
-  // view in first colum
-  for (unsigned int y = 1; y < m_height - 1; y++)
+  // the background which is connected to the border is marked in a separate mask, the rest of the background are holes
+  std::vector<unsigned char> outside(static_cast<size_t>(m_width) * m_height, 0);
+
+  floodFillFromBorder(neighborhood8, [&](unsigned int x, unsigned int y)
   {
-    if (m_values[z][y][0] == backgroundValue)
-    {
-      m_values[z][y][0] = fillValue;
-      if (m_values[z][y][1] == backgroundValue)
-      {
-        floodPoints.push_back(Point(1, y));
-      }
-    }
-  }
+    return getRow(y, z)[x] == backgroundValue && !outside[static_cast<size_t>(y) * m_width + x];
+  },
+  [&](unsigned int y, unsigned int xStart, unsigned int xEnd)
+  {
+    memset(&outside[static_cast<size_t>(y) * m_width + xStart], 1, xEnd - xStart + 1);
+  });
 
-  // view in last colum
-  for (unsigned int y = 1; y < m_height - 1; y++)
+  for (unsigned int y = 0; y < m_height; y++)
   {
-    if (m_values[z][y][m_width - 1] == backgroundValue)
+    T* it = getRow(y, z);
+    const unsigned char* isOutside = &outside[static_cast<size_t>(y) * m_width];
+
+    for (unsigned int x = 0; x < m_width; x++)
     {
-      m_values[z][y][m_width - 1] = fillValue;
-      if (m_values[z][y][m_width - 2] == backgroundValue)
+      if (it[x] == backgroundValue && !isOutside[x])
       {
-        floodPoints.push_back(Point(m_width - 2, y));
+        it[x] = fillValue;
       }
     }
   }
+}
+
+template<typename T>
+template<typename IsInside, typename FillSpan>
+void Matrix<T>::floodFillFromBorder(bool neighborhood8, const IsInside& isInside, const FillSpan& fillSpan)
+{
+  // scanline fill: every seed is extended to its horizontal span, the span is filled at once and
+  // one seed per run of inside pixels above and below is pushed -> every pixel is filled once, no allocation per pixel
+  // fillSpan(y, xStart, xEnd) has to make isInside() false for all pixels of the span
+  struct Seed
+  {
+    unsigned int x;
+    unsigned int y;
+  };
+
+  std::vector<Seed> seeds;
+  seeds.reserve(2 * (m_width + m_height));
 
-  // view in last line
-  for (unsigned int x = 1; x < m_width - 1; x++)
+  auto pushRuns = [&](unsigned int y, unsigned int xStart, unsigned int xEnd)
   {
-    if (m_values[z][m_height - 1][x] == backgroundValue)
+    bool insideRun = false;
+    for (unsigned int x = xStart; x <= xEnd; x++)
     {
-      m_values[z][m_height - 1][x] = fillValue;
-      if (m_values[z][m_height - 2][x] == backgroundValue)
+      bool inside = isInside(x, y);
+      if (inside && !insideRun)
       {
-        floodPoints.push_back(Point(x, m_height - 2));
+        seeds.push_back(Seed{x, y});
       }
+      insideRun = inside;
     }
-  }
+  };
 
-  unsigned int x;
-  unsigned int y;
+  // seeds on the border of the image
+  pushRuns(0, 0, m_width - 1);
+  if (m_height > 1)
+  {
+    pushRuns(m_height - 1, 0, m_width - 1);
+  }
 
-  while(!floodPoints.empty())
+  for (unsigned int y = 1; y + 1 < m_height; y++)
   {
-    x = floodPoints.front().m_x;
-    y = floodPoints.front().m_y;
+    pushRuns(y, 0, 0);
+    pushRuns(y, m_width - 1, m_width - 1);
+  }
 
-    m_values[z][y][x] = fillValue;
+  while (!seeds.empty())
+  {
+    Seed seed = seeds.back();
+    seeds.pop_back();
 
-    // look left
-    if (m_values[z][y][x-1] == backgroundValue)
+    unsigned int y = seed.y;
+    if (!isInside(seed.x, y))
     {
-      floodPoints.push_back(Point(x-1, y));
+      continue; // already filled by another span
     }
 
-    // look up
-    if (m_values[z][y-1][x] == backgroundValue)
+    unsigned int left = seed.x;
+    while (left > 0 && isInside(left - 1, y))
     {
-      floodPoints.push_back(Point(x, y-1));
+      left--;
     }
 
-    // look down
-    if (m_values[z][y+1][x] == backgroundValue)
+    unsigned int right = seed.x;
+    while (right + 1 < m_width && isInside(right + 1, y))
     {
-      floodPoints.push_back(Point(x, y+1));
+      right++;
     }
 
-    // look right
-    if (m_values[z][y][x+1] == backgroundValue)
+    fillSpan(y, left, right);
+
+    // with 8-connectivity the diagonal neighbours of the span ends are connected too
+    unsigned int scanLeft = (neighborhood8 && left > 0) ? left - 1 : left;
+    unsigned int scanRight = (neighborhood8 && right + 1 < m_width) ? right + 1 : right;
+
+    if (y > 0)
     {
-      floodPoints.push_back(Point(x+1, y));
+      pushRuns(y - 1, scanLeft, scanRight);
     }
 
-    floodPoints.pop_front();
+    if (y + 1 < m_height)
+    {
+      pushRuns(y + 1, scanLeft, scanRight);
+    }
   }
 }
 
 template<typename T>
 void Matrix<T>::replace(T currentValue, T newValue, unsigned int z)
 {
-  T* it = m_values[z][0];
-  for (unsigned int i = 0; i < m_size; i++, it++)
-  {
-    if (*it == currentValue)
-    {
-      *it = newValue;
-    }
-  }
+  pointOperations(z).replace(currentValue, newValue).apply();
 }
 
 template<typename T>
-Edges Matrix<T>::findEdges(const Line &line, float minContrast, unsigned int smoothingWidth, unsigned int z)
+void Matrix<T>::replace(T currentValue, T newValue, const Region& region, unsigned int z)
 {
-  Edges edges;
+  pointOperations(z).replace(currentValue, newValue).apply(region);
+}
 
-  Points points = line.getPointsAlongLine();
+template<typename T>
+Edges Matrix<T>::findEdges(const Line &line, float minContrast, unsigned int smoothingWidth, unsigned int z) const
+{
+  Edges edges;
 
-  std::cout << "size: " << points.size() << std::endl;
+  if (z >= m_qtyLayers || m_width == 0 || m_height == 0)
+  {
+    return edges;
+  }
 
   unsigned int stepSize = 1;
 
-  std::list<double> averages;
+  std::deque<double> averages;
 
   float distance1 = smoothingWidth / 2;
   float distance2 = smoothingWidth / 2;
@@ -2008,215 +2572,192 @@ Edges Matrix<T>::findEdges(const Line &line, float minContrast, unsigned int smo
     double d1 = sin(MathHelper::rad(line.angle()));
     double d2 = cos(MathHelper::rad(line.angle()));
 
-    /*std::cout << "d1: " << d1 << std::endl;
-    std::cout << "d2: " << d2 << std::endl;*/
-
     double lengthCorrection = d1 + d2; // TODO does not seem to be perfect
 
-    //std::cout << "d1 + d2: " << lengthCorrection << std::endl;
-
     distance1 *= lengthCorrection;
     distance2 *= lengthCorrection;
   }
 
-  for (auto it = points.begin(); it != points.end(); it++)
+  // the points are visited one by one, no list of points is created
+  line.visitPointsAlongLine([&](int x, int y)
   {
+    Point point(x, y);
+
     if (smoothingWidth > 1)
     {
-      Point p1 = MathHelper::calcEndPoint(*it, line.angle() - 90, distance1);
-      Point p2 = MathHelper::calcEndPoint(*it, line.angle() + 90, distance2);
+      Point p1 = MathHelper::calcEndPoint(point, line.angle() - 90, distance1);
+      Point p2 = MathHelper::calcEndPoint(point, line.angle() + 90, distance2);
 
       Line verticalLine(p1, p2);
 
-      /*if (it == points.begin())
-      {
-        setLine(255, verticalLine);
-      }*/
-
       averages.push_back(getAverageAlongLine(verticalLine, z));
     }
     else
     {
-      averages.push_back(m_values[z][Converter::toUInt(it->m_y)][Converter::toUInt(it->m_x)]);
+      averages.push_back(getClampedValue(x, y, z));
     }
 
-
     if (averages.size() > stepSize)
     {
       double difference = averages.back() - averages.front();
 
       if (difference > minContrast || difference < -minContrast)
       {
-        edges.push_back(Edge(*it, line.angle(), difference));
-        //std::cout << "difference: " << difference << std::endl;
-        setPoint(255, *it);
+        edges.push_back(Edge(point, line.angle(), difference));
       }
 
       averages.pop_front();
     }
-  }
+  });
 
   return edges;
 }
 
 template<typename T>
-void Matrix<T>::mirrorOnHorizontalAxis()
+std::vector<Edges> Matrix<T>::findEdges(const std::vector<EdgeProbe>& probes, unsigned int z, unsigned int qtyThreads) const
 {
-  Matrix<T> original(*this);
+  return EdgeProbe::findEdges(getView(z), probes, qtyThreads);
+}
 
+template<typename T>
+void Matrix<T>::mirrorOnHorizontalAxis()
+{
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int y = 0; y < m_height; y++)
-    {
-      memcpy(&m_values[z][y][0], &(original.m_values[z][m_height - y - 1][0]), m_width * sizeof(T));
-    }
+    Rotation::mirrorOnHorizontalAxis(getView(z));
   }
 }
 
 template<typename T>
 void Matrix<T>::mirrorOnVerticalAxis()
 {
-  Matrix<T> original(*this);
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int x = 0; x < m_width; x++)
-    {
-      for (unsigned int y = 0; y < m_height; y++)
-      {
-        m_values[z][y][x] = original.m_values[z][y][m_width - x - 1];
-      }
-    }
+    Rotation::mirrorOnVerticalAxis(getView(z));
   }
 }
 
 template<typename T>
 void Matrix<T>::rotateBy90DegreeClockwise()
 {
-  Matrix<T> original(*this);
-
-  m_width = original.m_height;
-  m_height = original.m_width;
-
-  if (m_width != m_height)
+  if (m_width == m_height)
   {
-    destroyRowBeginVector();
-    createRowBeginVector();
+    for (unsigned int z = 0; z < m_qtyLayers; z++)
+    {
+      Rotation::rotateBy90Degree(getView(z), true);
+    }
+    return;
   }
 
+  // the stride depends on the width, so the layers need to be reallocated
+  Matrix<T> rotated(m_height, m_width, m_qtyLayers, false);
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int y = 0; y < m_height; y++)
-    {
-      for (unsigned int x = 0; x < m_width; x++)
-      {
-        m_values[z][y][x] = original.m_values[z][original.m_height - x - 1][y];
-      }
-    }
+    Rotation::rotateBy90Degree<T>(getView(z), rotated.getView(z), true);
   }
+
+  *this = std::move(rotated);
 }
 
 template<typename T>
 void Matrix<T>::rotateBy90DegreeCounterClockwise()
 {
-  Matrix<T> original(*this);
-
-  m_width = original.m_height;
-  m_height = original.m_width;
-
-  if (m_width != m_height)
+  if (m_width == m_height)
   {
-    destroyRowBeginVector();
-    createRowBeginVector();
+    for (unsigned int z = 0; z < m_qtyLayers; z++)
+    {
+      Rotation::rotateBy90Degree(getView(z), false);
+    }
+    return;
   }
 
+  // the stride depends on the width, so the layers need to be reallocated
+  Matrix<T> rotated(m_height, m_width, m_qtyLayers, false);
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int y = 0; y < m_height; y++)
-    {
-      for (unsigned int x = 0; x < m_width; x++)
-      {
-        m_values[z][y][x] = original.m_values[z][x][original.m_width - y - 1];
-      }
-    }
+    Rotation::rotateBy90Degree<T>(getView(z), rotated.getView(z), false);
   }
+
+  *this = std::move(rotated);
 }
 
 template<typename T>
 void Matrix<T>::rotateBy180Degree()
 {
-  Matrix<T> original(*this);
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int x = 0; x < m_width; x++)
-    {
-      for (unsigned int y = 0; y < m_height; y++)
-      {
-        m_values[z][y][x] = original.m_values[z][m_height - y - 1][m_width - x - 1];
-      }
-    }
+    Rotation::rotateBy180Degree(getView(z));
   }
 }
 
+template<typename T>
+void Matrix<T>::rotate(float angle, PolarTransformation::Interpolation interpolation, T backgroundValue, unsigned int qtyThreads)
+{
+  Matrix<T> rotated(m_width, m_height, m_qtyLayers, false);
+  for (unsigned int z = 0; z < m_qtyLayers; z++)
+  {
+    Rotation::rotate<T>(getView(z), rotated.getView(z), angle, interpolation, backgroundValue, qtyThreads);
+  }
+
+  *this = std::move(rotated);
+}
+
 template<typename T>
 Matrix<T> Matrix<T>::crop(const Rectangle& cropRegion)
 {
-  if (!isRectangleInsideImage(cropRegion))
+  if (!isRectangleInsideImage(cropRegion) || cropRegion.m_angle != 0)
   {
     return Matrix<T>();
   }
 
-  Matrix<T> cropped(cropRegion.m_width, cropRegion.m_height, m_qtyLayers);
-
-  // TODO what about rotated rectangles?
+  // use getView(cropRegion) if no copy is needed
+  Matrix<T> cropped(cropRegion.m_width, cropRegion.m_height, m_qtyLayers, false);
 
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int y = 0; y < cropRegion.m_height; y++)
-    {
-      memcpy(cropped.m_values[z][y], &m_values[z][y+cropRegion.m_origin.m_y][cropRegion.m_origin.m_x], cropRegion.m_width * sizeof(T));
-    }
+    copyView(getView(cropRegion, z), cropped.getView(z));
   }
 
   return cropped;
 }
 
 template<typename T>
-Matrix<T> Matrix<T>::doPolarTransformation(const Circle &circle)
+Matrix<T> Matrix<T>::doPolarTransformation(const Circle& circle, PolarTransformation::Interpolation interpolation, unsigned int qtyThreads)
 {
   if (!isCircleInsideImage(circle))
   {
     return Matrix<T>(1, 1);
   }
 
-  unsigned int circumference = circle.m_radius * 2 * 3.14159265359 + 0.5;
+  // the remap table is shared by all circles with the same radius on images with the same stride
+  std::shared_ptr<const PolarTransformation> transformation = PolarTransformation::get(circle.m_radius, m_stride, interpolation);
 
-  int width = circumference;
+  Matrix<T> calculated(transformation->getWidth(), transformation->getHeight(), m_qtyLayers);
 
-  if (width % 4 != 0)
-  {
-    width += (4 - (width % 4)); // round up -> width % 4 needs to be zero!
-  }
-
-  Matrix<T> calculated(width, circle.m_radius, m_qtyLayers); // TODO correct sizes
+  // rows and views are requested before the threads start, so no thread touches the state of the matrices
+  unsigned int centerX = Converter::toUInt(circle.m_center.m_x);
+  unsigned int centerY = Converter::toUInt(circle.m_center.m_y);
+  const Matrix<T>& source = *this;
+  std::vector<const T*> centers(m_qtyLayers);
+  std::vector<MatrixView<T> > destinations(m_qtyLayers);
 
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    for (unsigned int y = 0; y < circle.m_radius; y++) // radius
-    {
-      for (unsigned int x = 0; x < circumference; x++) // angle
-      {
-        // TODO improve performace -> avoid duplicated calculations -> avoid conversions
+    centers[z] = source.getRow(centerY, z) + centerX;
+    destinations[z] = calculated.getView(z);
+  }
 
-        int angle = x * 360.0 / circumference;
-        int radius = y;
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  unsigned int height = transformation->getHeight();
+  unsigned int qtyBands = std::max(1u, std::min(threadPool.getQtyThreads(), height / 16));
 
-        int xx = radius * cos(angle * PI / 180.0);
-        int yy = radius * sin(angle * PI / 180.0);
+  threadPool.run(m_qtyLayers * qtyBands, [&](unsigned int task)
+  {
+    unsigned int z = task / qtyBands;
+    unsigned int band = task % qtyBands;
 
-        calculated.m_values[z][y][x] = m_values[z][yy + Converter::toUInt(circle.m_center.m_y)][xx + Converter::toUInt(circle.m_center.m_x)];
-      }
-    }
-  }
+    transformation->apply(centers[z], destinations[z], height * band / qtyBands, height * (band + 1) / qtyBands);
+  }, qtyThreads);
 
   return calculated;
 }
@@ -2224,25 +2765,18 @@ Matrix<T> Matrix<T>::doPolarTransformation(const Circle &circle)
 template<typename T>
 void Matrix<T>::applyLookUpTable(const std::vector<T>& lookUpTable)
 {
-  if (std::numeric_limits<T>::is_signed)
-  {
-    // TODO how to define a LUT for negative values?
-    return;
-  }
-
-  if (lookUpTable.size() < std::numeric_limits<T>::max() + 1)
+  for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    // LUT not fully defined
-    return;
+    pointOperations(z).lookUpTable(lookUpTable).apply();
   }
+}
 
+template<typename T>
+void Matrix<T>::applyLookUpTable(const std::vector<T>& lookUpTable, const Region& region)
+{
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++, it++)
-    {
-      *it = lookUpTable[*it];
-    }
+    pointOperations(z).lookUpTable(lookUpTable).apply(region);
   }
 }
 
@@ -2295,18 +2829,27 @@ unsigned int Matrix<T>::getQtyLayers() const
   return m_qtyLayers;
 }
 
+template<typename T>
+unsigned int Matrix<T>::getStride() const
+{
+  return m_stride;
+}
+
 template<typename T>
 T Matrix<T>::getMinimum() const
 {
   T minimum = std::numeric_limits<T>::max();
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++, it++)
+    for (unsigned int y = 0; y < m_height; y++)
     {
-      if (*it < minimum)
+      const T* it = getRow(y, z);
+      for (unsigned int x = 0; x < m_width; x++, it++)
       {
-        minimum = *it;
+        if (*it < minimum)
+        {
+          minimum = *it;
+        }
       }
     }
   }
@@ -2319,12 +2862,15 @@ T Matrix<T>::getMaximum() const
   T maximum = std::numeric_limits<T>::min();
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++, it++)
+    for (unsigned int y = 0; y < m_height; y++)
     {
-      if (*it > maximum)
+      const T* it = getRow(y, z);
+      for (unsigned int x = 0; x < m_width; x++, it++)
       {
-        maximum = *it;
+        if (*it > maximum)
+        {
+          maximum = *it;
+        }
       }
     }
   }
@@ -2340,9 +2886,10 @@ void Matrix<T>::printValuesToConsole(const std::string& description) const
   {
     std::cout << std::endl << "layer " << z << std::endl;
 
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++, it++)
+    for (size_t i = 0; i < m_size; i++)
     {
+      const T* it = &getRow(static_cast<unsigned int>(i / m_width), z)[i % m_width];
+
       if (typeid(bool) == typeid(T))
       {
         if (*it)
@@ -2415,9 +2962,9 @@ void Matrix<T>::printDifference(const Matrix &rhs) const
     {
       for (unsigned int x = 0; x < m_width; x++)
       {
-        if (m_values[z][y][x] != rhs.m_values[z][y][x])
+        if (getRow(y, z)[x] != rhs.getRow(y, z)[x])
         {
-          std::cout << "m_values[" << z << "][" << y << "][" << x << "]: " << (int) m_values[z][y][x] << " is different to " << (int) rhs.m_values[z][y][x] << std::endl;
+          std::cout << "getRow(" << y << ", " << z << ")[" << x << "]: " << (int) getRow(y, z)[x] << " is different to " << (int) rhs.getRow(y, z)[x] << std::endl;
           return;
         }
       }
@@ -2433,10 +2980,13 @@ void Matrix<T>::setIncreasingValues()
   T value = 0;
   for (unsigned int z = 0; z < m_qtyLayers; z++)
   {
-    T* it = m_values[z][0];
-    for (unsigned int i = 0; i < m_size; i++, it++)
+    for (unsigned int y = 0; y < m_height; y++)
     {
-      *it = value++;
+      T* it = getRow(y, z);
+      for (unsigned int x = 0; x < m_width; x++, it++)
+      {
+        *it = value++;
+      }
     }
   }
 }
@@ -2445,14 +2995,12 @@ void Matrix<T>::setIncreasingValues()
 /*template<typename F, typename M>
 void filterMatrix(Matrix<M>* matrix, Matrix<F>* filter, const Point& referencePoint, double preFactor = 1.0, unsigned z = 0)
 {
-  M*** m = matrix->getValues();
-  F*** f = filter->getValues();
-
   for (unsigned int y = 0; y < matrix->getHeight(); y++)
   {
+    M* row = matrix->getRow(y, z);
     for (unsigned int x = 0; x < matrix->getWidth(); x++)
     {
-      m[z][y][x] = f[0][referencePoint.m_y][referencePoint.m_x];
+      row[x] = filter->getRow(referencePoint.m_y)[referencePoint.m_x];
     }
   }
 }*/
@@ -2460,10 +3008,13 @@ void filterMatrix(Matrix<M>* matrix, Matrix<F>* filter, const Point& referencePo
 /* iterate over all values
 for (unsigned int z = 0; z < m_qtyLayers; z++)
 {
-  T* it = m_values[z][0];
-  for (unsigned int i = 0; i < m_size; i++, it++)
+  for (unsigned int y = 0; y < m_height; y++)
   {
-    *it = ;
+    T* it = getRow(y, z);
+    for (unsigned int x = 0; x < m_width; x++, it++)
+    {
+      *it = ;
+    }
   }
 }
 */
@@ -0,0 +1,211 @@
+#include "MatrixFile.h"
+
+namespace
+{
+  const char Magic[4] = {'I', 'P', 'M', 'X'};
+  const uint32_t ByteOrderMark = 0x01020304;
+  const uint32_t Version = 1;
+
+  // the header is written field by field in the byte order of the machine:
+  // magic, byte order mark, version, type code, width, height, qtyLayers, stride (uint32), data offset (uint64)
+  template<typename U>
+  void put(unsigned char*& it, U value)
+  {
+    memcpy(it, &value, sizeof(U));
+    it += sizeof(U);
+  }
+
+  template<typename U>
+  U get(const unsigned char*& it)
+  {
+    U value;
+    memcpy(&value, it, sizeof(U));
+    it += sizeof(U);
+    return value;
+  }
+}
+
+const unsigned int MatrixFile::HeaderSize;
+const char* const MatrixFile::Extension = ".ipm";
+
+void MatrixFile::writeHeader(unsigned char* header, unsigned int typeCode, const Layout& layout)
+{
+  memset(header, 0, HeaderSize);
+
+  unsigned char* it = header;
+  memcpy(it, Magic, sizeof(Magic));
+  it += sizeof(Magic);
+
+  put<uint32_t>(it, ByteOrderMark);
+  put<uint32_t>(it, Version);
+  put<uint32_t>(it, typeCode);
+  put<uint32_t>(it, layout.m_width);
+  put<uint32_t>(it, layout.m_height);
+  put<uint32_t>(it, layout.m_qtyLayers);
+  put<uint32_t>(it, layout.m_stride);
+  put<uint64_t>(it, layout.m_dataOffset);
+}
+
+bool MatrixFile::writeHeader(std::ofstream& stream, unsigned int typeCode, const Layout& layout)
+{
+  unsigned char header[HeaderSize];
+  writeHeader(header, typeCode, layout);
+
+  return static_cast<bool>(stream.write(reinterpret_cast<const char*>(header), HeaderSize));
+}
+
+bool MatrixFile::readHeader(const unsigned char* header, size_t fileSize, unsigned int typeCode, unsigned int sizeOfType, Layout& layout)
+{
+  if (header == 0 || fileSize < HeaderSize || memcmp(header, Magic, sizeof(Magic)) != 0)
+  {
+    return false;
+  }
+
+  const unsigned char* it = header + sizeof(Magic);
+
+  // files of machines with another byte order or of another type are rejected
+  if (get<uint32_t>(it) != ByteOrderMark || get<uint32_t>(it) != Version || get<uint32_t>(it) != typeCode)
+  {
+    return false;
+  }
+
+  layout.m_width = get<uint32_t>(it);
+  layout.m_height = get<uint32_t>(it);
+  layout.m_qtyLayers = get<uint32_t>(it);
+  layout.m_stride = get<uint32_t>(it);
+  uint64_t dataOffset = get<uint64_t>(it);
+
+  if (layout.m_width == 0 || layout.m_height == 0 || layout.m_qtyLayers == 0 || layout.m_stride < layout.m_width)
+  {
+    return false;
+  }
+
+  // the layers must be aligned for T and completely inside the file
+  size_t dataSize;
+  if (!getDataSize(layout.m_stride, layout.m_height, layout.m_qtyLayers, sizeOfType, dataSize)
+      || dataOffset < HeaderSize || dataOffset % sizeOfType != 0 || dataOffset > fileSize || dataSize > fileSize - dataOffset)
+  {
+    return false;
+  }
+
+  layout.m_dataOffset = static_cast<size_t>(dataOffset);
+  return true;
+}
+
+bool MatrixFile::getDataSize(unsigned int width, unsigned int height, unsigned int qtyLayers, size_t bytesPerSample, size_t& dataSize)
+{
+  if (width == 0 || height == 0 || qtyLayers == 0 || bytesPerSample == 0)
+  {
+    return false;
+  }
+
+  const size_t maximum = std::numeric_limits<size_t>::max();
+  dataSize = width;
+
+  if (dataSize > maximum / height)
+  {
+    return false;
+  }
+  dataSize *= height;
+
+  if (dataSize > maximum / qtyLayers)
+  {
+    return false;
+  }
+  dataSize *= qtyLayers;
+
+  if (dataSize > maximum / bytesPerSample)
+  {
+    return false;
+  }
+  dataSize *= bytesPerSample;
+
+  return true;
+}
+
+size_t MatrixFile::getRemainingSize(std::ifstream& stream)
+{
+  std::streamoff position = stream.tellg();
+  stream.seekg(0, std::ios::end);
+  std::streamoff end = stream.tellg();
+  stream.seekg(position, std::ios::beg);
+
+  return position >= 0 && end > position ? static_cast<size_t>(end - position) : 0;
+}
+
+bool MatrixFile::readPnmNumber(std::ifstream& stream, unsigned int& number)
+{
+  // skips white space and comments
+  int character = stream.get();
+  while (character != EOF)
+  {
+    if (character == '#')
+    {
+      while (character != EOF && character != '\n')
+      {
+        character = stream.get();
+      }
+    }
+    else if (character != ' ' && character != '\t' && character != '\r' && character != '\n')
+    {
+      break;
+    }
+
+    character = stream.get();
+  }
+
+  if (character < '0' || character > '9')
+  {
+    return false;
+  }
+
+  unsigned long long value = 0;
+  while (character >= '0' && character <= '9')
+  {
+    value = value * 10 + (character - '0');
+    if (value > std::numeric_limits<unsigned int>::max())
+    {
+      return false;
+    }
+
+    character = stream.get();
+  }
+
+  // exactly one white space character separates the header from the samples
+  if (character != ' ' && character != '\t' && character != '\r' && character != '\n')
+  {
+    return false;
+  }
+
+  number = static_cast<unsigned int>(value);
+  return true;
+}
+
+bool MatrixFile::readPnmHeader(std::ifstream& stream, unsigned int& qtyLayers, unsigned int& width, unsigned int& height, unsigned int& maximum)
+{
+  char magic[2];
+  if (!stream.read(magic, 2) || magic[0] != 'P')
+  {
+    return false;
+  }
+
+  if (magic[1] == '5')
+  {
+    qtyLayers = 1;
+  }
+  else if (magic[1] == '6')
+  {
+    qtyLayers = 3;
+  }
+  else
+  {
+    return false; // the ASCII formats P2 / P3 are not supported
+  }
+
+  if (!readPnmNumber(stream, width) || !readPnmNumber(stream, height) || !readPnmNumber(stream, maximum))
+  {
+    return false;
+  }
+
+  return width > 0 && height > 0 && maximum > 0 && maximum < 65536;
+}
@@ -0,0 +1,487 @@
+#ifndef MATRIXFILE_H
+#define MATRIXFILE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Matrix.h"
+#include "MatrixView.h"
+
+// file formats of Matrix which do not need QImage
+// * native format: a header of HeaderSize bytes followed by the layers, the rows are padded like in Matrix
+//   -> the file can be mapped read-only with MappedMatrix and used without any conversion
+// * binary PGM (1 layer) / PPM (3 layers) with 8 or 16 bit samples, the ASCII formats P2 / P3 are not supported
+// * raw: the layers one after the other without header and without padding
+// all readers and writers stream the data row by row, no intermediate image is created
+class MatrixFile
+{
+public:
+  static const unsigned int HeaderSize = 64;
+  static const char* const Extension; // of the native format
+
+  class Layout
+  {
+  public:
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_qtyLayers;
+    unsigned int m_stride; // distance between two rows in elements
+    size_t m_dataOffset; // in bytes from the start of the file, the layers follow each other without gap
+  };
+
+  template<typename T>
+  static unsigned int getTypeCode();
+
+  template<typename T>
+  static bool write(const std::string& fileName, const Matrix<T>& matrix);
+
+  template<typename T>
+  static bool read(const std::string& fileName, Matrix<T>& matrix);
+
+  // only unsigned integer types with 8 or 16 bit, 16 bit samples are written if T has 16 bit
+  template<typename T>
+  static bool writePnm(const std::string& fileName, const Matrix<T>& matrix);
+
+  // P5 -> 1 layer, P6 -> 3 layers, 16 bit samples can only be read into 16 bit types, P2 / P3 return false
+  template<typename T>
+  static bool readPnm(const std::string& fileName, Matrix<T>& matrix);
+
+  // samples in the byte order of the machine
+  template<typename T>
+  static bool writeRaw(const std::string& fileName, const Matrix<T>& matrix);
+
+  template<typename T>
+  static bool readRaw(const std::string& fileName, unsigned int width, unsigned int height, unsigned int qtyLayers, Matrix<T>& matrix, size_t headerSize = 0);
+
+  // validates the header of a native file and returns the position of the layers
+  static bool readHeader(const unsigned char* header, size_t fileSize, unsigned int typeCode, unsigned int sizeOfType, Layout& layout);
+
+  // size in bytes of qtyLayers layers of width * height samples, false if it does not fit into size_t
+  static bool getDataSize(unsigned int width, unsigned int height, unsigned int qtyLayers, size_t bytesPerSample, size_t& dataSize);
+
+private:
+  static const size_t ChunkSize = 1 << 20; // bytes per write call
+
+  static void writeHeader(unsigned char* header, unsigned int typeCode, const Layout& layout);
+  static bool writeHeader(std::ofstream& stream, unsigned int typeCode, const Layout& layout);
+  static bool readPnmHeader(std::ifstream& stream, unsigned int& qtyLayers, unsigned int& width, unsigned int& height, unsigned int& maximum);
+  static bool readPnmNumber(std::ifstream& stream, unsigned int& number);
+  static size_t getRemainingSize(std::ifstream& stream);
+
+  template<typename T>
+  static bool writeLayers(std::ofstream& stream, const Matrix<T>& matrix, unsigned int stride);
+};
+
+// read-only Matrix in a mapped native file, see MatrixFile
+// copies share the mapping, the views are valid as long as one copy is alive and open
+template<typename T>
+class MappedMatrix
+{
+public:
+  MappedMatrix();
+
+  bool open(const std::string& fileName); // false, if the file is not a native file of type T
+  void close();
+
+  bool isOpen() const;
+  unsigned int getWidth() const;
+  unsigned int getHeight() const;
+  unsigned int getQtyLayers() const;
+  unsigned int getStride() const;
+
+  MatrixView<const T> getView(unsigned int z = 0) const;
+
+private:
+  std::shared_ptr<MappedFile> m_file;
+  MatrixFile::Layout m_layout;
+};
+
+template<typename T>
+unsigned int MatrixFile::getTypeCode()
+{
+  return static_cast<unsigned int>(sizeof(T))
+    | (std::numeric_limits<T>::is_integer ? 0x100 : 0)
+    | (std::numeric_limits<T>::is_signed ? 0x200 : 0)
+    | (std::is_same<T, bool>::value ? 0x400 : 0);
+}
+
+template<typename T>
+bool MatrixFile::write(const std::string& fileName, const Matrix<T>& matrix)
+{
+  std::ofstream stream(fileName.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  Layout layout;
+  layout.m_width = matrix.getWidth();
+  layout.m_height = matrix.getHeight();
+  layout.m_qtyLayers = matrix.getQtyLayers();
+  layout.m_stride = matrix.getStride();
+  layout.m_dataOffset = HeaderSize;
+
+  if (!writeHeader(stream, getTypeCode<T>(), layout))
+  {
+    return false;
+  }
+
+  return writeLayers(stream, matrix, layout.m_stride);
+}
+
+template<typename T>
+bool MatrixFile::writeLayers(std::ofstream& stream, const Matrix<T>& matrix, unsigned int stride)
+{
+  // the rows are collected in a chunk, so the padding is written as 0 and not as uninitialized memory
+  size_t rowSize = static_cast<size_t>(stride) * sizeof(T);
+  unsigned int rowsPerChunk = static_cast<unsigned int>(std::max(static_cast<size_t>(1), ChunkSize / rowSize));
+  unsigned int height = matrix.getHeight();
+  size_t usedSize = static_cast<size_t>(matrix.getWidth()) * sizeof(T);
+  std::vector<char> chunk(rowSize * std::min(rowsPerChunk, height), 0);
+
+  for (unsigned int z = 0; z < matrix.getQtyLayers(); z++)
+  {
+    for (unsigned int firstRow = 0; firstRow < height; firstRow += rowsPerChunk)
+    {
+      unsigned int lastRow = std::min(firstRow + rowsPerChunk, height);
+
+      for (unsigned int y = firstRow; y < lastRow; y++)
+      {
+        memcpy(&chunk[(y - firstRow) * rowSize], matrix.getRow(y, z), usedSize);
+      }
+
+      stream.write(&chunk[0], (lastRow - firstRow) * rowSize);
+    }
+  }
+
+  return static_cast<bool>(stream);
+}
+
+template<typename T>
+bool MatrixFile::read(const std::string& fileName, Matrix<T>& matrix)
+{
+  std::ifstream stream(fileName.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  stream.seekg(0, std::ios::end);
+  size_t fileSize = static_cast<size_t>(stream.tellg());
+  stream.seekg(0, std::ios::beg);
+
+  unsigned char header[HeaderSize];
+  if (!stream.read(reinterpret_cast<char*>(header), HeaderSize))
+  {
+    return false;
+  }
+
+  Layout layout;
+  if (!readHeader(header, fileSize, getTypeCode<T>(), sizeof(T), layout))
+  {
+    return false;
+  }
+
+  matrix = Matrix<T>(layout.m_width, layout.m_height, layout.m_qtyLayers, false);
+  stream.seekg(layout.m_dataOffset, std::ios::beg);
+
+  size_t fileRowSize = static_cast<size_t>(layout.m_stride) * sizeof(T);
+
+  for (unsigned int z = 0; z < layout.m_qtyLayers; z++)
+  {
+    // the stride only differs, if the file was written on a machine with another cache line size
+    if (matrix.getStride() == layout.m_stride)
+    {
+      stream.read(reinterpret_cast<char*>(matrix.getRow(0, z)), fileRowSize * layout.m_height);
+      continue;
+    }
+
+    for (unsigned int y = 0; y < layout.m_height; y++)
+    {
+      stream.read(reinterpret_cast<char*>(matrix.getRow(y, z)), static_cast<std::streamsize>(layout.m_width) * sizeof(T));
+      stream.seekg(fileRowSize - layout.m_width * sizeof(T), std::ios::cur);
+    }
+  }
+
+  return static_cast<bool>(stream);
+}
+
+template<typename T>
+bool MatrixFile::writePnm(const std::string& fileName, const Matrix<T>& matrix)
+{
+  unsigned int qtyLayers = matrix.getQtyLayers();
+
+  if (!std::numeric_limits<T>::is_integer || std::numeric_limits<T>::is_signed || std::is_same<T, bool>::value || sizeof(T) > 2)
+  {
+    return false;
+  }
+
+  if (qtyLayers != 1 && qtyLayers != 3)
+  {
+    return false;
+  }
+
+  std::ofstream stream(fileName.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  unsigned int width = matrix.getWidth();
+  unsigned int height = matrix.getHeight();
+
+  stream << (qtyLayers == 1 ? "P5" : "P6") << "\n" << width << " " << height << "\n" << static_cast<unsigned int>(std::numeric_limits<T>::max()) << "\n";
+
+  // one interleaved row, 16 bit samples are big endian
+  std::vector<unsigned char> row(static_cast<size_t>(width) * qtyLayers * sizeof(T));
+
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int z = 0; z < qtyLayers; z++)
+    {
+      const T* source = matrix.getRow(y, z);
+      unsigned char* destination = &row[z * sizeof(T)];
+
+      for (unsigned int x = 0; x < width; x++, destination += qtyLayers * sizeof(T))
+      {
+        unsigned int value = static_cast<unsigned int>(source[x]);
+
+        if (sizeof(T) == 1)
+        {
+          destination[0] = static_cast<unsigned char>(value);
+        }
+        else
+        {
+          destination[0] = static_cast<unsigned char>(value >> 8);
+          destination[1] = static_cast<unsigned char>(value & 0xff);
+        }
+      }
+    }
+
+    stream.write(reinterpret_cast<const char*>(&row[0]), row.size());
+  }
+
+  return static_cast<bool>(stream);
+}
+
+template<typename T>
+bool MatrixFile::readPnm(const std::string& fileName, Matrix<T>& matrix)
+{
+  if (!std::numeric_limits<T>::is_integer || std::is_same<T, bool>::value)
+  {
+    return false;
+  }
+
+  std::ifstream stream(fileName.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  unsigned int qtyLayers = 0;
+  unsigned int width = 0;
+  unsigned int height = 0;
+  unsigned int maximum = 0;
+
+  if (!readPnmHeader(stream, qtyLayers, width, height, maximum))
+  {
+    return false;
+  }
+
+  unsigned int bytesPerSample = maximum < 256 ? 1 : 2;
+  if (maximum > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+  {
+    return false; // the samples do not fit into T
+  }
+
+  // the size in the header is checked against the file before anything is allocated
+  size_t dataSize;
+  if (!getDataSize(width, height, qtyLayers, bytesPerSample, dataSize) || dataSize > getRemainingSize(stream))
+  {
+    return false;
+  }
+
+  matrix = Matrix<T>(width, height, qtyLayers, false);
+
+  size_t samplesPerRow = static_cast<size_t>(width) * qtyLayers;
+  std::vector<unsigned char> row(samplesPerRow * bytesPerSample);
+
+  for (unsigned int y = 0; y < height; y++)
+  {
+    if (!stream.read(reinterpret_cast<char*>(&row[0]), row.size()))
+    {
+      return false;
+    }
+
+    for (unsigned int z = 0; z < qtyLayers; z++)
+    {
+      T* destination = matrix.getRow(y, z);
+
+      if (bytesPerSample == 1)
+      {
+        const unsigned char* source = &row[z];
+        for (unsigned int x = 0; x < width; x++, source += qtyLayers)
+        {
+          destination[x] = static_cast<T>(*source);
+        }
+      }
+      else
+      {
+        const unsigned char* source = &row[2 * z];
+        for (unsigned int x = 0; x < width; x++, source += 2 * qtyLayers)
+        {
+          destination[x] = static_cast<T>((source[0] << 8) | source[1]);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+bool MatrixFile::writeRaw(const std::string& fileName, const Matrix<T>& matrix)
+{
+  std::ofstream stream(fileName.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  std::streamsize rowSize = static_cast<std::streamsize>(matrix.getWidth()) * sizeof(T);
+
+  for (unsigned int z = 0; z < matrix.getQtyLayers(); z++)
+  {
+    for (unsigned int y = 0; y < matrix.getHeight(); y++)
+    {
+      stream.write(reinterpret_cast<const char*>(matrix.getRow(y, z)), rowSize);
+    }
+  }
+
+  return static_cast<bool>(stream);
+}
+
+template<typename T>
+bool MatrixFile::readRaw(const std::string& fileName, unsigned int width, unsigned int height, unsigned int qtyLayers, Matrix<T>& matrix, size_t headerSize)
+{
+  if (width == 0 || height == 0 || qtyLayers == 0)
+  {
+    return false;
+  }
+
+  std::ifstream stream(fileName.c_str(), std::ios::binary);
+  if (!stream)
+  {
+    return false;
+  }
+
+  stream.seekg(headerSize, std::ios::beg);
+
+  size_t dataSize;
+  if (!stream || !getDataSize(width, height, qtyLayers, sizeof(T), dataSize) || dataSize > getRemainingSize(stream))
+  {
+    return false;
+  }
+
+  matrix = Matrix<T>(width, height, qtyLayers, false);
+
+  std::streamsize rowSize = static_cast<std::streamsize>(width) * sizeof(T);
+
+  for (unsigned int z = 0; z < qtyLayers; z++)
+  {
+    for (unsigned int y = 0; y < height; y++)
+    {
+      if (!stream.read(reinterpret_cast<char*>(matrix.getRow(y, z)), rowSize))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+MappedMatrix<T>::MappedMatrix()
+{
+  memset(&m_layout, 0, sizeof(m_layout));
+}
+
+template<typename T>
+bool MappedMatrix<T>::open(const std::string& fileName)
+{
+  close();
+
+  std::shared_ptr<MappedFile> file(new MappedFile());
+  if (!file->open(fileName))
+  {
+    return false;
+  }
+
+  if (!MatrixFile::readHeader(file->getData(), file->getSize(), MatrixFile::getTypeCode<T>(), sizeof(T), m_layout))
+  {
+    return false;
+  }
+
+  m_file = file;
+  return true;
+}
+
+template<typename T>
+void MappedMatrix<T>::close()
+{
+  m_file.reset();
+  memset(&m_layout, 0, sizeof(m_layout));
+}
+
+template<typename T>
+bool MappedMatrix<T>::isOpen() const
+{
+  return m_file != 0;
+}
+
+template<typename T>
+unsigned int MappedMatrix<T>::getWidth() const
+{
+  return m_layout.m_width;
+}
+
+template<typename T>
+unsigned int MappedMatrix<T>::getHeight() const
+{
+  return m_layout.m_height;
+}
+
+template<typename T>
+unsigned int MappedMatrix<T>::getQtyLayers() const
+{
+  return m_layout.m_qtyLayers;
+}
+
+template<typename T>
+unsigned int MappedMatrix<T>::getStride() const
+{
+  return m_layout.m_stride;
+}
+
+template<typename T>
+MatrixView<const T> MappedMatrix<T>::getView(unsigned int z) const
+{
+  if (!m_file || z >= m_layout.m_qtyLayers)
+  {
+    return MatrixView<const T>();
+  }
+
+  const unsigned char* layer = m_file->getData() + m_layout.m_dataOffset + static_cast<size_t>(z) * m_layout.m_height * m_layout.m_stride * sizeof(T);
+  return MatrixView<const T>(reinterpret_cast<const T*>(layer), m_layout.m_width, m_layout.m_height, m_layout.m_stride);
+}
+
+#endif // MATRIXFILE_H
@@ -0,0 +1,134 @@
+#ifndef MATRIXVIEW_H
+#define MATRIXVIEW_H
+
+// non-owning view on a single layer or a sub-rectangle of a Matrix
+// the view is only valid as long as the viewed Matrix is alive and not resized
+// use MatrixView<const T> for read-only access
+
+template<typename T>
+class MatrixView
+{
+public:
+  MatrixView();
+  MatrixView(T* data, unsigned int width, unsigned int height, unsigned int stride);
+
+  template<typename U>
+  MatrixView(const MatrixView<U>& rhs);
+
+  unsigned int getWidth() const;
+  unsigned int getHeight() const;
+  unsigned int getStride() const;
+  T* getData() const;
+  bool isEmpty() const;
+
+  T* getRow(unsigned int y) const;
+  T getValue(unsigned int x, unsigned int y) const;
+  void setValue(T value, unsigned int x, unsigned int y) const;
+
+  MatrixView getSubView(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const;
+
+private:
+  T* m_data;
+  unsigned int m_width;
+  unsigned int m_height;
+  unsigned int m_stride;
+};
+
+template<typename T>
+MatrixView<T>::MatrixView() :
+  m_data(0),
+  m_width(0),
+  m_height(0),
+  m_stride(0)
+{
+}
+
+template<typename T>
+MatrixView<T>::MatrixView(T* data, unsigned int width, unsigned int height, unsigned int stride) :
+  m_data(data),
+  m_width(width),
+  m_height(height),
+  m_stride(stride)
+{
+}
+
+template<typename T>
+template<typename U>
+MatrixView<T>::MatrixView(const MatrixView<U>& rhs) :
+  m_data(rhs.getData()),
+  m_width(rhs.getWidth()),
+  m_height(rhs.getHeight()),
+  m_stride(rhs.getStride())
+{
+}
+
+template<typename T>
+inline unsigned int MatrixView<T>::getWidth() const
+{
+  return m_width;
+}
+
+template<typename T>
+inline unsigned int MatrixView<T>::getHeight() const
+{
+  return m_height;
+}
+
+template<typename T>
+inline unsigned int MatrixView<T>::getStride() const
+{
+  return m_stride;
+}
+
+template<typename T>
+inline T* MatrixView<T>::getData() const
+{
+  return m_data;
+}
+
+template<typename T>
+inline bool MatrixView<T>::isEmpty() const
+{
+  return m_data == 0 || m_width == 0 || m_height == 0;
+}
+
+template<typename T>
+inline T* MatrixView<T>::getRow(unsigned int y) const
+{
+  return m_data + static_cast<size_t>(y) * m_stride;
+}
+
+template<typename T>
+inline T MatrixView<T>::getValue(unsigned int x, unsigned int y) const
+{
+  return getRow(y)[x];
+}
+
+template<typename T>
+inline void MatrixView<T>::setValue(T value, unsigned int x, unsigned int y) const
+{
+  getRow(y)[x] = value;
+}
+
+template<typename T>
+MatrixView<T> MatrixView<T>::getSubView(unsigned int x, unsigned int y, unsigned int width, unsigned int height) const
+{
+  if (x >= m_width || y >= m_height)
+  {
+    return MatrixView();
+  }
+
+  if (x + width > m_width)
+  {
+    width = m_width - x;
+  }
+
+  if (y + height > m_height)
+  {
+    height = m_height - y;
+  }
+
+  return MatrixView(getRow(y) + x, width, height, m_stride);
+}
+
+#endif // MATRIXVIEW_H
@@ -0,0 +1,32 @@
+#include <cstdint>
+
+#include "MemoryHelper.h"
+
+void* MemoryHelper::allocateAligned(size_t size, size_t alignment)
+{
+  // the pointer returned by new[] is stored directly in front of the aligned block
+  unsigned char* raw = new unsigned char[size + alignment + sizeof(void*)];
+
+  uintptr_t address = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+  address = roundUp(address, alignment);
+
+  void* aligned = reinterpret_cast<void*>(address);
+  reinterpret_cast<void**>(aligned)[-1] = raw;
+
+  return aligned;
+}
+
+void MemoryHelper::freeAligned(void* buffer)
+{
+  if (buffer == 0)
+  {
+    return;
+  }
+
+  delete[] static_cast<unsigned char*>(reinterpret_cast<void**>(buffer)[-1]);
+}
+
+size_t MemoryHelper::roundUp(size_t value, size_t multiple)
+{
+  return ((value + multiple - 1) / multiple) * multiple;
+}
@@ -0,0 +1,16 @@
+#ifndef MEMORYHELPER_H
+#define MEMORYHELPER_H
+
+#include <cstddef>
+
+const size_t CacheLineSize = 64;
+
+class MemoryHelper
+{
+public:
+  static void* allocateAligned(size_t size, size_t alignment = CacheLineSize);
+  static void freeAligned(void* buffer);
+  static size_t roundUp(size_t value, size_t multiple);
+};
+
+#endif // MEMORYHELPER_H
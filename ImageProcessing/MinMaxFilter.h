@@ -0,0 +1,366 @@
+#ifndef MINMAXFILTER_H
+#define MINMAXFILTER_H
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "BufferPool.h"
+#include "MatrixView.h"
+
+// erosion (minimum) and dilation (maximum) with the algorithm of van Herk / Gil-Werman
+// a window of any length costs 3 comparisons per pixel
+// - rectangles (and horizontal / vertical lines) are split in a horizontal and a vertical pass
+// - diagonal lines (45 and 135 degree) are processed along the diagonals of the image
+// - all other shapes are decomposed in their horizontal runs, the cost grows with the height of the shape instead of its area
+template<typename T>
+class MinMaxFilter
+{
+public:
+  // same contract as the neighbourhood kernels of Matrix: only the pixels which are fully covered by the structuring element are written
+  // destination and source must not overlap
+  static void apply(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, bool minimum);
+
+private:
+  class Minimum
+  {
+  public:
+    static T apply(T a, T b) {return b < a ? b : a;}
+    static T identity() {return std::numeric_limits<T>::max();}
+  };
+
+  class Maximum
+  {
+  public:
+    static T apply(T a, T b) {return a < b ? b : a;}
+    static T identity() {return std::numeric_limits<T>::lowest();}
+  };
+
+  class Run
+  {
+  public:
+    unsigned int m_x;
+    unsigned int m_y;
+  };
+
+  template<typename Operation>
+  static void applyRectangle(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int width, unsigned int height, unsigned int offsetLeft, unsigned int offsetTop);
+
+  template<typename Operation>
+  static void applyDiagonal(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int length, bool antiDiagonal, unsigned int offsetLeft, unsigned int offsetTop);
+
+  template<typename Operation>
+  static void applyRuns(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop);
+
+  // destination[i] = operation(source[i] ... source[i + length - 1]) for i < qtyResults
+  // prefix and suffix must hold qtyResults + length - 1 values
+  template<typename Operation>
+  static void filterRow(const T* source, T* destination, unsigned int qtyResults, unsigned int length, T* prefix, T* suffix);
+
+  static bool isRectangle(const MatrixView<const bool>& structuringElement);
+  static bool isDiagonal(const MatrixView<const bool>& structuringElement, bool antiDiagonal);
+};
+
+template<typename T>
+void MinMaxFilter<T>::apply(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, bool minimum)
+{
+  unsigned int width = structuringElement.getWidth();
+  unsigned int height = structuringElement.getHeight();
+
+  if (structuringElement.isEmpty() || source.getWidth() < width || source.getHeight() < height)
+  {
+    return;
+  }
+
+  if (isRectangle(structuringElement))
+  {
+    minimum ? applyRectangle<Minimum>(source, destination, width, height, offsetLeft, offsetTop) : applyRectangle<Maximum>(source, destination, width, height, offsetLeft, offsetTop);
+  }
+  else if (isDiagonal(structuringElement, false) || isDiagonal(structuringElement, true))
+  {
+    bool antiDiagonal = isDiagonal(structuringElement, true);
+    minimum ? applyDiagonal<Minimum>(source, destination, width, antiDiagonal, offsetLeft, offsetTop) : applyDiagonal<Maximum>(source, destination, width, antiDiagonal, offsetLeft, offsetTop);
+  }
+  else
+  {
+    minimum ? applyRuns<Minimum>(source, destination, structuringElement, offsetLeft, offsetTop) : applyRuns<Maximum>(source, destination, structuringElement, offsetLeft, offsetTop);
+  }
+}
+
+template<typename T>
+template<typename Operation>
+void MinMaxFilter<T>::applyRectangle(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int width, unsigned int height, unsigned int offsetLeft, unsigned int offsetTop)
+{
+  unsigned int sourceWidth = source.getWidth();
+  unsigned int sourceHeight = source.getHeight();
+  unsigned int outputWidth = sourceWidth - width + 1;
+  unsigned int outputHeight = sourceHeight - height + 1;
+
+  // horizontal pass, the rows are used afterwards as prefix rows of the vertical pass
+  std::unique_ptr<T[], void(*)(void*)> prefix(static_cast<T*>(BufferPool::allocate(static_cast<size_t>(sourceHeight) * outputWidth * sizeof(T))), BufferPool::release);
+  std::unique_ptr<T[], void(*)(void*)> suffix(static_cast<T*>(BufferPool::allocate(static_cast<size_t>(sourceHeight) * outputWidth * sizeof(T))), BufferPool::release);
+  std::unique_ptr<T[], void(*)(void*)> rowPrefix(static_cast<T*>(BufferPool::allocate(sourceWidth * sizeof(T))), BufferPool::release);
+  std::unique_ptr<T[], void(*)(void*)> rowSuffix(static_cast<T*>(BufferPool::allocate(sourceWidth * sizeof(T))), BufferPool::release);
+
+  for (unsigned int y = 0; y < sourceHeight; y++)
+  {
+    filterRow<Operation>(source.getRow(y), &prefix[static_cast<size_t>(y) * outputWidth], outputWidth, width, &rowPrefix[0], &rowSuffix[0]);
+  }
+
+  // vertical pass: the same algorithm, but whole rows are combined at once
+  for (unsigned int blockBegin = 0; blockBegin < sourceHeight; blockBegin += height)
+  {
+    unsigned int blockEnd = std::min(blockBegin + height, sourceHeight);
+
+    for (unsigned int y = blockEnd - 1; y + 1 > blockBegin; y--)
+    {
+      const T* values = &prefix[static_cast<size_t>(y) * outputWidth];
+      T* suffixRow = &suffix[static_cast<size_t>(y) * outputWidth];
+
+      if (y == blockEnd - 1)
+      {
+        std::copy(values, values + outputWidth, suffixRow);
+      }
+      else
+      {
+        const T* previousSuffixRow = suffixRow + outputWidth;
+        for (unsigned int x = 0; x < outputWidth; x++)
+        {
+          suffixRow[x] = Operation::apply(previousSuffixRow[x], values[x]);
+        }
+      }
+    }
+
+    for (unsigned int y = blockBegin + 1; y < blockEnd; y++)
+    {
+      T* prefixRow = &prefix[static_cast<size_t>(y) * outputWidth];
+      const T* previousPrefixRow = prefixRow - outputWidth;
+
+      for (unsigned int x = 0; x < outputWidth; x++)
+      {
+        prefixRow[x] = Operation::apply(previousPrefixRow[x], prefixRow[x]);
+      }
+    }
+  }
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    const T* suffixRow = &suffix[static_cast<size_t>(y) * outputWidth];
+    const T* prefixRow = &prefix[static_cast<size_t>(y + height - 1) * outputWidth];
+    T* destinationRow = destination.getRow(y + offsetTop) + offsetLeft;
+
+    for (unsigned int x = 0; x < outputWidth; x++)
+    {
+      destinationRow[x] = Operation::apply(suffixRow[x], prefixRow[x]);
+    }
+  }
+}
+
+template<typename T>
+template<typename Operation>
+void MinMaxFilter<T>::applyDiagonal(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int length, bool antiDiagonal, unsigned int offsetLeft, unsigned int offsetTop)
+{
+  int width = source.getWidth();
+  int height = source.getHeight();
+  int directionX = antiDiagonal ? -1 : 1;
+  unsigned int maximumLength = std::min(width, height);
+
+  std::unique_ptr<T[], void(*)(void*)> values(static_cast<T*>(BufferPool::allocate(maximumLength * 4 * sizeof(T))), BufferPool::release);
+  T* diagonal = &values[0];
+  T* results = &values[maximumLength];
+  T* prefix = &values[maximumLength * 2];
+  T* suffix = &values[maximumLength * 3];
+
+  // every diagonal of the image starts in the first row or in the first (last) column
+  for (int start = 0; start < width + height - 1; start++)
+  {
+    int startX = start < width ? start : (antiDiagonal ? width - 1 : 0);
+    int startY = start < width ? 0 : start - width + 1;
+
+    unsigned int qtyValues = 0;
+    for (int x = startX, y = startY; x >= 0 && x < width && y < height; x += directionX, y++)
+    {
+      diagonal[qtyValues++] = source.getRow(y)[x];
+    }
+
+    if (qtyValues < length)
+    {
+      continue;
+    }
+
+    unsigned int qtyResults = qtyValues - length + 1;
+    filterRow<Operation>(diagonal, results, qtyResults, length, prefix, suffix);
+
+    // the window which starts at value i covers the structuring element whose top left corner is
+    // (startX + i, startY + i) for the main diagonal and (startX - i - length + 1, startY + i) for the anti diagonal
+    for (unsigned int i = 0; i < qtyResults; i++)
+    {
+      int left = antiDiagonal ? startX - static_cast<int>(i + length) + 1 : startX + static_cast<int>(i);
+      destination.getRow(startY + i + offsetTop)[left + offsetLeft] = results[i];
+    }
+  }
+}
+
+template<typename T>
+template<typename Operation>
+void MinMaxFilter<T>::applyRuns(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop)
+{
+  unsigned int sourceWidth = source.getWidth();
+  unsigned int sourceHeight = source.getHeight();
+  unsigned int outputWidth = sourceWidth - structuringElement.getWidth() + 1;
+  unsigned int outputHeight = sourceHeight - structuringElement.getHeight() + 1;
+
+  // runs of the structuring element, grouped by their length
+  std::map<unsigned int, std::vector<Run> > runs;
+  for (unsigned int y = 0; y < structuringElement.getHeight(); y++)
+  {
+    const bool* row = structuringElement.getRow(y);
+    for (unsigned int x = 0; x < structuringElement.getWidth(); x++)
+    {
+      if (row[x])
+      {
+        Run run;
+        run.m_x = x;
+        run.m_y = y;
+
+        unsigned int length = 1;
+        while (x + 1 < structuringElement.getWidth() && row[x + 1])
+        {
+          x++;
+          length++;
+        }
+
+        runs[length].push_back(run);
+      }
+    }
+  }
+
+  if (runs.empty())
+  {
+    return;
+  }
+
+  std::unique_ptr<T[], void(*)(void*)> result(static_cast<T*>(BufferPool::allocate(static_cast<size_t>(outputHeight) * outputWidth * sizeof(T))), BufferPool::release);
+  std::fill(&result[0], &result[0] + static_cast<size_t>(outputHeight) * outputWidth, Operation::identity());
+
+  std::unique_ptr<T[], void(*)(void*)> filtered(static_cast<T*>(BufferPool::allocate(static_cast<size_t>(sourceHeight) * sourceWidth * sizeof(T))), BufferPool::release);
+  std::unique_ptr<T[], void(*)(void*)> prefix(static_cast<T*>(BufferPool::allocate(sourceWidth * sizeof(T))), BufferPool::release);
+  std::unique_ptr<T[], void(*)(void*)> suffix(static_cast<T*>(BufferPool::allocate(sourceWidth * sizeof(T))), BufferPool::release);
+
+  for (typename std::map<unsigned int, std::vector<Run> >::const_iterator it = runs.begin(); it != runs.end(); ++it)
+  {
+    unsigned int length = it->first;
+    unsigned int qtyFiltered = sourceWidth - length + 1;
+
+    // every row is filtered once per run length, the result of every run is then a shifted row of it
+    for (unsigned int y = 0; y < sourceHeight; y++)
+    {
+      filterRow<Operation>(source.getRow(y), &filtered[static_cast<size_t>(y) * qtyFiltered], qtyFiltered, length, &prefix[0], &suffix[0]);
+    }
+
+    for (typename std::vector<Run>::const_iterator run = it->second.begin(); run != it->second.end(); ++run)
+    {
+      for (unsigned int y = 0; y < outputHeight; y++)
+      {
+        const T* filteredRow = &filtered[static_cast<size_t>(y + run->m_y) * qtyFiltered + run->m_x];
+        T* resultRow = &result[static_cast<size_t>(y) * outputWidth];
+
+        for (unsigned int x = 0; x < outputWidth; x++)
+        {
+          resultRow[x] = Operation::apply(resultRow[x], filteredRow[x]);
+        }
+      }
+    }
+  }
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    const T* resultRow = &result[static_cast<size_t>(y) * outputWidth];
+    std::copy(resultRow, resultRow + outputWidth, destination.getRow(y + offsetTop) + offsetLeft);
+  }
+}
+
+template<typename T>
+template<typename Operation>
+void MinMaxFilter<T>::filterRow(const T* source, T* destination, unsigned int qtyResults, unsigned int length, T* prefix, T* suffix)
+{
+  if (length == 1)
+  {
+    std::copy(source, source + qtyResults, destination);
+    return;
+  }
+
+  // the values are split in blocks of length values: prefix holds the result from the begin of the block up to i,
+  // suffix from i up to the end of the block, every window covers the suffix of one block and the prefix of the next one
+  unsigned int qtyValues = qtyResults + length - 1;
+
+  for (unsigned int blockBegin = 0; blockBegin < qtyValues; blockBegin += length)
+  {
+    unsigned int blockEnd = std::min(blockBegin + length, qtyValues);
+
+    prefix[blockBegin] = source[blockBegin];
+    for (unsigned int i = blockBegin + 1; i < blockEnd; i++)
+    {
+      prefix[i] = Operation::apply(prefix[i - 1], source[i]);
+    }
+
+    suffix[blockEnd - 1] = source[blockEnd - 1];
+    for (unsigned int i = blockEnd - 1; i > blockBegin; i--)
+    {
+      suffix[i - 1] = Operation::apply(suffix[i], source[i - 1]);
+    }
+  }
+
+  for (unsigned int i = 0; i < qtyResults; i++)
+  {
+    destination[i] = Operation::apply(suffix[i], prefix[i + length - 1]);
+  }
+}
+
+template<typename T>
+bool MinMaxFilter<T>::isRectangle(const MatrixView<const bool>& structuringElement)
+{
+  for (unsigned int y = 0; y < structuringElement.getHeight(); y++)
+  {
+    const bool* row = structuringElement.getRow(y);
+    for (unsigned int x = 0; x < structuringElement.getWidth(); x++)
+    {
+      if (!row[x])
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+bool MinMaxFilter<T>::isDiagonal(const MatrixView<const bool>& structuringElement, bool antiDiagonal)
+{
+  unsigned int size = structuringElement.getWidth();
+
+  if (size != structuringElement.getHeight() || size < 2)
+  {
+    return false;
+  }
+
+  for (unsigned int y = 0; y < size; y++)
+  {
+    const bool* row = structuringElement.getRow(y);
+    for (unsigned int x = 0; x < size; x++)
+    {
+      bool onDiagonal = antiDiagonal ? (x == size - 1 - y) : (x == y);
+      if (row[x] != onDiagonal)
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+#endif // MINMAXFILTER_H
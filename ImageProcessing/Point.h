@@ -1,7 +1,7 @@
 #ifndef POINT_H
 #define POINT_H
 
-#include <list>
+#include <vector>
 
 class Point
 {
@@ -21,6 +21,6 @@ public:
   float m_y;
 };
 
-typedef std::list<Point> Points;
+typedef std::vector<Point> Points;
 
 #endif // POINT_H
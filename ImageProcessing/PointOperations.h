@@ -0,0 +1,432 @@
+#ifndef POINTOPERATIONS_H
+#define POINTOPERATIONS_H
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "MatrixView.h"
+#include "Region.h"
+#include "ThreadPool.h"
+
+// per pixel operations, every operation maps one value to one value
+// they have the same results as the corresponding methods of Matrix
+template<typename T>
+class PointOperators
+{
+public:
+  class Identity
+  {
+  public:
+    T operator()(T value) const {return value;}
+  };
+
+  class Invert
+  {
+  public:
+    T operator()(T value) const;
+  };
+
+  class Binarize
+  {
+  public:
+    explicit Binarize(T threshold) : m_threshold(threshold) {}
+    T operator()(T value) const {return value < m_threshold ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();}
+
+  private:
+    T m_threshold;
+  };
+
+  class Replace
+  {
+  public:
+    Replace(T currentValue, T newValue) : m_currentValue(currentValue), m_newValue(newValue) {}
+    T operator()(T value) const {return value == m_currentValue ? m_newValue : value;}
+
+  private:
+    T m_currentValue;
+    T m_newValue;
+  };
+
+  // the values are mapped from minimum ... maximum to 0 ... max of T with the same integer arithmetic as Matrix::spread
+  class Spread
+  {
+  public:
+    Spread(T minimum, T maximum) : m_minimum(minimum), m_maximum(maximum) {}
+    T operator()(T value) const;
+
+  private:
+    T m_minimum;
+    T m_maximum;
+  };
+
+  // the table is not copied, it must be alive until the pipeline is applied
+  // only unsigned integer types up to 16 bit (and bool) have a table, the operation does nothing for all other types
+  class LookUpTable
+  {
+  public:
+    explicit LookUpTable(const std::vector<T>& lookUpTable);
+    T operator()(T value) const {return m_lookUpTable ? (*m_lookUpTable)[static_cast<size_t>(value)] : value;}
+
+  private:
+    const std::vector<T>* m_lookUpTable; // 0, if the table is not applicable, std::vector<bool> has no pointer to its values
+  };
+
+  // number of values of T = size of a table, which is indexed with value - min of T, 0 for types wider than 16 bit
+  static size_t getQtyValues();
+
+  template<typename First, typename Second>
+  class Chain
+  {
+  public:
+    Chain(const First& first, const Second& second) : m_first(first), m_second(second) {}
+    T operator()(T value) const {return m_second(m_first(value));}
+
+  private:
+    First m_first;
+    Second m_second;
+  };
+};
+
+// lazy pipeline of point operations, the operations are composed at compile time and applied in one pass over the view
+// example: image.pointOperations().lookUpTable(gamma).invert().binarize(128).apply();
+// integer types up to 16 bit fold the whole chain into one look up table, if this is cheaper than evaluating it per pixel
+template<typename T, typename Operation = typename PointOperators<T>::Identity>
+class PointOperations
+{
+public:
+  explicit PointOperations(const MatrixView<T>& view, const Operation& operation = Operation(), unsigned int qtyOperations = 0, bool hasLookUpTable = false);
+
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Invert> > invert() const;
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Binarize> > binarize(T threshold) const;
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Replace> > replace(T currentValue, T newValue) const;
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Spread> > spread(T minimum, T maximum) const;
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::LookUpTable> > lookUpTable(const std::vector<T>& lookUpTable) const;
+
+  // any functor T(T), e.g. a lambda
+  template<typename Function>
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, Function> > map(const Function& function) const;
+
+  T operator()(T value) const {return m_operation(value);}
+
+  // qtyThreads: 0 -> all threads of ThreadPool::getInstance(), 1 -> single threaded
+  void apply(unsigned int qtyThreads = 0) const;
+
+  // only the pixels of the region are changed, the coordinates of the region are relative to the view
+  void apply(const Region& region, unsigned int qtyThreads = 0) const;
+
+private:
+  template<typename Next>
+  PointOperations<T, typename PointOperators<T>::template Chain<Operation, Next> > append(const Next& next, bool isLookUpTable) const;
+
+  bool useFoldedTable(size_t qtyPixels) const;
+  std::unique_ptr<T[]> createFoldedTable(size_t qtyPixels) const;
+  void applyRows(unsigned int firstRow, unsigned int lastRow, const T* foldedTable) const;
+  void applySpans(const Region::Span* first, const Region::Span* last, const T* foldedTable) const;
+  static unsigned int getQtyTasks(unsigned int qtyThreads, unsigned int qtyItems, unsigned int minimumQtyItemsPerTask);
+
+  static const unsigned int MinimumQtyRowsPerTask = 16;
+  static const unsigned int MinimumQtySpansPerTask = 64;
+
+  MatrixView<T> m_view;
+  Operation m_operation;
+  unsigned int m_qtyOperations;
+  bool m_hasLookUpTable;
+};
+
+template<typename T>
+T PointOperators<T>::Invert::operator()(T value) const
+{
+  if (std::is_same<T, bool>::value)
+  {
+    return !value;
+  }
+
+  if (std::numeric_limits<T>::is_signed)
+  {
+    return value; // TODO same as Matrix::invert
+  }
+
+  return std::numeric_limits<T>::max() - value;
+}
+
+template<typename T>
+T PointOperators<T>::Spread::operator()(T value) const
+{
+  if (std::numeric_limits<T>::is_signed || m_maximum == m_minimum)
+  {
+    return value; // TODO define spread-function for signed types
+  }
+
+  if (m_minimum != 0)
+  {
+    value -= m_minimum;
+  }
+
+  // the cast makes the conversion explicit for bool
+  value = static_cast<T>(value * (std::numeric_limits<T>::max() / (m_maximum - m_minimum)));
+
+  return value;
+}
+
+template<typename T>
+PointOperators<T>::LookUpTable::LookUpTable(const std::vector<T>& lookUpTable) :
+  m_lookUpTable(0)
+{
+  // same restrictions as Matrix::applyLookUpTable
+  if (std::numeric_limits<T>::is_signed || getQtyValues() == 0)
+  {
+    return; // TODO how to define a LUT for negative values?
+  }
+
+  if (lookUpTable.size() < getQtyValues())
+  {
+    return; // LUT not fully defined
+  }
+
+  m_lookUpTable = &lookUpTable;
+}
+
+template<typename T>
+size_t PointOperators<T>::getQtyValues()
+{
+  if (!std::numeric_limits<T>::is_integer || sizeof(T) > 2)
+  {
+    return 0;
+  }
+
+  // the shift is limited to 16 bit, so it is valid for every type
+  return std::numeric_limits<T>::digits == 1 ? 2 : static_cast<size_t>(1) << (sizeof(T) <= 2 ? 8 * sizeof(T) : 16);
+}
+
+template<typename T, typename Operation>
+PointOperations<T, Operation>::PointOperations(const MatrixView<T>& view, const Operation& operation, unsigned int qtyOperations, bool hasLookUpTable) :
+  m_view(view),
+  m_operation(operation),
+  m_qtyOperations(qtyOperations),
+  m_hasLookUpTable(hasLookUpTable)
+{
+}
+
+template<typename T, typename Operation>
+template<typename Next>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, Next> > PointOperations<T, Operation>::append(const Next& next, bool isLookUpTable) const
+{
+  typedef typename PointOperators<T>::template Chain<Operation, Next> Chained;
+  return PointOperations<T, Chained>(m_view, Chained(m_operation, next), m_qtyOperations + 1, m_hasLookUpTable || isLookUpTable);
+}
+
+template<typename T, typename Operation>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Invert> > PointOperations<T, Operation>::invert() const
+{
+  return append(typename PointOperators<T>::Invert(), false);
+}
+
+template<typename T, typename Operation>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Binarize> > PointOperations<T, Operation>::binarize(T threshold) const
+{
+  return append(typename PointOperators<T>::Binarize(threshold), false);
+}
+
+template<typename T, typename Operation>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Replace> > PointOperations<T, Operation>::replace(T currentValue, T newValue) const
+{
+  return append(typename PointOperators<T>::Replace(currentValue, newValue), false);
+}
+
+template<typename T, typename Operation>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::Spread> > PointOperations<T, Operation>::spread(T minimum, T maximum) const
+{
+  return append(typename PointOperators<T>::Spread(minimum, maximum), false);
+}
+
+template<typename T, typename Operation>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, typename PointOperators<T>::LookUpTable> > PointOperations<T, Operation>::lookUpTable(const std::vector<T>& lookUpTable) const
+{
+  return append(typename PointOperators<T>::LookUpTable(lookUpTable), true);
+}
+
+template<typename T, typename Operation>
+template<typename Function>
+PointOperations<T, typename PointOperators<T>::template Chain<Operation, Function> > PointOperations<T, Operation>::map(const Function& function) const
+{
+  // a user defined function may be expensive, so it is treated like a look up table
+  return append(function, true);
+}
+
+template<typename T, typename Operation>
+bool PointOperations<T, Operation>::useFoldedTable(size_t qtyPixels) const
+{
+  if (PointOperators<T>::getQtyValues() == 0 || std::is_same<T, bool>::value)
+  {
+    return false;
+  }
+
+  // a single simple operation is vectorized by the compiler, a table look up is not
+  if (m_qtyOperations < 2 && !m_hasLookUpTable)
+  {
+    return false;
+  }
+
+  // building the table must be cheap compared to the processed pixels
+  return qtyPixels >= 4 * PointOperators<T>::getQtyValues();
+}
+
+template<typename T, typename Operation>
+std::unique_ptr<T[]> PointOperations<T, Operation>::createFoldedTable(size_t qtyPixels) const
+{
+  // the table is indexed with value - min of T
+  std::unique_ptr<T[]> foldedTable;
+  if (useFoldedTable(qtyPixels))
+  {
+    size_t tableSize = PointOperators<T>::getQtyValues();
+    foldedTable.reset(new T[tableSize]);
+
+    long long minimum = std::numeric_limits<T>::min();
+    for (size_t i = 0; i < tableSize; i++)
+    {
+      foldedTable[i] = m_operation(static_cast<T>(minimum + static_cast<long long>(i)));
+    }
+  }
+
+  return foldedTable;
+}
+
+template<typename T, typename Operation>
+unsigned int PointOperations<T, Operation>::getQtyTasks(unsigned int qtyThreads, unsigned int qtyItems, unsigned int minimumQtyItemsPerTask)
+{
+  return std::max(1u, std::min(qtyThreads, qtyItems / minimumQtyItemsPerTask));
+}
+
+template<typename T, typename Operation>
+void PointOperations<T, Operation>::apply(unsigned int qtyThreads) const
+{
+  if (m_view.isEmpty() || m_qtyOperations == 0)
+  {
+    return;
+  }
+
+  std::unique_ptr<T[]> foldedTable = createFoldedTable(static_cast<size_t>(m_view.getWidth()) * m_view.getHeight());
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int height = m_view.getHeight();
+  unsigned int qtyTasks = getQtyTasks(qtyThreads, height, MinimumQtyRowsPerTask);
+
+  threadPool.run(qtyTasks, [&](unsigned int task)
+  {
+    unsigned int firstRow = static_cast<unsigned int>(static_cast<unsigned long long>(height) * task / qtyTasks);
+    unsigned int lastRow = static_cast<unsigned int>(static_cast<unsigned long long>(height) * (task + 1) / qtyTasks);
+    applyRows(firstRow, lastRow, foldedTable.get());
+  }, qtyThreads);
+}
+
+template<typename T, typename Operation>
+void PointOperations<T, Operation>::apply(const Region& region, unsigned int qtyThreads) const
+{
+  if (m_view.isEmpty() || m_qtyOperations == 0)
+  {
+    return;
+  }
+
+  Region clipped = region.clip(m_view.getWidth(), m_view.getHeight());
+  if (clipped.isEmpty())
+  {
+    return;
+  }
+
+  // a rectangle is processed row by row like a view
+  if (clipped.isRectangle())
+  {
+    MatrixView<T> view = m_view.getSubView(clipped.getLeft(), clipped.getTop(), clipped.getRight() - clipped.getLeft(), clipped.getBottom() - clipped.getTop());
+    PointOperations<T, Operation>(view, m_operation, m_qtyOperations, m_hasLookUpTable).apply(qtyThreads);
+    return;
+  }
+
+  std::unique_ptr<T[]> foldedTable = createFoldedTable(clipped.getQtyPixels());
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  // the spans are disjoint, so they can be processed in any order
+  const std::vector<Region::Span>& spans = clipped.getSpans();
+  unsigned int qtySpans = static_cast<unsigned int>(spans.size());
+  unsigned int qtyTasks = getQtyTasks(qtyThreads, qtySpans, MinimumQtySpansPerTask);
+
+  threadPool.run(qtyTasks, [&](unsigned int task)
+  {
+    unsigned int first = static_cast<unsigned int>(static_cast<unsigned long long>(qtySpans) * task / qtyTasks);
+    unsigned int last = static_cast<unsigned int>(static_cast<unsigned long long>(qtySpans) * (task + 1) / qtyTasks);
+    applySpans(&spans[0] + first, &spans[0] + last, foldedTable.get());
+  }, qtyThreads);
+}
+
+template<typename T, typename Operation>
+void PointOperations<T, Operation>::applyRows(unsigned int firstRow, unsigned int lastRow, const T* foldedTable) const
+{
+  unsigned int width = m_view.getWidth();
+
+  if (foldedTable)
+  {
+    long long minimum = std::numeric_limits<T>::min();
+
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      T* row = m_view.getRow(y);
+      for (unsigned int x = 0; x < width; x++)
+      {
+        row[x] = foldedTable[static_cast<long long>(row[x]) - minimum];
+      }
+    }
+    return;
+  }
+
+  // the composed operation is inlined into this loop, so the compiler can vectorize simple chains
+  Operation operation = m_operation;
+  for (unsigned int y = firstRow; y < lastRow; y++)
+  {
+    T* row = m_view.getRow(y);
+    for (unsigned int x = 0; x < width; x++)
+    {
+      row[x] = operation(row[x]);
+    }
+  }
+}
+
+template<typename T, typename Operation>
+void PointOperations<T, Operation>::applySpans(const Region::Span* first, const Region::Span* last, const T* foldedTable) const
+{
+  long long minimum = std::numeric_limits<T>::min();
+  Operation operation = m_operation;
+
+  for (const Region::Span* span = first; span != last; span++)
+  {
+    T* it = m_view.getRow(span->m_y) + span->m_x;
+
+    if (foldedTable)
+    {
+      for (unsigned int i = 0; i < span->m_length; i++)
+      {
+        it[i] = foldedTable[static_cast<long long>(it[i]) - minimum];
+      }
+    }
+    else
+    {
+      for (unsigned int i = 0; i < span->m_length; i++)
+      {
+        it[i] = operation(it[i]);
+      }
+    }
+  }
+}
+
+#endif // POINTOPERATIONS_H
@@ -0,0 +1,114 @@
+#include <list>
+#include <math.h>
+#include <mutex>
+
+#include "MathHelper.h"
+#include "PolarTransformation.h"
+
+std::shared_ptr<const PolarTransformation> PolarTransformation::get(unsigned int radius, unsigned int stride, Interpolation interpolation)
+{
+  // least recently used tables are at the end of the list
+  static std::mutex cacheMutex;
+  static std::list<std::shared_ptr<const PolarTransformation> > cache;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  for (auto it = cache.begin(); it != cache.end(); it++)
+  {
+    const PolarTransformation& cached = **it;
+    if (cached.m_radius == radius && cached.m_stride == stride && cached.m_interpolation == interpolation)
+    {
+      cache.splice(cache.begin(), cache, it);
+      return cache.front();
+    }
+  }
+
+  // a table which is evicted stays alive as long as it is used
+  cache.push_front(std::shared_ptr<const PolarTransformation>(new PolarTransformation(radius, stride, interpolation)));
+  if (cache.size() > QtyCachedTables)
+  {
+    cache.pop_back();
+  }
+
+  return cache.front();
+}
+
+PolarTransformation::PolarTransformation(unsigned int radius, unsigned int stride, Interpolation interpolation) :
+  m_radius(radius),
+  m_stride(stride),
+  m_interpolation(interpolation)
+{
+  m_circumference = radius * 2 * PI + 0.5;
+
+  m_width = m_circumference;
+  if (m_width % 4 != 0)
+  {
+    m_width += (4 - (m_width % 4)); // round up -> width % 4 needs to be zero!
+  }
+
+  // the trigonometry is calculated once per angle, all radii are multiples of it
+  std::vector<double> cosines(m_circumference);
+  std::vector<double> sines(m_circumference);
+  for (unsigned int x = 0; x < m_circumference; x++)
+  {
+    double angle = 2 * PI * x / m_circumference;
+    cosines[x] = cos(angle);
+    sines[x] = sin(angle);
+  }
+
+  size_t size = static_cast<size_t>(m_circumference) * m_radius;
+
+  if (interpolation == NearestNeighbour)
+  {
+    m_offsets.resize(size);
+  }
+  else
+  {
+    m_samples.resize(size);
+  }
+
+  for (unsigned int y = 0; y < m_radius; y++)
+  {
+    for (unsigned int x = 0; x < m_circumference; x++)
+    {
+      size_t index = static_cast<size_t>(y) * m_circumference + x;
+      double sourceX = y * cosines[x];
+      double sourceY = y * sines[x];
+
+      if (interpolation == NearestNeighbour)
+      {
+        ptrdiff_t nearestX = static_cast<ptrdiff_t>(floor(sourceX + 0.5));
+        ptrdiff_t nearestY = static_cast<ptrdiff_t>(floor(sourceY + 0.5));
+        m_offsets[index] = nearestY * static_cast<ptrdiff_t>(stride) + nearestX;
+      }
+      else
+      {
+        // |sourceX|, |sourceY| <= radius - 1, a neighbour with weight 0 is replaced by the pixel itself -> all reads are inside the circle
+        double leftX = floor(sourceX);
+        double topY = floor(sourceY);
+
+        BilinearSample& sample = m_samples[index];
+        sample.m_offset = static_cast<ptrdiff_t>(topY) * static_cast<ptrdiff_t>(stride) + static_cast<ptrdiff_t>(leftX);
+        sample.m_weightX = sourceX - leftX;
+        sample.m_weightY = sourceY - topY;
+        sample.m_stepX = sample.m_weightX > 0.0f ? 1 : 0;
+        sample.m_stepY = sample.m_weightY > 0.0f ? static_cast<ptrdiff_t>(stride) : 0;
+      }
+    }
+  }
+}
+
+unsigned int PolarTransformation::getWidth() const
+{
+  return m_width;
+}
+
+unsigned int PolarTransformation::getHeight() const
+{
+  return m_radius;
+}
+
+unsigned int PolarTransformation::getCircumference() const
+{
+  return m_circumference;
+}
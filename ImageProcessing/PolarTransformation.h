@@ -0,0 +1,101 @@
+#ifndef POLARTRANSFORMATION_H
+#define POLARTRANSFORMATION_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "MatrixView.h"
+
+// remap table of the polar transformation of a circle: x of the result is the angle, y is the radius
+// the offsets of the source pixels are relative to the center pixel, so the table only depends on the radius, the stride
+// of the source and the interpolation -> the tables of the last used geometries are cached and shared
+class PolarTransformation
+{
+public:
+  enum Interpolation
+  {
+    NearestNeighbour,
+    Bilinear
+  };
+
+  // the source must contain the whole circle around the center
+  static std::shared_ptr<const PolarTransformation> get(unsigned int radius, unsigned int stride, Interpolation interpolation);
+
+  unsigned int getWidth() const; // circumference rounded up to a multiple of 4, the columns behind the circumference are not written
+  unsigned int getHeight() const; // radius
+  unsigned int getCircumference() const;
+
+  // writes the rows firstRow ... lastRow - 1 of destination
+  template<typename T>
+  void apply(const T* center, const MatrixView<T>& destination, unsigned int firstRow, unsigned int lastRow) const;
+
+private:
+  PolarTransformation(unsigned int radius, unsigned int stride, Interpolation interpolation);
+
+  class BilinearSample
+  {
+  public:
+    ptrdiff_t m_offset; // top left neighbour
+    ptrdiff_t m_stepX; // 0, if weightX is 0 -> the right neighbour is never read outside the circle
+    ptrdiff_t m_stepY;
+    float m_weightX;
+    float m_weightY;
+  };
+
+  static const unsigned int QtyCachedTables = 8;
+
+  unsigned int m_radius;
+  unsigned int m_stride;
+  unsigned int m_circumference;
+  unsigned int m_width;
+  Interpolation m_interpolation;
+  std::vector<ptrdiff_t> m_offsets; // nearest neighbour, m_circumference values per row
+  std::vector<BilinearSample> m_samples; // bilinear, m_circumference values per row
+};
+
+template<typename T>
+void PolarTransformation::apply(const T* center, const MatrixView<T>& destination, unsigned int firstRow, unsigned int lastRow) const
+{
+  for (unsigned int y = firstRow; y < lastRow && y < m_radius; y++)
+  {
+    T* row = destination.getRow(y);
+
+    if (m_interpolation == NearestNeighbour)
+    {
+      // pure gather, the compiler may use gather instructions if they are available
+      const ptrdiff_t* offsets = &m_offsets[static_cast<size_t>(y) * m_circumference];
+      for (unsigned int x = 0; x < m_circumference; x++)
+      {
+        row[x] = center[offsets[x]];
+      }
+    }
+    else
+    {
+      const BilinearSample* sample = &m_samples[static_cast<size_t>(y) * m_circumference];
+      for (unsigned int x = 0; x < m_circumference; x++, sample++)
+      {
+        const T* topLeft = center + sample->m_offset;
+        const T* bottomLeft = topLeft + sample->m_stepY;
+
+        double top = topLeft[0] + sample->m_weightX * (static_cast<double>(topLeft[sample->m_stepX]) - topLeft[0]);
+        double bottom = bottomLeft[0] + sample->m_weightX * (static_cast<double>(bottomLeft[sample->m_stepX]) - bottomLeft[0]);
+        double value = top + sample->m_weightY * (bottom - top);
+
+        // the value is between its neighbours, so it fits into T
+        if (std::numeric_limits<T>::is_integer)
+        {
+          value > 0 ? value += 0.5 : value -= 0.5;
+          row[x] = static_cast<T>(static_cast<long long>(value)); // via long long, so bool is rounded too
+        }
+        else
+        {
+          row[x] = static_cast<T>(value);
+        }
+      }
+    }
+  }
+}
+
+#endif // POLARTRANSFORMATION_H
@@ -1,4 +1,5 @@
 #include <limits>
+#include <math.h>
 
 #include "PolyLine.h"
 #include "Matrix.h"
@@ -52,17 +53,10 @@ RunLengthCode PolyLine::toRunLengthCode()
 
   StructuringElement structuringElement(rectangle.m_width, rectangle.m_height, false);
   structuringElement.setPolyLine(true, converted);
-  structuringElement.fillBackground(false, true);
-  structuringElement.invert();
-  structuringElement.setPolyLine(true, converted);
+  structuringElement.fillHoles(false, true);
 
   RunLengthCode runLengthCode = structuringElement.getRunLengthCode(true);
-
-  for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
-  {
-    it->m_startPoint.m_x += xMin;
-    it->m_startPoint.m_y += yMin;
-  }
+  runLengthCode.translate(static_cast<int>(floor(xMin + 0.5)), static_cast<int>(floor(yMin + 0.5)));
 
   return runLengthCode;
 }
@@ -1,14 +1,14 @@
 #ifndef POLYLINE_H
 #define POLYLINE_H
 
-#include <list>
+#include <vector>
 
 #include "Point.h"
 #include "RunLengthCode.h"
 
 class Rectangle;
 
-class PolyLine : public std::list<Point>
+class PolyLine : public std::vector<Point>
 {
 public:
   PolyLine();
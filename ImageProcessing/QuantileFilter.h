@@ -0,0 +1,443 @@
+#ifndef QUANTILEFILTER_H
+#define QUANTILEFILTER_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "MatrixView.h"
+
+// quantile (and median) filter for all types except bool
+// - integer types up to 16 bit use a histogram with coarse and fine bins, signed values are binned with an offset
+//   - rectangles use the constant time algorithm of Perreault / Hebert: one histogram per column, which is moved down
+//     row by row, the histogram of the window is the sum of the column histograms
+//   - other shapes move a single histogram in a serpentine over the image, only the pixels at the border of the shape are updated
+// - all other types select the quantile with std::nth_element
+template<typename T>
+class QuantileFilter
+{
+public:
+  // same contract as the neighbourhood kernels of Matrix: only the pixels which are fully covered by the structuring element are written
+  // destination and source must not overlap
+  // for quantil == 0.5 and an even number of values the mean of the two middle values is used
+  static void apply(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, double quantil);
+
+private:
+  static const bool UseHistogram = std::numeric_limits<T>::is_integer && sizeof(T) <= 2;
+  static const unsigned int QtyBits = UseHistogram ? 8 * sizeof(T) : 8;
+  static const unsigned int QtyFineBits = QtyBits - QtyBits / 2;
+  static const unsigned int QtyCoarseBins = 1u << (QtyBits / 2);
+  static const unsigned int QtyFineBins = 1u << QtyFineBits; // per coarse bin
+  static const unsigned int QtyBins = 1u << QtyBits;
+
+  static const unsigned int ColumnHistogramBudget = 8 * 1024 * 1024; // bytes of the column histograms of one strip
+
+  class Offset
+  {
+  public:
+    Offset(int x, int y) : m_x(x), m_y(y) {}
+    int m_x;
+    int m_y;
+  };
+
+  static void applyColumns(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int width, unsigned int height, unsigned int offsetLeft, unsigned int offsetTop, unsigned int rank, bool average);
+  static void applySliding(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, unsigned int rank, bool average);
+  static void applySelection(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, unsigned int rank, bool average);
+
+  static void addColumns(const T* row, unsigned int qtyColumns, unsigned short* columnCoarse, unsigned short* columnFine, int delta);
+  static std::vector<Offset> getChangedOffsets(const MatrixView<const bool>& structuringElement, int dx, int dy);
+  static bool isValueSet(const MatrixView<const bool>& structuringElement, int x, int y);
+  static bool isRectangle(const MatrixView<const bool>& structuringElement);
+
+  static unsigned int toKey(T value);
+  static T fromKey(unsigned int key);
+  static T combine(T lower, T upper, bool average);
+};
+
+template<typename T>
+void QuantileFilter<T>::apply(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, double quantil)
+{
+  if (structuringElement.isEmpty() || source.getWidth() < structuringElement.getWidth() || source.getHeight() < structuringElement.getHeight())
+  {
+    return;
+  }
+
+  unsigned int sumOfSetValues = 0;
+  for (unsigned int y = 0; y < structuringElement.getHeight(); y++)
+  {
+    const bool* row = structuringElement.getRow(y);
+    sumOfSetValues += std::count(row, row + structuringElement.getWidth(), true);
+  }
+
+  if (sumOfSetValues == 0)
+  {
+    return;
+  }
+
+  // rank of the result within the sorted values of the window
+  unsigned int rank = quantil * sumOfSetValues;
+  if (rank > sumOfSetValues - 1)
+  {
+    rank = sumOfSetValues - 1;
+  }
+
+  bool average = (sumOfSetValues % 2 == 0 && quantil == 0.5);
+
+  // the cost of the column histograms is constant, but grows with the number of bins: they pay off from about 5 rows (8 bit) or 64 rows (16 bit)
+  if (!UseHistogram)
+  {
+    applySelection(source, destination, structuringElement, offsetLeft, offsetTop, rank, average);
+  }
+  else if (isRectangle(structuringElement) && 8 * structuringElement.getHeight() > QtyCoarseBins + QtyFineBins)
+  {
+    applyColumns(source, destination, structuringElement.getWidth(), structuringElement.getHeight(), offsetLeft, offsetTop, rank, average);
+  }
+  else
+  {
+    applySliding(source, destination, structuringElement, offsetLeft, offsetTop, rank, average);
+  }
+}
+
+template<typename T>
+void QuantileFilter<T>::applyColumns(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int width, unsigned int height, unsigned int offsetLeft, unsigned int offsetTop, unsigned int rank, bool average)
+{
+  unsigned int outputWidth = source.getWidth() - width + 1;
+  unsigned int outputHeight = source.getHeight() - height + 1;
+
+  // the image is processed in vertical strips, so the column histograms of 16 bit images fit into the cache
+  unsigned int stripWidth = std::max<unsigned int>(ColumnHistogramBudget / (QtyBins * sizeof(unsigned short)), width);
+  unsigned int maximumQtyColumns = std::min(stripWidth, outputWidth) + width - 1;
+
+  std::vector<unsigned short> columnCoarse(maximumQtyColumns * QtyCoarseBins);
+  std::vector<unsigned short> columnFine(maximumQtyColumns * QtyBins);
+  std::vector<unsigned int> kernelCoarse(QtyCoarseBins);
+  std::vector<unsigned int> kernelFine(QtyBins);
+  std::vector<int> lastUpdate(QtyCoarseBins); // column of the window for which the fine bins of a coarse bin are valid
+
+  unsigned int column = 0;
+
+  // the fine bins of a coarse bin are only updated when they are needed
+  auto findValue = [&](unsigned int searchedRank) -> T
+  {
+    unsigned int coarse = 0;
+    unsigned int count = 0;
+    while (count + kernelCoarse[coarse] <= searchedRank)
+    {
+      count += kernelCoarse[coarse];
+      coarse++;
+    }
+
+    unsigned int* fine = &kernelFine[coarse * QtyFineBins];
+    int last = lastUpdate[coarse];
+
+    if (last >= 0 && column - last < width)
+    {
+      for (unsigned int c = last + 1; c <= column; c++)
+      {
+        const unsigned short* added = &columnFine[(c + width - 1) * QtyBins + coarse * QtyFineBins];
+        const unsigned short* removed = &columnFine[(c - 1) * QtyBins + coarse * QtyFineBins];
+
+        for (unsigned int i = 0; i < QtyFineBins; i++)
+        {
+          fine[i] += added[i] - removed[i];
+        }
+      }
+    }
+    else
+    {
+      std::fill(fine, fine + QtyFineBins, 0);
+
+      for (unsigned int c = column; c < column + width; c++)
+      {
+        const unsigned short* added = &columnFine[c * QtyBins + coarse * QtyFineBins];
+
+        for (unsigned int i = 0; i < QtyFineBins; i++)
+        {
+          fine[i] += added[i];
+        }
+      }
+    }
+    lastUpdate[coarse] = column;
+
+    unsigned int bin = 0;
+    while (count + fine[bin] <= searchedRank)
+    {
+      count += fine[bin];
+      bin++;
+    }
+
+    return fromKey(coarse * QtyFineBins + bin);
+  };
+
+  for (unsigned int stripBegin = 0; stripBegin < outputWidth; stripBegin += stripWidth)
+  {
+    unsigned int stripEnd = std::min(stripBegin + stripWidth, outputWidth);
+    unsigned int qtyColumns = stripEnd - stripBegin + width - 1;
+
+    std::fill(columnCoarse.begin(), columnCoarse.end(), 0);
+    std::fill(columnFine.begin(), columnFine.end(), 0);
+
+    for (unsigned int y = 0; y < height; y++)
+    {
+      addColumns(source.getRow(y) + stripBegin, qtyColumns, &columnCoarse[0], &columnFine[0], 1);
+    }
+
+    for (unsigned int y = 0; y < outputHeight; y++)
+    {
+      if (y > 0)
+      {
+        addColumns(source.getRow(y - 1) + stripBegin, qtyColumns, &columnCoarse[0], &columnFine[0], -1);
+        addColumns(source.getRow(y + height - 1) + stripBegin, qtyColumns, &columnCoarse[0], &columnFine[0], 1);
+      }
+
+      std::fill(kernelCoarse.begin(), kernelCoarse.end(), 0);
+      for (unsigned int c = 0; c < width; c++)
+      {
+        const unsigned short* added = &columnCoarse[c * QtyCoarseBins];
+        for (unsigned int i = 0; i < QtyCoarseBins; i++)
+        {
+          kernelCoarse[i] += added[i];
+        }
+      }
+      std::fill(lastUpdate.begin(), lastUpdate.end(), -1);
+
+      T* destinationRow = destination.getRow(y + offsetTop) + offsetLeft;
+
+      for (unsigned int x = stripBegin; x < stripEnd; x++)
+      {
+        column = x - stripBegin;
+
+        if (column > 0)
+        {
+          const unsigned short* added = &columnCoarse[(column + width - 1) * QtyCoarseBins];
+          const unsigned short* removed = &columnCoarse[(column - 1) * QtyCoarseBins];
+
+          for (unsigned int i = 0; i < QtyCoarseBins; i++)
+          {
+            kernelCoarse[i] += added[i] - removed[i];
+          }
+        }
+
+        T upper = findValue(rank);
+        destinationRow[x] = average ? combine(findValue(rank - 1), upper, true) : upper;
+      }
+    }
+  }
+}
+
+template<typename T>
+void QuantileFilter<T>::applySliding(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, unsigned int rank, bool average)
+{
+  unsigned int outputWidth = source.getWidth() - structuringElement.getWidth() + 1;
+  unsigned int outputHeight = source.getHeight() - structuringElement.getHeight() + 1;
+
+  // pixels which are added or removed, when the window moves right, left or down
+  std::vector<Offset> addedRight = getChangedOffsets(structuringElement, 1, 0);
+  std::vector<Offset> removedRight = getChangedOffsets(structuringElement, -1, 0);
+  std::vector<Offset> addedDown = getChangedOffsets(structuringElement, 0, 1);
+  std::vector<Offset> removedDown = getChangedOffsets(structuringElement, 0, -1);
+
+  std::vector<unsigned int> coarse(QtyCoarseBins);
+  std::vector<unsigned int> fine(QtyBins);
+
+  auto update = [&](const std::vector<Offset>& offsets, int x, int y, int delta)
+  {
+    for (typename std::vector<Offset>::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+    {
+      unsigned int key = toKey(source.getRow(y + it->m_y)[x + it->m_x]);
+      coarse[key >> QtyFineBits] += delta;
+      fine[key] += delta;
+    }
+  };
+
+  auto findValue = [&](unsigned int searchedRank) -> T
+  {
+    unsigned int bin = 0;
+    unsigned int count = 0;
+    while (count + coarse[bin] <= searchedRank)
+    {
+      count += coarse[bin];
+      bin++;
+    }
+
+    bin *= QtyFineBins;
+    while (count + fine[bin] <= searchedRank)
+    {
+      count += fine[bin];
+      bin++;
+    }
+
+    return fromKey(bin);
+  };
+
+  for (unsigned int y = 0; y < structuringElement.getHeight(); y++)
+  {
+    for (unsigned int x = 0; x < structuringElement.getWidth(); x++)
+    {
+      if (structuringElement.getRow(y)[x])
+      {
+        unsigned int key = toKey(source.getRow(y)[x]);
+        coarse[key >> QtyFineBits]++;
+        fine[key]++;
+      }
+    }
+  }
+
+  // serpentine: even rows from left to right, odd rows from right to left, so the window never jumps
+  int x = 0;
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    bool toTheRight = (y % 2 == 0);
+
+    for (unsigned int i = 0; i < outputWidth; i++)
+    {
+      if (i > 0)
+      {
+        if (toTheRight)
+        {
+          update(removedRight, x, y, -1);
+          x++;
+          update(addedRight, x, y, 1);
+        }
+        else
+        {
+          // moving left removes the pixels which moving right would add and vice versa
+          update(addedRight, x, y, -1);
+          x--;
+          update(removedRight, x, y, 1);
+        }
+      }
+
+      T upper = findValue(rank);
+      destination.getRow(y + offsetTop)[x + offsetLeft] = average ? combine(findValue(rank - 1), upper, true) : upper;
+    }
+
+    if (y + 1 < outputHeight)
+    {
+      update(removedDown, x, y, -1);
+      update(addedDown, x, y + 1, 1);
+    }
+  }
+}
+
+template<typename T>
+void QuantileFilter<T>::applySelection(const MatrixView<const T>& source, const MatrixView<T>& destination, const MatrixView<const bool>& structuringElement, unsigned int offsetLeft, unsigned int offsetTop, unsigned int rank, bool average)
+{
+  unsigned int outputWidth = source.getWidth() - structuringElement.getWidth() + 1;
+  unsigned int outputHeight = source.getHeight() - structuringElement.getHeight() + 1;
+
+  std::vector<Offset> offsets;
+  for (unsigned int y = 0; y < structuringElement.getHeight(); y++)
+  {
+    for (unsigned int x = 0; x < structuringElement.getWidth(); x++)
+    {
+      if (structuringElement.getRow(y)[x])
+      {
+        offsets.push_back(Offset(x, y));
+      }
+    }
+  }
+
+  std::vector<T> values(offsets.size());
+
+  for (unsigned int y = 0; y < outputHeight; y++)
+  {
+    T* destinationRow = destination.getRow(y + offsetTop) + offsetLeft;
+
+    for (unsigned int x = 0; x < outputWidth; x++)
+    {
+      for (unsigned int i = 0; i < offsets.size(); i++)
+      {
+        values[i] = source.getRow(y + offsets[i].m_y)[x + offsets[i].m_x];
+      }
+
+      // only the searched rank has to be sorted, the lower neighbour is the maximum of the values in front of it
+      std::nth_element(values.begin(), values.begin() + rank, values.end());
+      T upper = values[rank];
+      destinationRow[x] = average ? combine(*std::max_element(values.begin(), values.begin() + rank), upper, true) : upper;
+    }
+  }
+}
+
+template<typename T>
+void QuantileFilter<T>::addColumns(const T* row, unsigned int qtyColumns, unsigned short* columnCoarse, unsigned short* columnFine, int delta)
+{
+  for (unsigned int c = 0; c < qtyColumns; c++)
+  {
+    unsigned int key = toKey(row[c]);
+    columnCoarse[c * QtyCoarseBins + (key >> QtyFineBits)] += delta;
+    columnFine[c * QtyBins + key] += delta;
+  }
+}
+
+template<typename T>
+std::vector<typename QuantileFilter<T>::Offset> QuantileFilter<T>::getChangedOffsets(const MatrixView<const bool>& structuringElement, int dx, int dy)
+{
+  // dx, dy > 0: offsets (relative to the moved window) which are inside the moved window, but not inside the previous one
+  // dx, dy < 0: offsets (relative to the previous window) which are not inside the moved window
+  std::vector<Offset> offsets;
+
+  for (int y = 0; y < static_cast<int>(structuringElement.getHeight()); y++)
+  {
+    for (int x = 0; x < static_cast<int>(structuringElement.getWidth()); x++)
+    {
+      if (isValueSet(structuringElement, x, y) && !isValueSet(structuringElement, x + dx, y + dy))
+      {
+        offsets.push_back(Offset(x, y));
+      }
+    }
+  }
+
+  return offsets;
+}
+
+template<typename T>
+bool QuantileFilter<T>::isValueSet(const MatrixView<const bool>& structuringElement, int x, int y)
+{
+  if (x < 0 || y < 0 || x >= static_cast<int>(structuringElement.getWidth()) || y >= static_cast<int>(structuringElement.getHeight()))
+  {
+    return false;
+  }
+
+  return structuringElement.getRow(y)[x];
+}
+
+template<typename T>
+bool QuantileFilter<T>::isRectangle(const MatrixView<const bool>& structuringElement)
+{
+  for (unsigned int y = 0; y < structuringElement.getHeight(); y++)
+  {
+    const bool* row = structuringElement.getRow(y);
+    if (std::find(row, row + structuringElement.getWidth(), false) != row + structuringElement.getWidth())
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+inline unsigned int QuantileFilter<T>::toKey(T value)
+{
+  return static_cast<unsigned int>(static_cast<long long>(value) - static_cast<long long>(std::numeric_limits<T>::min()));
+}
+
+template<typename T>
+inline T QuantileFilter<T>::fromKey(unsigned int key)
+{
+  return static_cast<T>(static_cast<long long>(key) + static_cast<long long>(std::numeric_limits<T>::min()));
+}
+
+template<typename T>
+inline T QuantileFilter<T>::combine(T lower, T upper, bool average)
+{
+  if (!average)
+  {
+    return upper;
+  }
+
+  return ((double) lower + upper) / 2 + 0.5; // TODO correct implemenation for negative values
+}
+
+#endif // QUANTILEFILTER_H
@@ -46,6 +46,7 @@ Rectangle::Rectangle(const Point &topLeft, const Point &bottomRight) :
 Points Rectangle::getEdgePoints() const
 {
   Points edgePoints;
+  edgePoints.reserve(4);
 
   edgePoints.push_back(m_origin);
   edgePoints.push_back(bottomLeft());
@@ -58,6 +59,7 @@ Points Rectangle::getEdgePoints() const
 PolyLine Rectangle::toPolyLine() const
 {
   PolyLine polyLine;
+  polyLine.reserve(5);
 
   polyLine.push_back(m_origin);
   polyLine.push_back(bottomLeft());
@@ -1,8 +1,6 @@
 #ifndef RECTANGLE_H
 #define RECTANGLE_H
 
-#include <list>
-
 #include "Point.h"
 #include "PolyLine.h"
 
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+#include "Region.h"
+
+namespace
+{
+  bool isBefore(const Region::Span& lhs, const Region::Span& rhs)
+  {
+    return lhs.m_y < rhs.m_y || (lhs.m_y == rhs.m_y && lhs.m_x < rhs.m_x);
+  }
+}
+
+Region::Region() :
+  m_left(0),
+  m_top(0),
+  m_right(0),
+  m_bottom(0),
+  m_isRectangle(false)
+{
+}
+
+Region::Region(const Rectangle& rectangle) :
+  m_left(0),
+  m_top(0),
+  m_right(0),
+  m_bottom(0),
+  m_isRectangle(false)
+{
+  if (rectangle.m_angle == 0)
+  {
+    long long x = static_cast<long long>(floor(rectangle.m_origin.m_x + 0.5));
+    long long y = static_cast<long long>(floor(rectangle.m_origin.m_y + 0.5));
+    long long width = static_cast<long long>(floor(rectangle.m_width + 0.5));
+    long long height = static_cast<long long>(floor(rectangle.m_height + 0.5));
+
+    m_spans.reserve(height > 0 ? static_cast<size_t>(height) : 0);
+
+    for (long long i = 0; i < height; i++)
+    {
+      addSpan(x, y + i, width);
+    }
+
+    normalize();
+    return;
+  }
+
+  // scanline conversion of the convex polygon: pixel (x, y) covers [x, x + 1) x [y, y + 1)
+  // and is inside, if its center is inside
+  Points corners = rectangle.getEdgePoints();
+
+  float yMin = corners[0].m_y;
+  float yMax = corners[0].m_y;
+  for (size_t i = 1; i < corners.size(); i++)
+  {
+    yMin = std::min(yMin, corners[i].m_y);
+    yMax = std::max(yMax, corners[i].m_y);
+  }
+
+  long long firstRow = static_cast<long long>(floor(yMin));
+  long long lastRow = static_cast<long long>(ceil(yMax));
+
+  for (long long y = firstRow; y <= lastRow; y++)
+  {
+    double centerY = y + 0.5;
+    double xMin = std::numeric_limits<double>::max();
+    double xMax = -std::numeric_limits<double>::max();
+
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+      const Point& p = corners[i];
+      const Point& q = corners[(i + 1) % corners.size()];
+
+      if ((p.m_y <= centerY && centerY < q.m_y) || (q.m_y <= centerY && centerY < p.m_y))
+      {
+        double x = p.m_x + (centerY - p.m_y) * (q.m_x - p.m_x) / (q.m_y - p.m_y);
+        xMin = std::min(xMin, x);
+        xMax = std::max(xMax, x);
+      }
+    }
+
+    if (xMin > xMax)
+    {
+      continue;
+    }
+
+    long long first = static_cast<long long>(ceil(xMin - 0.5));
+    long long end = static_cast<long long>(ceil(xMax - 0.5));
+    addSpan(first, y, end - first);
+  }
+
+  normalize();
+}
+
+Region::Region(const RunLengthCode& runLengthCode) :
+  m_left(0),
+  m_top(0),
+  m_right(0),
+  m_bottom(0),
+  m_isRectangle(false)
+{
+  m_spans.reserve(runLengthCode.size());
+
+  for (auto it = runLengthCode.begin(); it != runLengthCode.end(); it++)
+  {
+    addSpan(it->m_x, it->m_y, it->m_length);
+  }
+
+  normalize();
+}
+
+void Region::addSpan(long long x, long long y, long long length)
+{
+  // the parts left of and above the origin are never inside an image
+  if (y < 0 || y > std::numeric_limits<unsigned int>::max() || length <= 0)
+  {
+    return;
+  }
+
+  if (x < 0)
+  {
+    length += x;
+    x = 0;
+  }
+
+  if (length <= 0 || x > std::numeric_limits<unsigned int>::max())
+  {
+    return;
+  }
+
+  length = std::min(length, static_cast<long long>(std::numeric_limits<unsigned int>::max()) - x);
+
+  Span span;
+  span.m_x = static_cast<unsigned int>(x);
+  span.m_y = static_cast<unsigned int>(y);
+  span.m_length = static_cast<unsigned int>(length);
+  m_spans.push_back(span);
+}
+
+void Region::normalize()
+{
+  if (!std::is_sorted(m_spans.begin(), m_spans.end(), isBefore))
+  {
+    std::sort(m_spans.begin(), m_spans.end(), isBefore);
+  }
+
+  // merge overlapping and touching spans, so every pixel is processed once
+  size_t qtyMerged = 0;
+  for (size_t i = 0; i < m_spans.size(); i++)
+  {
+    const Span& span = m_spans[i];
+
+    if (qtyMerged > 0)
+    {
+      Span& last = m_spans[qtyMerged - 1];
+      if (last.m_y == span.m_y && span.m_x <= last.m_x + last.m_length)
+      {
+        last.m_length = std::max(last.m_x + last.m_length, span.m_x + span.m_length) - last.m_x;
+        continue;
+      }
+    }
+
+    m_spans[qtyMerged++] = span;
+  }
+
+  m_spans.resize(qtyMerged);
+
+  m_left = 0;
+  m_top = 0;
+  m_right = 0;
+  m_bottom = 0;
+  m_isRectangle = false;
+
+  if (m_spans.empty())
+  {
+    return;
+  }
+
+  m_left = std::numeric_limits<unsigned int>::max();
+  m_top = m_spans.front().m_y;
+  m_bottom = m_spans.back().m_y + 1;
+
+  for (size_t i = 0; i < m_spans.size(); i++)
+  {
+    m_left = std::min(m_left, m_spans[i].m_x);
+    m_right = std::max(m_right, m_spans[i].m_x + m_spans[i].m_length);
+  }
+
+  // one span per row, all with the same start and end
+  m_isRectangle = m_spans.size() == m_bottom - m_top;
+  for (size_t i = 0; i < m_spans.size() && m_isRectangle; i++)
+  {
+    m_isRectangle = m_spans[i].m_x == m_left && m_spans[i].m_length == m_right - m_left;
+  }
+}
+
+Region Region::clip(unsigned int width, unsigned int height) const
+{
+  if (m_right <= width && m_bottom <= height)
+  {
+    return *this;
+  }
+
+  Region clipped;
+  clipped.m_spans.reserve(m_spans.size());
+
+  for (size_t i = 0; i < m_spans.size(); i++)
+  {
+    const Span& span = m_spans[i];
+
+    if (span.m_y < height && span.m_x < width)
+    {
+      clipped.addSpan(span.m_x, span.m_y, std::min(span.m_length, width - span.m_x));
+    }
+  }
+
+  clipped.normalize();
+  return clipped;
+}
+
+bool Region::isEmpty() const
+{
+  return m_spans.empty();
+}
+
+bool Region::isRectangle() const
+{
+  return m_isRectangle;
+}
+
+size_t Region::getQtyPixels() const
+{
+  size_t qtyPixels = 0;
+  for (size_t i = 0; i < m_spans.size(); i++)
+  {
+    qtyPixels += m_spans[i].m_length;
+  }
+
+  return qtyPixels;
+}
+
+unsigned int Region::getLeft() const
+{
+  return m_left;
+}
+
+unsigned int Region::getTop() const
+{
+  return m_top;
+}
+
+unsigned int Region::getRight() const
+{
+  return m_right;
+}
+
+unsigned int Region::getBottom() const
+{
+  return m_bottom;
+}
+
+const std::vector<Region::Span>& Region::getSpans() const
+{
+  return m_spans;
+}
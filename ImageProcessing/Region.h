@@ -0,0 +1,55 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Rectangle.h"
+#include "RunLengthCode.h"
+
+// set of pixels an operation is restricted to, stored as horizontal spans sorted by y and x
+// every pixel is contained only once
+// a Rectangle or a RunLengthCode converts implicitly, so they can be passed wherever a Region is expected
+class Region
+{
+public:
+  class Span
+  {
+  public:
+    unsigned int m_x;
+    unsigned int m_y;
+    unsigned int m_length;
+  };
+
+  Region();
+  Region(const Rectangle& rectangle); // rotated rectangles contain all pixels whose center is inside
+  Region(const RunLengthCode& runLengthCode);
+
+  // the part of the region inside an image of the given size
+  Region clip(unsigned int width, unsigned int height) const;
+
+  bool isEmpty() const;
+  bool isRectangle() const; // the region is its bounding rectangle, so it can be processed as a view
+  size_t getQtyPixels() const;
+
+  // bounding rectangle, right and bottom are exclusive
+  unsigned int getLeft() const;
+  unsigned int getTop() const;
+  unsigned int getRight() const;
+  unsigned int getBottom() const;
+
+  const std::vector<Span>& getSpans() const;
+
+private:
+  void addSpan(long long x, long long y, long long length);
+  void normalize();
+
+  std::vector<Span> m_spans;
+  unsigned int m_left;
+  unsigned int m_top;
+  unsigned int m_right;
+  unsigned int m_bottom;
+  bool m_isRectangle;
+};
+
+#endif // REGION_H
@@ -0,0 +1,259 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#include "Rotation.h"
+
+const unsigned int Rotation::TileSize;
+const unsigned int Rotation::MinimumQtyRowsPerTask;
+
+namespace
+{
+  // square tiles with rows of 64 or 128 bytes
+  unsigned int getTileSize(size_t elementSize)
+  {
+    return static_cast<unsigned int>(std::min<size_t>(64, std::max<size_t>(128 / elementSize, 1)));
+  }
+
+  void copyRows(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride, size_t rowSize, unsigned int qtyRows)
+  {
+    for (unsigned int y = 0; y < qtyRows; y++)
+    {
+      memcpy(destination + static_cast<ptrdiff_t>(y) * destinationStride, source + static_cast<ptrdiff_t>(y) * sourceStride, rowSize);
+    }
+  }
+
+  // destination(x, y) = source(y, x), the pixels are copied with memcpy, so there is no aliasing between T and Element
+  template<typename Element>
+  void transposeScalar(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                       unsigned int width, unsigned int height)
+  {
+    for (unsigned int y = 0; y < height; y++)
+    {
+      const unsigned char* column = source + static_cast<ptrdiff_t>(y) * static_cast<ptrdiff_t>(sizeof(Element));
+      unsigned char* row = destination + static_cast<ptrdiff_t>(y) * destinationStride;
+
+      for (unsigned int x = 0; x < width; x++)
+      {
+        Element value;
+        memcpy(&value, column + static_cast<ptrdiff_t>(x) * sourceStride, sizeof(Element));
+        memcpy(row + x * sizeof(Element), &value, sizeof(Element));
+      }
+    }
+  }
+
+  void transposeScalar(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                       unsigned int width, unsigned int height, size_t elementSize)
+  {
+    switch (elementSize)
+    {
+    case 1:
+      transposeScalar<uint8_t>(source, sourceStride, destination, destinationStride, width, height);
+      break;
+    case 2:
+      transposeScalar<uint16_t>(source, sourceStride, destination, destinationStride, width, height);
+      break;
+    case 4:
+      transposeScalar<uint32_t>(source, sourceStride, destination, destinationStride, width, height);
+      break;
+    case 8:
+      transposeScalar<uint64_t>(source, sourceStride, destination, destinationStride, width, height);
+      break;
+    default:
+      for (unsigned int y = 0; y < height; y++)
+      {
+        for (unsigned int x = 0; x < width; x++)
+        {
+          memcpy(destination + static_cast<ptrdiff_t>(y) * destinationStride + x * elementSize,
+                 source + static_cast<ptrdiff_t>(x) * sourceStride + y * elementSize, elementSize);
+        }
+      }
+    }
+  }
+
+#if defined(__SSE2__) || defined(_M_X64)
+  template<size_t ElementSize>
+  __m128i unpackLow(__m128i a, __m128i b);
+  template<size_t ElementSize>
+  __m128i unpackHigh(__m128i a, __m128i b);
+
+  template<> inline __m128i unpackLow<1>(__m128i a, __m128i b) {return _mm_unpacklo_epi8(a, b);}
+  template<> inline __m128i unpackLow<2>(__m128i a, __m128i b) {return _mm_unpacklo_epi16(a, b);}
+  template<> inline __m128i unpackLow<4>(__m128i a, __m128i b) {return _mm_unpacklo_epi32(a, b);}
+  template<> inline __m128i unpackLow<8>(__m128i a, __m128i b) {return _mm_unpacklo_epi64(a, b);}
+  template<> inline __m128i unpackHigh<1>(__m128i a, __m128i b) {return _mm_unpackhi_epi8(a, b);}
+  template<> inline __m128i unpackHigh<2>(__m128i a, __m128i b) {return _mm_unpackhi_epi16(a, b);}
+  template<> inline __m128i unpackHigh<4>(__m128i a, __m128i b) {return _mm_unpackhi_epi32(a, b);}
+  template<> inline __m128i unpackHigh<8>(__m128i a, __m128i b) {return _mm_unpackhi_epi64(a, b);}
+
+  // transposes a block of 16 bytes x 16 / ElementSize rows in registers
+  // every stage interleaves row i with row i + size / 2, after log2(size) stages the rows are the columns
+  template<size_t ElementSize>
+  void transposeBlock(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride)
+  {
+    const unsigned int Size = 16 / ElementSize;
+    const unsigned int Half = Size / 2;
+
+    __m128i rows[Size];
+    __m128i interleaved[Size];
+
+    for (unsigned int i = 0; i < Size; i++)
+    {
+      rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + static_cast<ptrdiff_t>(i) * sourceStride));
+    }
+
+    for (unsigned int stage = 1; stage < Size; stage *= 2)
+    {
+      for (unsigned int i = 0; i < Half; i++)
+      {
+        interleaved[2 * i] = unpackLow<ElementSize>(rows[i], rows[i + Half]);
+        interleaved[2 * i + 1] = unpackHigh<ElementSize>(rows[i], rows[i + Half]);
+      }
+
+      for (unsigned int i = 0; i < Size; i++)
+      {
+        rows[i] = interleaved[i];
+      }
+    }
+
+    for (unsigned int i = 0; i < Size; i++)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + static_cast<ptrdiff_t>(i) * destinationStride), rows[i]);
+    }
+  }
+
+  template<size_t ElementSize>
+  unsigned int transposeBlocks(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                               unsigned int width, unsigned int height)
+  {
+    const unsigned int Size = 16 / ElementSize;
+
+    unsigned int blockedWidth = width - width % Size;
+    unsigned int blockedHeight = height - height % Size;
+
+    for (unsigned int y = 0; y < blockedHeight; y += Size)
+    {
+      for (unsigned int x = 0; x < blockedWidth; x += Size)
+      {
+        transposeBlock<ElementSize>(source + static_cast<ptrdiff_t>(x) * sourceStride + y * ElementSize, sourceStride,
+                                    destination + static_cast<ptrdiff_t>(y) * destinationStride + x * ElementSize, destinationStride);
+      }
+    }
+
+    return Size;
+  }
+#endif
+}
+
+void Rotation::transpose(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                         unsigned int width, unsigned int height, size_t elementSize, unsigned int qtyThreads)
+{
+  unsigned int tileSize = getTileSize(elementSize);
+  unsigned int qtyTileRows = (height + tileSize - 1) / tileSize;
+
+  runBands(qtyTileRows, 1, qtyThreads, [&](unsigned int firstTileRow, unsigned int lastTileRow)
+  {
+    ptrdiff_t bufferStride = static_cast<ptrdiff_t>(tileSize * elementSize);
+    std::vector<unsigned char> input(tileSize * bufferStride);
+    std::vector<unsigned char> output(tileSize * bufferStride);
+
+    for (unsigned int tileRow = firstTileRow; tileRow < lastTileRow; tileRow++)
+    {
+      unsigned int y = tileRow * tileSize;
+      unsigned int tileHeight = std::min(tileSize, height - y);
+
+      for (unsigned int x = 0; x < width; x += tileSize)
+      {
+        unsigned int tileWidth = std::min(tileSize, width - x);
+
+        // the tile is copied through the buffers, so every row of the source and of the destination is touched once per tile
+        // -> strides which are a multiple of 4 kB do not evict the rows of the tile from the cache
+        copyRows(source + static_cast<ptrdiff_t>(x) * sourceStride + y * elementSize, sourceStride, &input[0], bufferStride, tileHeight * elementSize, tileWidth);
+        transposeTile(&input[0], bufferStride, &output[0], bufferStride, tileWidth, tileHeight, elementSize);
+        copyRows(&output[0], bufferStride, destination + static_cast<ptrdiff_t>(y) * destinationStride + x * elementSize, destinationStride, tileWidth * elementSize, tileHeight);
+      }
+    }
+  });
+}
+
+void Rotation::transposeInPlace(unsigned char* data, ptrdiff_t stride, unsigned int size, size_t elementSize, unsigned int qtyThreads)
+{
+  unsigned int tileSize = getTileSize(elementSize);
+  unsigned int qtyTiles = (size + tileSize - 1) / tileSize;
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  // task i swaps the tiles (i, j) and (j, i) for j >= i -> the tasks have different sizes, one task per tile row balances them
+  threadPool.run(qtyTiles, [&](unsigned int tileRow)
+  {
+    ptrdiff_t bufferStride = static_cast<ptrdiff_t>(tileSize * elementSize);
+    std::vector<unsigned char> upperBuffer(tileSize * bufferStride);
+    std::vector<unsigned char> lowerBuffer(tileSize * bufferStride);
+    std::vector<unsigned char> output(tileSize * bufferStride);
+
+    unsigned int y = tileRow * tileSize;
+    unsigned int tileHeight = std::min(tileSize, size - y);
+
+    for (unsigned int tileColumn = tileRow; tileColumn < qtyTiles; tileColumn++)
+    {
+      unsigned int x = tileColumn * tileSize;
+      unsigned int tileWidth = std::min(tileSize, size - x);
+
+      unsigned char* upper = data + static_cast<ptrdiff_t>(y) * stride + x * elementSize; // tileWidth x tileHeight pixels
+      unsigned char* lower = data + static_cast<ptrdiff_t>(x) * stride + y * elementSize; // tileHeight x tileWidth pixels
+
+      copyRows(upper, stride, &upperBuffer[0], bufferStride, tileWidth * elementSize, tileHeight);
+      copyRows(lower, stride, &lowerBuffer[0], bufferStride, tileHeight * elementSize, tileWidth);
+
+      transposeTile(&upperBuffer[0], bufferStride, &output[0], bufferStride, tileHeight, tileWidth, elementSize);
+      copyRows(&output[0], bufferStride, lower, stride, tileHeight * elementSize, tileWidth);
+
+      if (upper != lower)
+      {
+        transposeTile(&lowerBuffer[0], bufferStride, &output[0], bufferStride, tileWidth, tileHeight, elementSize);
+        copyRows(&output[0], bufferStride, upper, stride, tileWidth * elementSize, tileHeight);
+      }
+    }
+  }, qtyThreads);
+}
+
+void Rotation::transposeTile(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                             unsigned int width, unsigned int height, size_t elementSize)
+{
+  unsigned int blockSize = 1;
+
+#if defined(__SSE2__) || defined(_M_X64)
+  switch (elementSize)
+  {
+  case 1:
+    blockSize = transposeBlocks<1>(source, sourceStride, destination, destinationStride, width, height);
+    break;
+  case 2:
+    blockSize = transposeBlocks<2>(source, sourceStride, destination, destinationStride, width, height);
+    break;
+  case 4:
+    blockSize = transposeBlocks<4>(source, sourceStride, destination, destinationStride, width, height);
+    break;
+  case 8:
+    blockSize = transposeBlocks<8>(source, sourceStride, destination, destinationStride, width, height);
+    break;
+  }
+#endif
+
+  // the pixels right of and below the blocks
+  unsigned int blockedWidth = width - width % blockSize;
+  unsigned int blockedHeight = height - height % blockSize;
+
+  transposeScalar(source + blockedWidth * sourceStride, sourceStride, destination + blockedWidth * elementSize, destinationStride,
+                  width - blockedWidth, blockedHeight, elementSize);
+  transposeScalar(source + blockedHeight * elementSize, sourceStride, destination + static_cast<ptrdiff_t>(blockedHeight) * destinationStride,
+                  destinationStride, width, height - blockedHeight, elementSize);
+}
@@ -0,0 +1,366 @@
+#ifndef ROTATION_H
+#define ROTATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "BufferPool.h"
+#include "MathHelper.h"
+#include "MatrixView.h"
+#include "PolarTransformation.h"
+#include "ThreadPool.h"
+
+// rotations, flips and transpositions of views
+// a rotation by 90 degree is a transposition which reads the rows of the source (clockwise) or writes the rows of the destination (counter clockwise)
+// in reverse order -> the transposition is done in tiles of 64 x 64 pixels (16 x 16 for 64 bit), every tile is copied into a small buffer,
+// transposed there in blocks of 16 x 16 (8 bit) ... 2 x 2 (64 bit) pixels in SSE2 registers and copied out row by row,
+// so every cache line of the source and of the destination is loaded only once, even if the stride is a multiple of 4 kB
+// the pixels are moved as raw bytes, so the kernels only depend on sizeof(T)
+// flips and rotations by 180 degree are done in place by reversing and swapping rows
+// rotate() samples the source for every tile of the destination, so the source rows needed by a tile stay in the cache for any angle
+// all operations are split over the ThreadPool
+class Rotation
+{
+public:
+  // the destination has the height of the source as width and vice versa, source and destination must not overlap
+  template<typename T>
+  static void transpose(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int qtyThreads = 0);
+  template<typename T>
+  static void rotateBy90Degree(const MatrixView<const T>& source, const MatrixView<T>& destination, bool clockwise, unsigned int qtyThreads = 0);
+
+  // in place, square views only
+  template<typename T>
+  static void transpose(const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  template<typename T>
+  static void rotateBy90Degree(const MatrixView<T>& view, bool clockwise, unsigned int qtyThreads = 0);
+
+  // in place
+  template<typename T>
+  static void mirrorOnHorizontalAxis(const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  template<typename T>
+  static void mirrorOnVerticalAxis(const MatrixView<T>& view, unsigned int qtyThreads = 0);
+  template<typename T>
+  static void rotateBy180Degree(const MatrixView<T>& view, unsigned int qtyThreads = 0);
+
+  // rotates the source by angle (deg, clockwise because y points down) around its center, the center of the source is mapped to the center
+  // of the destination, destination pixels outside of the source get backgroundValue
+  template<typename T>
+  static void rotate(const MatrixView<const T>& source, const MatrixView<T>& destination, float angle,
+                     PolarTransformation::Interpolation interpolation = PolarTransformation::Bilinear, T backgroundValue = 0, unsigned int qtyThreads = 0);
+
+private:
+  // destination(x, y) = source(y, x), width and height of the destination, strides in bytes (negative strides reverse the rows)
+  static void transpose(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                        unsigned int width, unsigned int height, size_t elementSize, unsigned int qtyThreads);
+  static void transposeInPlace(unsigned char* data, ptrdiff_t stride, unsigned int size, size_t elementSize, unsigned int qtyThreads);
+  // a tile of at most 64 x 64 pixels in registers, the strides should not be a multiple of 4 kB
+  static void transposeTile(const unsigned char* source, ptrdiff_t sourceStride, unsigned char* destination, ptrdiff_t destinationStride,
+                            unsigned int width, unsigned int height, size_t elementSize);
+
+  // calls task(firstItem, lastItem) for bands of the items 0 ... qtyItems - 1 on the ThreadPool
+  template<typename Task>
+  static void runBands(unsigned int qtyItems, unsigned int minimumQtyItemsPerTask, unsigned int qtyThreads, const Task& task);
+
+  // pixels at the border of the source, which may be outside of it
+  template<typename T>
+  static T sample(const MatrixView<const T>& source, double x, double y, PolarTransformation::Interpolation interpolation, T backgroundValue);
+  template<typename T>
+  static T interpolate(const T* topLeft, ptrdiff_t stepX, ptrdiff_t stepY, double weightX, double weightY);
+
+  static const unsigned int TileSize = 64; // rotate()
+  static const unsigned int MinimumQtyRowsPerTask = 16;
+};
+
+template<typename T>
+void Rotation::transpose(const MatrixView<const T>& source, const MatrixView<T>& destination, unsigned int qtyThreads)
+{
+  if (source.getWidth() != destination.getHeight() || source.getHeight() != destination.getWidth())
+  {
+    return;
+  }
+
+  transpose(reinterpret_cast<const unsigned char*>(source.getData()), static_cast<ptrdiff_t>(source.getStride() * sizeof(T)),
+            reinterpret_cast<unsigned char*>(destination.getData()), static_cast<ptrdiff_t>(destination.getStride() * sizeof(T)),
+            destination.getWidth(), destination.getHeight(), sizeof(T), qtyThreads);
+}
+
+template<typename T>
+void Rotation::rotateBy90Degree(const MatrixView<const T>& source, const MatrixView<T>& destination, bool clockwise, unsigned int qtyThreads)
+{
+  if (source.getWidth() != destination.getHeight() || source.getHeight() != destination.getWidth() || source.isEmpty())
+  {
+    return;
+  }
+
+  ptrdiff_t sourceStride = static_cast<ptrdiff_t>(source.getStride() * sizeof(T));
+  ptrdiff_t destinationStride = static_cast<ptrdiff_t>(destination.getStride() * sizeof(T));
+  const unsigned char* sourceData = reinterpret_cast<const unsigned char*>(source.getData());
+  unsigned char* destinationData = reinterpret_cast<unsigned char*>(destination.getData());
+
+  // clockwise: destination(x, y) = source(y, height - 1 - x) -> transposition of the source rows from bottom to top
+  // counter clockwise: destination(x, y) = source(width - 1 - y, x) -> transposition into the destination rows from bottom to top
+  if (clockwise)
+  {
+    sourceData = reinterpret_cast<const unsigned char*>(source.getRow(source.getHeight() - 1));
+    sourceStride = -sourceStride;
+  }
+  else
+  {
+    destinationData = reinterpret_cast<unsigned char*>(destination.getRow(destination.getHeight() - 1));
+    destinationStride = -destinationStride;
+  }
+
+  transpose(sourceData, sourceStride, destinationData, destinationStride, destination.getWidth(), destination.getHeight(), sizeof(T), qtyThreads);
+}
+
+template<typename T>
+void Rotation::transpose(const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  if (view.getWidth() != view.getHeight())
+  {
+    return;
+  }
+
+  transposeInPlace(reinterpret_cast<unsigned char*>(view.getData()), static_cast<ptrdiff_t>(view.getStride() * sizeof(T)), view.getWidth(), sizeof(T), qtyThreads);
+}
+
+template<typename T>
+void Rotation::rotateBy90Degree(const MatrixView<T>& view, bool clockwise, unsigned int qtyThreads)
+{
+  if (view.getWidth() != view.getHeight())
+  {
+    return;
+  }
+
+  transpose(view, qtyThreads);
+
+  if (clockwise)
+  {
+    mirrorOnVerticalAxis(view, qtyThreads);
+  }
+  else
+  {
+    mirrorOnHorizontalAxis(view, qtyThreads);
+  }
+}
+
+template<typename T>
+void Rotation::mirrorOnHorizontalAxis(const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  unsigned int width = view.getWidth();
+  unsigned int height = view.getHeight();
+
+  runBands(height / 2, MinimumQtyRowsPerTask, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow)
+  {
+    std::unique_ptr<T[], void(*)(void*)> buffer(static_cast<T*>(BufferPool::allocate(width * sizeof(T))), BufferPool::release);
+
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      T* top = view.getRow(y);
+      T* bottom = view.getRow(height - 1 - y);
+      memcpy(buffer.get(), top, width * sizeof(T));
+      memcpy(top, bottom, width * sizeof(T));
+      memcpy(bottom, buffer.get(), width * sizeof(T));
+    }
+  });
+}
+
+template<typename T>
+void Rotation::mirrorOnVerticalAxis(const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  unsigned int width = view.getWidth();
+
+  runBands(view.getHeight(), MinimumQtyRowsPerTask, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow)
+  {
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      T* row = view.getRow(y);
+      std::reverse(row, row + width);
+    }
+  });
+}
+
+template<typename T>
+void Rotation::rotateBy180Degree(const MatrixView<T>& view, unsigned int qtyThreads)
+{
+  unsigned int width = view.getWidth();
+  unsigned int height = view.getHeight();
+
+  // the rows y and height - 1 - y are swapped and reversed together, the middle row of an odd height is only reversed
+  runBands((height + 1) / 2, MinimumQtyRowsPerTask, qtyThreads, [&](unsigned int firstRow, unsigned int lastRow)
+  {
+    for (unsigned int y = firstRow; y < lastRow; y++)
+    {
+      T* top = view.getRow(y);
+      T* bottom = view.getRow(height - 1 - y);
+
+      if (top == bottom)
+      {
+        std::reverse(top, top + width);
+        continue;
+      }
+
+      for (unsigned int x = 0; x < width; x++)
+      {
+        std::swap(top[x], bottom[width - 1 - x]);
+      }
+    }
+  });
+}
+
+template<typename T>
+void Rotation::rotate(const MatrixView<const T>& source, const MatrixView<T>& destination, float angle, PolarTransformation::Interpolation interpolation,
+                      T backgroundValue, unsigned int qtyThreads)
+{
+  if (source.isEmpty() || destination.isEmpty())
+  {
+    return;
+  }
+
+  double cosine = cos(MathHelper::rad(angle));
+  double sine = sin(MathHelper::rad(angle));
+
+  // multiples of 90 degree hit the pixels exactly, so they give the same result as rotateBy90Degree / rotateBy180Degree
+  const double Epsilon = 1e-12;
+  cosine = fabs(cosine) < Epsilon ? 0.0 : cosine;
+  sine = fabs(sine) < Epsilon ? 0.0 : sine;
+
+  double sourceCenterX = (source.getWidth() - 1) / 2.0;
+  double sourceCenterY = (source.getHeight() - 1) / 2.0;
+  double destinationCenterX = (destination.getWidth() - 1) / 2.0;
+  double destinationCenterY = (destination.getHeight() - 1) / 2.0;
+
+  unsigned int width = destination.getWidth();
+  unsigned int height = destination.getHeight();
+  unsigned int qtyTileRows = (height + TileSize - 1) / TileSize;
+
+  double maxX = source.getWidth() - 1;
+  double maxY = source.getHeight() - 1;
+  ptrdiff_t stride = static_cast<ptrdiff_t>(source.getStride());
+
+  // the destination pixel p is the source pixel sourceCenter + rotation(-angle) * (p - destinationCenter)
+  runBands(qtyTileRows, 1, qtyThreads, [&](unsigned int firstTileRow, unsigned int lastTileRow)
+  {
+    for (unsigned int tileY = firstTileRow * TileSize; tileY < std::min(lastTileRow * TileSize, height); tileY += TileSize)
+    {
+      unsigned int tileBottom = std::min(tileY + TileSize, height);
+
+      for (unsigned int tileX = 0; tileX < width; tileX += TileSize)
+      {
+        unsigned int tileRight = std::min(tileX + TileSize, width);
+
+        for (unsigned int y = tileY; y < tileBottom; y++)
+        {
+          T* row = destination.getRow(y);
+          double dy = y - destinationCenterY;
+
+          for (unsigned int x = tileX; x < tileRight; x++)
+          {
+            double dx = x - destinationCenterX;
+            double sourceX = sourceCenterX + cosine * dx + sine * dy;
+            double sourceY = sourceCenterY - sine * dx + cosine * dy;
+
+            // all neighbours are inside of the source -> no clipping needed
+            if (sourceX >= 0.0 && sourceY >= 0.0 && sourceX < maxX && sourceY < maxY)
+            {
+              if (interpolation == PolarTransformation::NearestNeighbour)
+              {
+                row[x] = source.getRow(static_cast<unsigned int>(sourceY + 0.5))[static_cast<unsigned int>(sourceX + 0.5)];
+              }
+              else
+              {
+                unsigned int x0 = static_cast<unsigned int>(sourceX);
+                unsigned int y0 = static_cast<unsigned int>(sourceY);
+                row[x] = interpolate(source.getRow(y0) + x0, 1, stride, sourceX - x0, sourceY - y0);
+              }
+            }
+            else
+            {
+              row[x] = sample(source, sourceX, sourceY, interpolation, backgroundValue);
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+template<typename T>
+T Rotation::sample(const MatrixView<const T>& source, double x, double y, PolarTransformation::Interpolation interpolation, T backgroundValue)
+{
+  // tolerance for the rounding errors of sine and cosine, e.g. at 90 degree the border pixels are exactly on the border
+  const double Tolerance = 1e-6;
+  double maxX = source.getWidth() - 1;
+  double maxY = source.getHeight() - 1;
+
+  if (x < -Tolerance || y < -Tolerance || x > maxX + Tolerance || y > maxY + Tolerance)
+  {
+    return backgroundValue;
+  }
+
+  x = std::min(std::max(x, 0.0), maxX);
+  y = std::min(std::max(y, 0.0), maxY);
+
+  if (interpolation == PolarTransformation::NearestNeighbour)
+  {
+    return source.getRow(static_cast<unsigned int>(y + 0.5))[static_cast<unsigned int>(x + 0.5)];
+  }
+
+  unsigned int x0 = static_cast<unsigned int>(x);
+  unsigned int y0 = static_cast<unsigned int>(y);
+
+  // on the last column / row the weight is 0, the neighbour behind it is replaced by the pixel itself
+  ptrdiff_t stepX = x0 + 1 < source.getWidth() ? 1 : 0;
+  ptrdiff_t stepY = y0 + 1 < source.getHeight() ? static_cast<ptrdiff_t>(source.getStride()) : 0;
+
+  return interpolate(source.getRow(y0) + x0, stepX, stepY, x - x0, y - y0);
+}
+
+template<typename T>
+T Rotation::interpolate(const T* topLeft, ptrdiff_t stepX, ptrdiff_t stepY, double weightX, double weightY)
+{
+  const T* bottomLeft = topLeft + stepY;
+
+  double top = topLeft[0] + weightX * (static_cast<double>(topLeft[stepX]) - topLeft[0]);
+  double bottom = bottomLeft[0] + weightX * (static_cast<double>(bottomLeft[stepX]) - bottomLeft[0]);
+  double value = top + weightY * (bottom - top);
+
+  // the same rounding as PolarTransformation, the value is between its neighbours, so it fits into T
+  if (std::numeric_limits<T>::is_integer)
+  {
+    value > 0 ? value += 0.5 : value -= 0.5;
+    return static_cast<T>(static_cast<long long>(value));
+  }
+
+  return static_cast<T>(value);
+}
+
+template<typename Task>
+void Rotation::runBands(unsigned int qtyItems, unsigned int minimumQtyItemsPerTask, unsigned int qtyThreads, const Task& task)
+{
+  if (qtyItems == 0)
+  {
+    return;
+  }
+
+  ThreadPool& threadPool = ThreadPool::getInstance();
+  if (qtyThreads == 0 || qtyThreads > threadPool.getQtyThreads())
+  {
+    qtyThreads = threadPool.getQtyThreads();
+  }
+
+  unsigned int qtyTasks = std::max(1u, std::min(qtyThreads, qtyItems / minimumQtyItemsPerTask));
+
+  threadPool.run(qtyTasks, [&](unsigned int index)
+  {
+    unsigned int first = static_cast<unsigned int>(static_cast<unsigned long long>(qtyItems) * index / qtyTasks);
+    unsigned int last = static_cast<unsigned int>(static_cast<unsigned long long>(qtyItems) * (index + 1) / qtyTasks);
+    task(first, last);
+  }, qtyThreads);
+}
+
+#endif // ROTATION_H
@@ -1,5 +1,406 @@
+#include <algorithm>
+
 #include "RunLengthCode.h"
+#include "Converter.h"
+#include "Matrix.h"
+#include "Rectangle.h"
+
+namespace
+{
+  long long getEnd(const RunLength& runLength)
+  {
+    return static_cast<long long>(runLength.m_x) + runLength.m_length;
+  }
+
+  // appends the run [x, end) of row y, the runs must be appended sorted by y and x
+  // a run which overlaps or touches the last run is merged into it
+  void append(std::vector<RunLength>& runs, long long x, int y, long long end)
+  {
+    if (end <= x)
+    {
+      return;
+    }
+
+    if (!runs.empty())
+    {
+      RunLength& last = runs.back();
+      if (last.m_y == y && x <= getEnd(last))
+      {
+        last.m_length = static_cast<unsigned int>(std::max(getEnd(last), end) - last.m_x);
+        return;
+      }
+    }
+
+    runs.push_back(RunLength(static_cast<int>(x), y, static_cast<unsigned int>(end - x)));
+  }
+
+  bool isBefore(const RunLength& lhs, const RunLength& rhs)
+  {
+    return lhs.m_y < rhs.m_y || (lhs.m_y == rhs.m_y && lhs.m_x < rhs.m_x);
+  }
+}
+
+Point RunLengthCode::Moments::getCenter() const
+{
+  if (m_m00 == 0.0)
+  {
+    return Point();
+  }
+
+  return Point(static_cast<float>(m_m10 / m_m00), static_cast<float>(m_m01 / m_m00));
+}
+
+double RunLengthCode::Moments::getMu20() const
+{
+  return m_m00 == 0.0 ? 0.0 : m_m20 - m_m10 * m_m10 / m_m00;
+}
+
+double RunLengthCode::Moments::getMu11() const
+{
+  return m_m00 == 0.0 ? 0.0 : m_m11 - m_m10 * m_m01 / m_m00;
+}
+
+double RunLengthCode::Moments::getMu02() const
+{
+  return m_m00 == 0.0 ? 0.0 : m_m02 - m_m01 * m_m01 / m_m00;
+}
+
+RunLengthCode::RunLengthCode()
+{
+}
+
+void RunLengthCode::add(const RunLength& runLength)
+{
+  if (runLength.m_length == 0)
+  {
+    return;
+  }
+
+  if (m_runs.empty() || isBefore(m_runs.back(), runLength))
+  {
+    append(m_runs, runLength.m_x, runLength.m_y, getEnd(runLength));
+    return;
+  }
+
+  std::vector<RunLength> single(1, runLength);
+  std::vector<RunLength> result;
+  unite(m_runs, single, result);
+  m_runs.swap(result);
+}
+
+void RunLengthCode::clear()
+{
+  m_runs.clear();
+}
+
+RunLengthCode::const_iterator RunLengthCode::begin() const
+{
+  return m_runs.begin();
+}
+
+RunLengthCode::const_iterator RunLengthCode::end() const
+{
+  return m_runs.end();
+}
+
+size_t RunLengthCode::size() const
+{
+  return m_runs.size();
+}
+
+bool RunLengthCode::empty() const
+{
+  return m_runs.empty();
+}
+
+const std::vector<RunLength>& RunLengthCode::getRuns() const
+{
+  return m_runs;
+}
+
+size_t RunLengthCode::getArea() const
+{
+  size_t area = 0;
+  for (size_t i = 0; i < m_runs.size(); i++)
+  {
+    area += m_runs[i].m_length;
+  }
+
+  return area;
+}
+
+Rectangle RunLengthCode::getBoundingRectangle() const
+{
+  if (m_runs.empty())
+  {
+    return Rectangle();
+  }
+
+  long long left = m_runs.front().m_x;
+  long long right = getEnd(m_runs.front());
+  for (size_t i = 1; i < m_runs.size(); i++)
+  {
+    left = std::min(left, static_cast<long long>(m_runs[i].m_x));
+    right = std::max(right, getEnd(m_runs[i]));
+  }
+
+  int top = m_runs.front().m_y;
+  int bottom = m_runs.back().m_y + 1;
+
+  return Rectangle(Point(static_cast<float>(left), static_cast<float>(top)), static_cast<float>(right - left), static_cast<float>(bottom - top));
+}
+
+RunLengthCode::Moments RunLengthCode::getMoments() const
+{
+  Moments moments;
+
+  // closed form sums over the pixels x0 ... x0 + n - 1 of a run
+  for (size_t i = 0; i < m_runs.size(); i++)
+  {
+    double n = m_runs[i].m_length;
+    double x0 = m_runs[i].m_x;
+    double y = m_runs[i].m_y;
+
+    double sumX = n * x0 + n * (n - 1.0) / 2.0;
+    double sumXX = n * x0 * x0 + x0 * n * (n - 1.0) + (n - 1.0) * n * (2.0 * n - 1.0) / 6.0;
+
+    moments.m_m00 += n;
+    moments.m_m10 += sumX;
+    moments.m_m01 += n * y;
+    moments.m_m20 += sumXX;
+    moments.m_m11 += y * sumX;
+    moments.m_m02 += n * y * y;
+  }
+
+  return moments;
+}
+
+void RunLengthCode::translate(int dx, int dy)
+{
+  for (size_t i = 0; i < m_runs.size(); i++)
+  {
+    m_runs[i].m_x += dx;
+    m_runs[i].m_y += dy;
+  }
+}
 
-/*RunLengthCode::RunLengthCode()
+void RunLengthCode::erode(const StructuringElement* structuringElement)
 {
-}*/
+  std::vector<RunLength> offsets = getOffsets(structuringElement);
+
+  if (offsets.empty())
+  {
+    return;
+  }
+
+  // out(p) = min in(p + o) -> a run of offsets [ox, ox + length) shrinks every run and moves it by -o
+  // the result is the intersection of the shrunk runs of all runs of offsets
+  std::vector<RunLength> result;
+  std::vector<RunLength> shifted;
+  std::vector<RunLength> intersection;
+
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    const RunLength& offset = offsets[i];
+
+    shifted.clear();
+    for (size_t j = 0; j < m_runs.size(); j++)
+    {
+      const RunLength& run = m_runs[j];
+      if (run.m_length >= offset.m_length)
+      {
+        long long x = static_cast<long long>(run.m_x) - offset.m_x;
+        append(shifted, x, run.m_y - offset.m_y, x + run.m_length - offset.m_length + 1);
+      }
+    }
+
+    if (i == 0)
+    {
+      result.swap(shifted);
+    }
+    else
+    {
+      intersection.clear();
+      intersect(result, shifted, intersection);
+      result.swap(intersection);
+    }
+  }
+
+  m_runs.swap(result);
+}
+
+void RunLengthCode::dilate(const StructuringElement* structuringElement)
+{
+  std::vector<RunLength> offsets = getOffsets(structuringElement);
+
+  // out(p) = max in(p + o) -> a run of offsets [ox, ox + length) grows every run and moves it by -o
+  // the result is the union of the grown runs of all runs of offsets
+  std::vector<RunLength> result;
+  std::vector<RunLength> shifted;
+  std::vector<RunLength> united;
+
+  for (size_t i = 0; i < offsets.size(); i++)
+  {
+    const RunLength& offset = offsets[i];
+
+    shifted.clear();
+    for (size_t j = 0; j < m_runs.size(); j++)
+    {
+      const RunLength& run = m_runs[j];
+      long long x = static_cast<long long>(run.m_x) - offset.m_x - offset.m_length + 1;
+      append(shifted, x, run.m_y - offset.m_y, x + run.m_length + offset.m_length - 1);
+    }
+
+    united.clear();
+    unite(result, shifted, united);
+    result.swap(united);
+  }
+
+  m_runs.swap(result);
+}
+
+void RunLengthCode::open(const StructuringElement* structuringElement)
+{
+  erode(structuringElement);
+  dilate(structuringElement);
+}
+
+void RunLengthCode::close(const StructuringElement* structuringElement)
+{
+  dilate(structuringElement);
+  erode(structuringElement);
+}
+
+void RunLengthCode::unite(const RunLengthCode& rhs)
+{
+  std::vector<RunLength> result;
+  unite(m_runs, rhs.m_runs, result);
+  m_runs.swap(result);
+}
+
+void RunLengthCode::intersect(const RunLengthCode& rhs)
+{
+  std::vector<RunLength> result;
+  intersect(m_runs, rhs.m_runs, result);
+  m_runs.swap(result);
+}
+
+void RunLengthCode::subtract(const RunLengthCode& rhs)
+{
+  std::vector<RunLength> result;
+  subtract(m_runs, rhs.m_runs, result);
+  m_runs.swap(result);
+}
+
+void RunLengthCode::complement(unsigned int width, unsigned int height)
+{
+  std::vector<RunLength> frame;
+  frame.reserve(height);
+  for (unsigned int y = 0; y < height; y++)
+  {
+    append(frame, 0, static_cast<int>(y), width);
+  }
+
+  std::vector<RunLength> result;
+  subtract(frame, m_runs, result);
+  m_runs.swap(result);
+}
+
+std::vector<RunLength> RunLengthCode::getOffsets(const StructuringElement* structuringElement)
+{
+  std::vector<RunLength> offsets;
+
+  int referenceX = static_cast<int>(Converter::toUInt(structuringElement->getReferencePoint().m_x));
+  int referenceY = static_cast<int>(Converter::toUInt(structuringElement->getReferencePoint().m_y));
+
+  for (unsigned int y = 0; y < structuringElement->getHeight(); y++)
+  {
+    const bool* row = structuringElement->getRow(y);
+    unsigned int x = 0;
+
+    while (x < structuringElement->getWidth())
+    {
+      if (!row[x])
+      {
+        x++;
+        continue;
+      }
+
+      unsigned int start = x;
+      while (x < structuringElement->getWidth() && row[x])
+      {
+        x++;
+      }
+
+      offsets.push_back(RunLength(static_cast<int>(start) - referenceX, static_cast<int>(y) - referenceY, x - start));
+    }
+  }
+
+  return offsets;
+}
+
+void RunLengthCode::unite(const std::vector<RunLength>& lhs, const std::vector<RunLength>& rhs, std::vector<RunLength>& result)
+{
+  result.reserve(lhs.size() + rhs.size());
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < lhs.size() || j < rhs.size())
+  {
+    const RunLength& run = (j == rhs.size() || (i < lhs.size() && isBefore(lhs[i], rhs[j]))) ? lhs[i++] : rhs[j++];
+    append(result, run.m_x, run.m_y, getEnd(run));
+  }
+}
+
+void RunLengthCode::intersect(const std::vector<RunLength>& lhs, const std::vector<RunLength>& rhs, std::vector<RunLength>& result)
+{
+  result.reserve(std::min(lhs.size(), rhs.size()));
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < lhs.size() && j < rhs.size())
+  {
+    const RunLength& left = lhs[i];
+    const RunLength& right = rhs[j];
+
+    if (left.m_y != right.m_y)
+    {
+      left.m_y < right.m_y ? i++ : j++;
+      continue;
+    }
+
+    long long start = std::max(left.m_x, right.m_x);
+    long long end = std::min(getEnd(left), getEnd(right));
+    append(result, start, left.m_y, end);
+
+    // the run which ends first cannot overlap any further run of the other side
+    getEnd(left) < getEnd(right) ? i++ : j++;
+  }
+}
+
+void RunLengthCode::subtract(const std::vector<RunLength>& lhs, const std::vector<RunLength>& rhs, std::vector<RunLength>& result)
+{
+  result.reserve(lhs.size());
+
+  size_t j = 0;
+  for (size_t i = 0; i < lhs.size(); i++)
+  {
+    const RunLength& run = lhs[i];
+    long long end = getEnd(run);
+
+    // skip the runs of rhs which end before this run, they end before all following runs too
+    while (j < rhs.size() && (rhs[j].m_y < run.m_y || (rhs[j].m_y == run.m_y && getEnd(rhs[j]) <= run.m_x)))
+    {
+      j++;
+    }
+
+    long long x = run.m_x;
+    for (size_t k = j; k < rhs.size() && rhs[k].m_y == run.m_y && rhs[k].m_x < end; k++)
+    {
+      append(result, x, run.m_y, rhs[k].m_x);
+      x = std::max(x, getEnd(rhs[k]));
+    }
+
+    append(result, x, run.m_y, end);
+  }
+}
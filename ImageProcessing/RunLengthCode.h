@@ -1,24 +1,90 @@
 #ifndef RUNLENGTHCODE_H
 #define RUNLENGTHCODE_H
 
-#include <list>
+#include <cstddef>
+#include <vector>
 
 #include "Point.h"
 
+class Rectangle;
+class StructuringElement;
+
 class RunLength
 {
 public:
-  RunLength(const Point& point, unsigned int length) : m_startPoint(point), m_length(length) {}
-  Point m_startPoint;
+  RunLength(int x, int y, unsigned int length) : m_x(x), m_y(y), m_length(length) {}
+  int m_x;
+  int m_y;
   unsigned int m_length;
 };
 
-typedef std::list<RunLength> RunLengthCode;
-
-/*class RunLengthCode
+// binary region stored as runs in one contiguous vector, sorted by y and x
+// the runs never overlap or touch, so every pixel is contained only once and the runs of a row are separated by background
+// all operations work on the runs, the region is never rasterised -> the costs depend on the number of runs, not on the size of the image
+class RunLengthCode
 {
 public:
+  typedef std::vector<RunLength>::const_iterator const_iterator;
+
+  // raw moments of the pixel coordinates, pixel (x, y) is the point (x, y)
+  class Moments
+  {
+  public:
+    Moments() : m_m00(0.0), m_m10(0.0), m_m01(0.0), m_m20(0.0), m_m11(0.0), m_m02(0.0) {}
+
+    Point getCenter() const;
+
+    // central moments of second order
+    double getMu20() const;
+    double getMu11() const;
+    double getMu02() const;
+
+    double m_m00;
+    double m_m10;
+    double m_m01;
+    double m_m20;
+    double m_m11;
+    double m_m02;
+  };
+
   RunLengthCode();
-};*/
+
+  // appending runs in sorted order costs O(1), other runs are merged into the code
+  void add(const RunLength& runLength);
+  void clear();
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  size_t size() const; // number of runs
+  bool empty() const;
+  const std::vector<RunLength>& getRuns() const;
+
+  size_t getArea() const; // number of pixels
+  Rectangle getBoundingRectangle() const;
+  Moments getMoments() const;
+
+  void translate(int dx, int dy);
+
+  // same definition as Matrix<bool>::erode / dilate, but pixels outside of the code are background everywhere, there is no image border
+  void erode(const StructuringElement* structuringElement);
+  void dilate(const StructuringElement* structuringElement);
+  void open(const StructuringElement* structuringElement);
+  void close(const StructuringElement* structuringElement);
+
+  void unite(const RunLengthCode& rhs);
+  void intersect(const RunLengthCode& rhs);
+  void subtract(const RunLengthCode& rhs);
+  void complement(unsigned int width, unsigned int height); // inside of the rectangle (0, 0, width, height)
+
+private:
+  // structuring element as runs of offsets relative to its reference point
+  static std::vector<RunLength> getOffsets(const StructuringElement* structuringElement);
+
+  static void unite(const std::vector<RunLength>& lhs, const std::vector<RunLength>& rhs, std::vector<RunLength>& result);
+  static void intersect(const std::vector<RunLength>& lhs, const std::vector<RunLength>& rhs, std::vector<RunLength>& result);
+  static void subtract(const std::vector<RunLength>& lhs, const std::vector<RunLength>& rhs, std::vector<RunLength>& result);
+
+  std::vector<RunLength> m_runs;
+};
 
 #endif // RUNLENGTHCODE_H
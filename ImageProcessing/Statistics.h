@@ -12,13 +12,15 @@ public:
   T minimum;
   T maximum;
   double meanValue;
+  double variance;
 };
 
 template<typename T>
 Statistics<T>::Statistics() :
   minimum(std::numeric_limits<T>::max()),
   maximum(std::numeric_limits<T>::min()),
-  meanValue(0.0)
+  meanValue(0.0),
+  variance(0.0)
 {
 
 }
@@ -1,4 +1,9 @@
+#include <cstdlib>
+#include <math.h>
+
 #include "StructuringElementGenerator.h"
+#include "Line.h"
+#include "MathHelper.h"
 #include "PolyLine.h"
 
 StructuringElementGenerator::StructuringElementGenerator()
@@ -33,6 +38,37 @@ StructuringElement StructuringElementGenerator::circle(unsigned int radius)
   return structuringElement;
 }
 
+StructuringElement StructuringElementGenerator::rectangle(unsigned int width, unsigned int height)
+{
+  if (height == 0)
+  {
+    height = width;
+  }
+
+  // erode and dilate need constant time per pixel for rectangles, independent of the size
+  StructuringElement structuringElement(width, height);
+  return structuringElement;
+}
+
+StructuringElement StructuringElementGenerator::line(unsigned int length, float angle)
+{
+  if (length == 0)
+  {
+    length = 1;
+  }
+
+  // end points relative to the center, horizontal, vertical and diagonal lines are processed in constant time per pixel by erode and dilate
+  int dx = floor(cos(MathHelper::rad(angle)) * (length - 1) / 2 + 0.5);
+  int dy = floor(sin(MathHelper::rad(angle)) * (length - 1) / 2 + 0.5);
+  unsigned int halfWidth = abs(dx);
+  unsigned int halfHeight = abs(dy);
+
+  StructuringElement structuringElement(halfWidth * 2 + 1, halfHeight * 2 + 1, false);
+  structuringElement.setLine(true, Line(Point(halfWidth - dx, halfHeight - dy), Point(halfWidth + dx, halfHeight + dy)));
+
+  return structuringElement;
+}
+
 StructuringElement StructuringElementGenerator::polyLineFillTest(unsigned int type, bool fill)
 {
   unsigned int width = 15;
@@ -138,9 +174,7 @@ StructuringElement StructuringElementGenerator::polyLineFillTest(unsigned int ty
 
   if (fill)
   {
-    structuringElement.fillBackground(false, true);
-    structuringElement.invert();
-    structuringElement.setPolyLine(true, polyLine);
+    structuringElement.fillHoles(false, true);
   }
 
   return structuringElement;
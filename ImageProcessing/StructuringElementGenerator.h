@@ -13,6 +13,8 @@ public:
   static StructuringElement neighborhood4();
   static StructuringElement neighborhood8();
   static StructuringElement circle(unsigned int radius = 2);
+  static StructuringElement rectangle(unsigned int width, unsigned int height = 0);
+  static StructuringElement line(unsigned int length, float angle);
   static StructuringElement polyLineFillTest(unsigned int type, bool fill);
 };
 
@@ -165,7 +165,7 @@ void TeachablePolyLine::positionChanged(QGraphicsEllipseItem *item, const QPoint
   }
   else if (item == m_prepend)
   {
-    polyLine.push_front(Converter::toPoint(position));
+    polyLine.insert(polyLine.begin(), Converter::toPoint(position));
     m_edgePoints.prepend(m_prepend);
     m_prepend = m_scene->addEllipse(QRectF(), *m_pen);
   }
@@ -0,0 +1,168 @@
+#include "ThreadPool.h"
+
+namespace
+{
+  // set for the worker threads and for a thread which is currently inside run()
+  thread_local bool insideThreadPool = false;
+}
+
+ThreadPool::ThreadPool(unsigned int qtyThreads) :
+  m_qtyThreads(1),
+  m_stop(false),
+  m_generation(0),
+  m_qtyActiveWorkers(0),
+  m_qtyBusyWorkers(0),
+  m_task(0),
+  m_qtyTasks(0),
+  m_nextTask(0)
+{
+  startWorkers(qtyThreads);
+}
+
+ThreadPool::~ThreadPool()
+{
+  stopWorkers();
+}
+
+ThreadPool& ThreadPool::getInstance()
+{
+  static ThreadPool threadPool;
+  return threadPool;
+}
+
+unsigned int ThreadPool::getQtyThreads() const
+{
+  return m_qtyThreads;
+}
+
+void ThreadPool::setQtyThreads(unsigned int qtyThreads)
+{
+  std::lock_guard<std::mutex> runLock(m_runMutex);
+
+  stopWorkers();
+  startWorkers(qtyThreads);
+}
+
+void ThreadPool::run(unsigned int qtyTasks, const std::function<void(unsigned int)>& task, unsigned int qtyThreads)
+{
+  if (qtyThreads == 0 || qtyThreads > m_qtyThreads)
+  {
+    qtyThreads = m_qtyThreads;
+  }
+
+  if (qtyThreads > qtyTasks)
+  {
+    qtyThreads = qtyTasks;
+  }
+
+  std::unique_lock<std::mutex> runLock(m_runMutex, std::defer_lock);
+
+  if (qtyThreads <= 1 || insideThreadPool || !runLock.try_lock())
+  {
+    for (unsigned int i = 0; i < qtyTasks; i++)
+    {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_qtyTasks = qtyTasks;
+    m_nextTask = 0;
+    m_qtyActiveWorkers = qtyThreads - 1;
+    m_qtyBusyWorkers = m_qtyActiveWorkers;
+    m_generation++;
+  }
+  m_startCondition.notify_all();
+
+  insideThreadPool = true;
+  processTasks();
+  insideThreadPool = false;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_doneCondition.wait(lock, [this]{return m_qtyBusyWorkers == 0;});
+  m_task = 0;
+}
+
+void ThreadPool::startWorkers(unsigned int qtyThreads)
+{
+  if (qtyThreads == 0)
+  {
+    qtyThreads = std::thread::hardware_concurrency();
+  }
+
+  if (qtyThreads == 0)
+  {
+    qtyThreads = 1;
+  }
+
+  m_stop = false;
+  m_qtyThreads = qtyThreads;
+
+  for (unsigned int i = 0; i + 1 < qtyThreads; i++)
+  {
+    m_workers.push_back(std::thread(&ThreadPool::work, this, i));
+  }
+}
+
+void ThreadPool::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_startCondition.notify_all();
+
+  for (std::vector<std::thread>::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+  {
+    it->join();
+  }
+
+  m_workers.clear();
+  m_qtyThreads = 1;
+}
+
+void ThreadPool::work(unsigned int workerIndex)
+{
+  insideThreadPool = true;
+  unsigned int generation = 0;
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_startCondition.wait(lock, [&]{return m_stop || m_generation != generation;});
+
+      if (m_stop)
+      {
+        return;
+      }
+
+      generation = m_generation;
+
+      if (workerIndex >= m_qtyActiveWorkers)
+      {
+        continue;
+      }
+    }
+
+    processTasks();
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_qtyBusyWorkers--;
+    }
+    m_doneCondition.notify_one();
+  }
+}
+
+void ThreadPool::processTasks()
+{
+  unsigned int index;
+  while ((index = m_nextTask++) < m_qtyTasks)
+  {
+    (*m_task)(index);
+  }
+}
@@ -0,0 +1,54 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads which execute indexed tasks
+// run() blocks until all tasks are done, the calling thread works on the tasks as well
+// a run() from inside a task or while another thread is running a job is executed serially, so it can never deadlock
+class ThreadPool
+{
+public:
+  explicit ThreadPool(unsigned int qtyThreads = 0);
+  ~ThreadPool();
+
+  static ThreadPool& getInstance();
+
+  unsigned int getQtyThreads() const;
+  void setQtyThreads(unsigned int qtyThreads); // 0 -> number of cores, must not be called while a job is running
+
+  // calls task(i) for every i in [0, qtyTasks), qtyThreads = 0 -> all threads of the pool
+  void run(unsigned int qtyTasks, const std::function<void(unsigned int)>& task, unsigned int qtyThreads = 0);
+
+private:
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator= (const ThreadPool&);
+
+  void startWorkers(unsigned int qtyThreads);
+  void stopWorkers();
+  void work(unsigned int workerIndex);
+  void processTasks();
+
+  std::vector<std::thread> m_workers;
+  unsigned int m_qtyThreads; // including the calling thread
+
+  std::mutex m_runMutex;
+  std::mutex m_mutex;
+  std::condition_variable m_startCondition;
+  std::condition_variable m_doneCondition;
+  bool m_stop;
+  unsigned int m_generation;
+  unsigned int m_qtyActiveWorkers;
+  unsigned int m_qtyBusyWorkers;
+
+  const std::function<void(unsigned int)>* m_task;
+  unsigned int m_qtyTasks;
+  std::atomic<unsigned int> m_nextTask;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,362 @@
+#include <cstring>
+
+#include "TileCache.h"
+
+namespace
+{
+  const char Magic[4] = {'I', 'P', 'M', 'T'};
+  const uint32_t ByteOrderMark = 0x01020304;
+  const uint32_t Version = 1;
+
+  // the header is written field by field in the byte order of the machine:
+  // magic, byte order mark, version, type code, element size, qtyLayers, tileSize (uint32), width, height (uint64)
+  template<typename U>
+  void put(unsigned char*& it, U value)
+  {
+    memcpy(it, &value, sizeof(U));
+    it += sizeof(U);
+  }
+
+  template<typename U>
+  U get(const unsigned char*& it)
+  {
+    U value;
+    memcpy(&value, it, sizeof(U));
+    it += sizeof(U);
+    return value;
+  }
+}
+
+const unsigned int TileCache::HeaderSize;
+const char* const TileCache::Extension = ".ipt";
+
+TileCache::TileCache() :
+  m_isOpen(false),
+  m_width(0),
+  m_height(0),
+  m_qtyLayers(0),
+  m_tileSize(0),
+  m_tileBytes(0),
+  m_cacheSize(0),
+  m_qtyLoads(0),
+  m_qtyStores(0)
+{
+}
+
+TileCache::~TileCache()
+{
+  close();
+}
+
+bool TileCache::create(const std::string& fileName, unsigned long long width, unsigned long long height, unsigned int qtyLayers, unsigned int tileSize,
+                       unsigned int typeCode, unsigned int elementSize, size_t cacheSize)
+{
+  close();
+
+  if (width == 0 || height == 0 || qtyLayers == 0 || tileSize == 0 || elementSize == 0)
+  {
+    return false;
+  }
+
+  m_stream.open(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_stream)
+  {
+    return false;
+  }
+
+  m_width = width;
+  m_height = height;
+  m_qtyLayers = qtyLayers;
+  m_tileSize = tileSize;
+  m_tileBytes = static_cast<size_t>(tileSize) * tileSize * elementSize;
+  m_cacheSize = cacheSize;
+
+  if (!writeHeader(typeCode, elementSize))
+  {
+    close();
+    return false;
+  }
+
+  // only the last byte is written, the file system does not allocate the tiles before them
+  unsigned long long fileSize = HeaderSize + getQtyTiles() * m_tileBytes;
+  m_stream.seekp(static_cast<std::streamoff>(fileSize - 1), std::ios::beg);
+  m_stream.put(0);
+
+  if (!m_stream.flush())
+  {
+    close();
+    return false;
+  }
+
+  m_isOpen = true;
+  return true;
+}
+
+bool TileCache::open(const std::string& fileName, unsigned int typeCode, unsigned int elementSize, size_t cacheSize)
+{
+  close();
+
+  m_stream.open(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  if (!m_stream)
+  {
+    return false;
+  }
+
+  if (!readHeader(typeCode, elementSize))
+  {
+    close();
+    return false;
+  }
+
+  m_tileBytes = static_cast<size_t>(m_tileSize) * m_tileSize * elementSize;
+  m_cacheSize = cacheSize;
+
+  // all tiles must be inside of the file
+  m_stream.seekg(0, std::ios::end);
+  unsigned long long fileSize = static_cast<unsigned long long>(m_stream.tellg());
+  if (!m_stream || fileSize < HeaderSize + getQtyTiles() * m_tileBytes)
+  {
+    close();
+    return false;
+  }
+
+  m_isOpen = true;
+  return true;
+}
+
+bool TileCache::flush()
+{
+  if (!m_isOpen)
+  {
+    return false;
+  }
+
+  bool success = true;
+
+  for (std::list<Tile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+  {
+    if (it->m_changed && !store(*it))
+    {
+      success = false;
+    }
+  }
+
+  return m_stream.flush() && success;
+}
+
+bool TileCache::close()
+{
+  bool success = true;
+
+  if (m_isOpen)
+  {
+    success = flush();
+  }
+
+  if (m_stream.is_open())
+  {
+    m_stream.close();
+  }
+
+  m_stream.clear();
+  m_tiles.clear();
+  m_tileOfIndex.clear();
+
+  m_isOpen = false;
+  m_width = 0;
+  m_height = 0;
+  m_qtyLayers = 0;
+  m_tileSize = 0;
+  m_tileBytes = 0;
+  m_qtyLoads = 0;
+  m_qtyStores = 0;
+
+  return success;
+}
+
+bool TileCache::isOpen() const
+{
+  return m_isOpen;
+}
+
+unsigned long long TileCache::getWidth() const
+{
+  return m_width;
+}
+
+unsigned long long TileCache::getHeight() const
+{
+  return m_height;
+}
+
+unsigned int TileCache::getQtyLayers() const
+{
+  return m_qtyLayers;
+}
+
+unsigned int TileCache::getTileSize() const
+{
+  return m_tileSize;
+}
+
+unsigned long long TileCache::getQtyTilesX() const
+{
+  return m_tileSize == 0 ? 0 : (m_width + m_tileSize - 1) / m_tileSize;
+}
+
+unsigned long long TileCache::getQtyTilesY() const
+{
+  return m_tileSize == 0 ? 0 : (m_height + m_tileSize - 1) / m_tileSize;
+}
+
+size_t TileCache::getTileBytes() const
+{
+  return m_tileBytes;
+}
+
+size_t TileCache::getCacheSize() const
+{
+  return m_cacheSize;
+}
+
+unsigned long long TileCache::getQtyLoads() const
+{
+  return m_qtyLoads;
+}
+
+unsigned long long TileCache::getQtyStores() const
+{
+  return m_qtyStores;
+}
+
+unsigned char* TileCache::getTile(unsigned long long tileX, unsigned long long tileY, unsigned int z, bool write)
+{
+  if (!m_isOpen || tileX >= getQtyTilesX() || tileY >= getQtyTilesY() || z >= m_qtyLayers)
+  {
+    return 0;
+  }
+
+  unsigned long long index = (z * getQtyTilesY() + tileY) * getQtyTilesX() + tileX;
+
+  std::unordered_map<unsigned long long, std::list<Tile>::iterator>::iterator found = m_tileOfIndex.find(index);
+  if (found != m_tileOfIndex.end())
+  {
+    m_tiles.splice(m_tiles.begin(), m_tiles, found->second);
+  }
+  else
+  {
+    // the least recently used tile is evicted and its buffer is reused
+    if (!m_tiles.empty() && (m_tiles.size() + 1) * m_tileBytes > m_cacheSize)
+    {
+      Tile& last = m_tiles.back();
+      if (last.m_changed && !store(last))
+      {
+        return 0;
+      }
+
+      m_tileOfIndex.erase(last.m_index);
+      m_tiles.splice(m_tiles.begin(), m_tiles, --m_tiles.end());
+    }
+    else
+    {
+      m_tiles.push_front(Tile());
+      m_tiles.front().m_data.resize(m_tileBytes);
+    }
+
+    Tile& tile = m_tiles.front();
+    tile.m_index = index;
+    tile.m_changed = false;
+
+    if (!load(tile))
+    {
+      m_tiles.pop_front();
+      return 0;
+    }
+
+    m_tileOfIndex[index] = m_tiles.begin();
+  }
+
+  Tile& tile = m_tiles.front();
+  tile.m_changed = tile.m_changed || write;
+
+  return &tile.m_data[0];
+}
+
+bool TileCache::readHeader(unsigned int typeCode, unsigned int elementSize)
+{
+  unsigned char header[HeaderSize];
+  m_stream.seekg(0, std::ios::beg);
+  if (!m_stream.read(reinterpret_cast<char*>(header), HeaderSize) || memcmp(header, Magic, sizeof(Magic)) != 0)
+  {
+    return false;
+  }
+
+  const unsigned char* it = header + sizeof(Magic);
+
+  // files of machines with another byte order or of another type are rejected
+  if (get<uint32_t>(it) != ByteOrderMark || get<uint32_t>(it) != Version || get<uint32_t>(it) != typeCode || get<uint32_t>(it) != elementSize)
+  {
+    return false;
+  }
+
+  m_qtyLayers = get<uint32_t>(it);
+  m_tileSize = get<uint32_t>(it);
+  m_width = get<uint64_t>(it);
+  m_height = get<uint64_t>(it);
+
+  return m_width > 0 && m_height > 0 && m_qtyLayers > 0 && m_tileSize > 0;
+}
+
+bool TileCache::writeHeader(unsigned int typeCode, unsigned int elementSize)
+{
+  unsigned char header[HeaderSize];
+  memset(header, 0, HeaderSize);
+
+  unsigned char* it = header;
+  memcpy(it, Magic, sizeof(Magic));
+  it += sizeof(Magic);
+
+  put<uint32_t>(it, ByteOrderMark);
+  put<uint32_t>(it, Version);
+  put<uint32_t>(it, typeCode);
+  put<uint32_t>(it, elementSize);
+  put<uint32_t>(it, m_qtyLayers);
+  put<uint32_t>(it, m_tileSize);
+  put<uint64_t>(it, m_width);
+  put<uint64_t>(it, m_height);
+
+  m_stream.seekp(0, std::ios::beg);
+  return static_cast<bool>(m_stream.write(reinterpret_cast<const char*>(header), HeaderSize));
+}
+
+unsigned long long TileCache::getQtyTiles() const
+{
+  return getQtyTilesX() * getQtyTilesY() * m_qtyLayers;
+}
+
+bool TileCache::load(Tile& tile)
+{
+  m_stream.seekg(static_cast<std::streamoff>(HeaderSize + tile.m_index * m_tileBytes), std::ios::beg);
+  if (!m_stream.read(reinterpret_cast<char*>(&tile.m_data[0]), m_tileBytes))
+  {
+    m_stream.clear();
+    return false;
+  }
+
+  m_qtyLoads++;
+  return true;
+}
+
+bool TileCache::store(Tile& tile)
+{
+  m_stream.seekp(static_cast<std::streamoff>(HeaderSize + tile.m_index * m_tileBytes), std::ios::beg);
+  if (!m_stream.write(reinterpret_cast<const char*>(&tile.m_data[0]), m_tileBytes))
+  {
+    m_stream.clear();
+    return false;
+  }
+
+  tile.m_changed = false;
+  m_qtyStores++;
+  return true;
+}
@@ -0,0 +1,87 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// file with the elements of a big image in square tiles, every tile has tileSize x tileSize elements (also at the right and bottom border)
+// the tiles follow each other row by row and layer by layer behind a header, a new file is sparse -> tiles which were never written are 0
+// the tiles are loaded on demand into a cache with a budget of bytes, the least recently used tile is evicted first
+// changed tiles are written back, when they are evicted, on flush() and on close()
+// all positions are 64 bit, so the image may have more pixels than fit into memory or into an unsigned int
+// not thread safe, the pixels of a tile are processed in parallel instead
+class TileCache
+{
+public:
+  static const unsigned int HeaderSize = 64;
+  static const char* const Extension;
+
+  TileCache();
+  ~TileCache(); // closes the file, changed tiles are written
+
+  // cacheSize in bytes, at least one tile is cached
+  bool create(const std::string& fileName, unsigned long long width, unsigned long long height, unsigned int qtyLayers, unsigned int tileSize,
+              unsigned int typeCode, unsigned int elementSize, size_t cacheSize);
+  bool open(const std::string& fileName, unsigned int typeCode, unsigned int elementSize, size_t cacheSize); // false, if typeCode or elementSize differ
+  bool flush();
+  bool close();
+
+  bool isOpen() const;
+  unsigned long long getWidth() const;
+  unsigned long long getHeight() const;
+  unsigned int getQtyLayers() const;
+  unsigned int getTileSize() const;
+  unsigned long long getQtyTilesX() const;
+  unsigned long long getQtyTilesY() const;
+  size_t getTileBytes() const;
+  size_t getCacheSize() const;
+
+  // elements of the tile, the rows are getTileSize() elements apart
+  // the pointer is valid until the next call of getTile(), flush() or close(), 0 if the tile cannot be read
+  // write = true marks the tile as changed
+  unsigned char* getTile(unsigned long long tileX, unsigned long long tileY, unsigned int z, bool write);
+
+  // number of tiles read from / written to the file since create() or open()
+  unsigned long long getQtyLoads() const;
+  unsigned long long getQtyStores() const;
+
+private:
+  TileCache(const TileCache&);
+  TileCache& operator= (const TileCache&);
+
+  class Tile
+  {
+  public:
+    unsigned long long m_index;
+    std::vector<unsigned char> m_data;
+    bool m_changed;
+  };
+
+  bool readHeader(unsigned int typeCode, unsigned int elementSize);
+  bool writeHeader(unsigned int typeCode, unsigned int elementSize);
+  unsigned long long getQtyTiles() const;
+  bool load(Tile& tile);
+  bool store(Tile& tile);
+
+  std::fstream m_stream;
+  bool m_isOpen;
+  unsigned long long m_width;
+  unsigned long long m_height;
+  unsigned int m_qtyLayers;
+  unsigned int m_tileSize;
+  size_t m_tileBytes;
+  size_t m_cacheSize;
+
+  std::list<Tile> m_tiles; // the most recently used tile first
+  std::unordered_map<unsigned long long, std::list<Tile>::iterator> m_tileOfIndex;
+
+  unsigned long long m_qtyLoads;
+  unsigned long long m_qtyStores;
+};
+
+#endif // TILECACHE_H
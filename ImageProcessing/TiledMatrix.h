@@ -0,0 +1,362 @@
+#ifndef TILEDMATRIX_H
+#define TILEDMATRIX_H
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "Histogram.h"
+#include "Matrix.h"
+#include "MatrixFile.h"
+#include "MatrixView.h"
+#include "TileCache.h"
+
+// image in a file, which can be bigger than the memory, see TileCache
+// only a budget of tiles is held in memory, all coordinates are 64 bit
+// the Matrix operators run tile by tile with transform(): every tile is processed together with a halo of pixels around it,
+// so a neighbourhood operator with a radius up to the halo gives the same result as on the whole image
+template<typename T>
+class TiledMatrix
+{
+public:
+  static const unsigned int DefaultTileSize = 1024;
+  static const size_t DefaultCacheSize = 256 << 20; // bytes
+
+  TiledMatrix();
+
+  // all pixels are 0
+  bool create(const std::string& fileName, unsigned long long width, unsigned long long height, unsigned int qtyLayers = 1,
+              unsigned int tileSize = DefaultTileSize, size_t cacheSize = DefaultCacheSize);
+  bool open(const std::string& fileName, size_t cacheSize = DefaultCacheSize); // false, if the file is not a tiled file of type T
+  bool flush();
+  bool close();
+
+  bool isOpen() const;
+  unsigned long long getWidth() const;
+  unsigned long long getHeight() const;
+  unsigned int getQtyLayers() const;
+  unsigned int getTileSize() const;
+  unsigned long long getQtyTilesX() const;
+  unsigned long long getQtyTilesY() const;
+
+  // copies the pixels x ... x + view width - 1, y ... y + view height - 1 of layer z into / from the view
+  // false, if the rectangle is not completely inside of the image
+  bool read(unsigned long long x, unsigned long long y, const MatrixView<T>& destination, unsigned int z = 0);
+  bool write(unsigned long long x, unsigned long long y, const MatrixView<const T>& source, unsigned int z = 0);
+
+  // visitor(const MatrixView<const T>& tile, x, y) for every tile of layer z, x and y are the position of the tile in the image
+  template<typename Visitor>
+  bool forEachTile(const Visitor& visitor, unsigned int z = 0);
+
+  Histogram<T> computeHistogram(unsigned int z = 0, unsigned int qtyThreads = 0);
+
+  // operation(Matrix<T>& patch) changes the patch in place, e. g. patch.erode(structuringElement)
+  // the patch contains all layers of a tile of source and up to halo pixels around it, the patch is clipped at the border of the image
+  // -> the pixels near the border of the image see the same neighbourhood as in the whole image
+  // only the tile without the halo is written to destination, source and destination must have the same size and must be different files
+  // the operators of Matrix parallelise within the patch, so the tiles are processed one after the other
+  template<typename Operation>
+  static bool transform(TiledMatrix& source, TiledMatrix& destination, unsigned int halo, const Operation& operation);
+
+  // copies between a tiled file and a Matrix, which fits into memory
+  static bool importMatrix(const Matrix<T>& matrix, TiledMatrix& tiledMatrix);
+  static bool exportMatrix(TiledMatrix& tiledMatrix, Matrix<T>& matrix);
+
+private:
+  TiledMatrix(const TiledMatrix&);
+  TiledMatrix& operator= (const TiledMatrix&);
+
+  // calls copy(tile row, view row, number of pixels) for every part of a row of the rectangle, which lies in one tile
+  template<typename Copy>
+  bool copyRectangle(unsigned long long x, unsigned long long y, unsigned int width, unsigned int height, unsigned int z, bool write, const Copy& copy);
+
+  TileCache m_cache;
+};
+
+template<typename T>
+TiledMatrix<T>::TiledMatrix()
+{
+}
+
+template<typename T>
+bool TiledMatrix<T>::create(const std::string& fileName, unsigned long long width, unsigned long long height, unsigned int qtyLayers, unsigned int tileSize, size_t cacheSize)
+{
+  return m_cache.create(fileName, width, height, qtyLayers, tileSize, MatrixFile::getTypeCode<T>(), sizeof(T), cacheSize);
+}
+
+template<typename T>
+bool TiledMatrix<T>::open(const std::string& fileName, size_t cacheSize)
+{
+  return m_cache.open(fileName, MatrixFile::getTypeCode<T>(), sizeof(T), cacheSize);
+}
+
+template<typename T>
+bool TiledMatrix<T>::flush()
+{
+  return m_cache.flush();
+}
+
+template<typename T>
+bool TiledMatrix<T>::close()
+{
+  return m_cache.close();
+}
+
+template<typename T>
+bool TiledMatrix<T>::isOpen() const
+{
+  return m_cache.isOpen();
+}
+
+template<typename T>
+unsigned long long TiledMatrix<T>::getWidth() const
+{
+  return m_cache.getWidth();
+}
+
+template<typename T>
+unsigned long long TiledMatrix<T>::getHeight() const
+{
+  return m_cache.getHeight();
+}
+
+template<typename T>
+unsigned int TiledMatrix<T>::getQtyLayers() const
+{
+  return m_cache.getQtyLayers();
+}
+
+template<typename T>
+unsigned int TiledMatrix<T>::getTileSize() const
+{
+  return m_cache.getTileSize();
+}
+
+template<typename T>
+unsigned long long TiledMatrix<T>::getQtyTilesX() const
+{
+  return m_cache.getQtyTilesX();
+}
+
+template<typename T>
+unsigned long long TiledMatrix<T>::getQtyTilesY() const
+{
+  return m_cache.getQtyTilesY();
+}
+
+template<typename T>
+template<typename Copy>
+bool TiledMatrix<T>::copyRectangle(unsigned long long x, unsigned long long y, unsigned int width, unsigned int height, unsigned int z, bool write, const Copy& copy)
+{
+  if (!isOpen() || z >= getQtyLayers() || x + width > getWidth() || y + height > getHeight())
+  {
+    return false;
+  }
+
+  unsigned int tileSize = getTileSize();
+
+  // tile by tile, so every tile is fetched from the cache once
+  for (unsigned long long tileY = y / tileSize; tileY * tileSize < y + height; tileY++)
+  {
+    unsigned long long firstRow = std::max(y, tileY * tileSize);
+    unsigned long long lastRow = std::min(y + height, (tileY + 1) * tileSize);
+
+    for (unsigned long long tileX = x / tileSize; tileX * tileSize < x + width; tileX++)
+    {
+      unsigned long long firstColumn = std::max(x, tileX * tileSize);
+      unsigned long long lastColumn = std::min(x + width, (tileX + 1) * tileSize);
+
+      T* tile = reinterpret_cast<T*>(m_cache.getTile(tileX, tileY, z, write));
+      if (tile == 0)
+      {
+        return false;
+      }
+
+      for (unsigned long long row = firstRow; row < lastRow; row++)
+      {
+        T* tileRow = tile + static_cast<size_t>(row - tileY * tileSize) * tileSize + static_cast<size_t>(firstColumn - tileX * tileSize);
+        copy(tileRow, static_cast<unsigned int>(row - y), static_cast<unsigned int>(firstColumn - x), static_cast<unsigned int>(lastColumn - firstColumn));
+      }
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+bool TiledMatrix<T>::read(unsigned long long x, unsigned long long y, const MatrixView<T>& destination, unsigned int z)
+{
+  return copyRectangle(x, y, destination.getWidth(), destination.getHeight(), z, false, [&](const T* tileRow, unsigned int row, unsigned int column, unsigned int length)
+  {
+    memcpy(destination.getRow(row) + column, tileRow, length * sizeof(T));
+  });
+}
+
+template<typename T>
+bool TiledMatrix<T>::write(unsigned long long x, unsigned long long y, const MatrixView<const T>& source, unsigned int z)
+{
+  return copyRectangle(x, y, source.getWidth(), source.getHeight(), z, true, [&](T* tileRow, unsigned int row, unsigned int column, unsigned int length)
+  {
+    memcpy(tileRow, source.getRow(row) + column, length * sizeof(T));
+  });
+}
+
+template<typename T>
+template<typename Visitor>
+bool TiledMatrix<T>::forEachTile(const Visitor& visitor, unsigned int z)
+{
+  if (!isOpen() || z >= getQtyLayers())
+  {
+    return false;
+  }
+
+  unsigned int tileSize = getTileSize();
+
+  for (unsigned long long tileY = 0; tileY < getQtyTilesY(); tileY++)
+  {
+    for (unsigned long long tileX = 0; tileX < getQtyTilesX(); tileX++)
+    {
+      const T* tile = reinterpret_cast<const T*>(m_cache.getTile(tileX, tileY, z, false));
+      if (tile == 0)
+      {
+        return false;
+      }
+
+      unsigned long long x = tileX * tileSize;
+      unsigned long long y = tileY * tileSize;
+      unsigned int width = static_cast<unsigned int>(std::min<unsigned long long>(tileSize, getWidth() - x));
+      unsigned int height = static_cast<unsigned int>(std::min<unsigned long long>(tileSize, getHeight() - y));
+
+      visitor(MatrixView<const T>(tile, width, height, tileSize), x, y);
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+Histogram<T> TiledMatrix<T>::computeHistogram(unsigned int z, unsigned int qtyThreads)
+{
+  Histogram<T> histogram;
+
+  forEachTile([&](const MatrixView<const T>& tile, unsigned long long, unsigned long long)
+  {
+    histogram.add(Histogram<T>::compute(tile, qtyThreads));
+  }, z);
+
+  return histogram;
+}
+
+template<typename T>
+template<typename Operation>
+bool TiledMatrix<T>::transform(TiledMatrix& source, TiledMatrix& destination, unsigned int halo, const Operation& operation)
+{
+  if (!source.isOpen() || !destination.isOpen() || &source == &destination || source.getWidth() != destination.getWidth()
+      || source.getHeight() != destination.getHeight() || source.getQtyLayers() != destination.getQtyLayers())
+  {
+    return false;
+  }
+
+  unsigned long long width = source.getWidth();
+  unsigned long long height = source.getHeight();
+  unsigned int qtyLayers = source.getQtyLayers();
+  unsigned int tileSize = destination.getTileSize();
+
+  // the patch is only created again, if the size changes at the right and the bottom border
+  Matrix<T> patch;
+
+  for (unsigned long long tileY = 0; tileY < destination.getQtyTilesY(); tileY++)
+  {
+    unsigned long long y = tileY * tileSize;
+    unsigned long long firstRow = y > halo ? y - halo : 0;
+    unsigned long long lastRow = std::min(height, y + tileSize + halo);
+
+    for (unsigned long long tileX = 0; tileX < destination.getQtyTilesX(); tileX++)
+    {
+      unsigned long long x = tileX * tileSize;
+      unsigned long long firstColumn = x > halo ? x - halo : 0;
+      unsigned long long lastColumn = std::min(width, x + tileSize + halo);
+
+      unsigned int patchWidth = static_cast<unsigned int>(lastColumn - firstColumn);
+      unsigned int patchHeight = static_cast<unsigned int>(lastRow - firstRow);
+
+      if (patch.getWidth() != patchWidth || patch.getHeight() != patchHeight || patch.getQtyLayers() != qtyLayers)
+      {
+        patch = Matrix<T>(patchWidth, patchHeight, qtyLayers, false);
+      }
+
+      for (unsigned int z = 0; z < qtyLayers; z++)
+      {
+        if (!source.read(firstColumn, firstRow, patch.getView(z), z))
+        {
+          return false;
+        }
+      }
+
+      operation(patch);
+
+      // the patch may have been replaced by the operation
+      if (patch.getWidth() != patchWidth || patch.getHeight() != patchHeight || patch.getQtyLayers() != qtyLayers)
+      {
+        return false;
+      }
+
+      unsigned int tileWidth = static_cast<unsigned int>(std::min<unsigned long long>(tileSize, width - x));
+      unsigned int tileHeight = static_cast<unsigned int>(std::min<unsigned long long>(tileSize, height - y));
+
+      for (unsigned int z = 0; z < qtyLayers; z++)
+      {
+        MatrixView<const T> tile = MatrixView<const T>(patch.getView(z)).getSubView(static_cast<unsigned int>(x - firstColumn), static_cast<unsigned int>(y - firstRow), tileWidth, tileHeight);
+        if (!destination.write(x, y, tile, z))
+        {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+bool TiledMatrix<T>::importMatrix(const Matrix<T>& matrix, TiledMatrix& tiledMatrix)
+{
+  if (matrix.getWidth() != tiledMatrix.getWidth() || matrix.getHeight() != tiledMatrix.getHeight() || matrix.getQtyLayers() != tiledMatrix.getQtyLayers())
+  {
+    return false;
+  }
+
+  for (unsigned int z = 0; z < matrix.getQtyLayers(); z++)
+  {
+    if (!tiledMatrix.write(0, 0, matrix.getView(z), z))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename T>
+bool TiledMatrix<T>::exportMatrix(TiledMatrix& tiledMatrix, Matrix<T>& matrix)
+{
+  if (!tiledMatrix.isOpen() || tiledMatrix.getWidth() > std::numeric_limits<unsigned int>::max() || tiledMatrix.getHeight() > std::numeric_limits<unsigned int>::max())
+  {
+    return false;
+  }
+
+  matrix = Matrix<T>(static_cast<unsigned int>(tiledMatrix.getWidth()), static_cast<unsigned int>(tiledMatrix.getHeight()), tiledMatrix.getQtyLayers(), false);
+
+  for (unsigned int z = 0; z < matrix.getQtyLayers(); z++)
+  {
+    if (!tiledMatrix.read(0, 0, matrix.getView(z), z))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#endif // TILEDMATRIX_H